@@ -0,0 +1,23 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file api_pre_compiled_header.c
+ * @brief File is needed for MSCV compatability
+ */
+
+#include "api_pre_compiled_header.h"
+
+// File is needed for MSCV compatability
@@ -0,0 +1,41 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file api_pre_compiled_header.h
+ * @brief Precompiled header file of the embeddable api
+ * @details Contains commonly used header files from the standard libary and os-specific header files
+ */
+
+#ifndef CHIP8_API_PRE_COMPILED_HEADER_H_
+#define CHIP8_API_PRE_COMPILED_HEADER_H_
+
+// Standard libary dependencies
+#include <limits.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(OS_WINDOWS)
+#include <windows.h>
+#elif defined(OS_UNIX_LIKE)
+#include <pthread.h>
+#endif
+
+#endif
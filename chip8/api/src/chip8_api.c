@@ -0,0 +1,262 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file chip8_api.c
+ * @brief Embeddable C interface of the virtual machine
+ */
+
+#include "chip8_api.h"
+#include "../../base/src/chip8.h"
+#include "../../core/src/virtual_machine_core.h"
+#include "../../frontend/src/assembler.h"
+
+/// @brief A virtual machine that is driven by an embedding program
+struct chip8_t {
+    /// The core of the virtual machine that executes the instructions
+    virtual_machine_core_t core;
+    /// The image the program is loaded into - its pages are shared by the core until they are written
+    virtual_machine_image_t image;
+    /// The state of the virtual machine after the program was loaded - restored by chip8_reset
+    virtual_machine_state_t * template;
+    /// Flag that indicates whether a program was loaded - the template is only valid afterwards
+    bool loaded;
+    /// The seed of the random number generator - applied again whenever a program is loaded
+    uint32_t seed;
+    /// Flag that indicates whether the program exited or failed - no further instructions are executed
+    bool halted;
+    /// The reason the program halted
+    chip8_halt_reason haltReason;
+};
+
+static int chip8_reinitialize(chip8_t *);
+static void chip8_capture_template(chip8_t *);
+
+chip8_t * chip8_create(chip8_mode mode) {
+    // The enumerations cross the boundary of the library, so any value can be passed
+    if ((unsigned)mode > CHIP8_MODE_XO_CHIP) {
+        return NULL;
+    }
+    chip8_t * vm = (chip8_t *)malloc(sizeof(chip8_t));
+    if (!vm) {
+        return NULL;
+    }
+    vm->template = (virtual_machine_state_t *)malloc(sizeof(virtual_machine_state_t));
+    if (!vm->template) {
+        free(vm);
+        return NULL;
+    }
+    if (virtual_machine_core_init(&vm->core, (virtual_machine_mode)mode)) {
+        free(vm->template);
+        free(vm);
+        return NULL;
+    }
+    if (virtual_machine_image_init(&vm->image, (virtual_machine_mode)mode)) {
+        virtual_machine_core_free(&vm->core);
+        free(vm->template);
+        free(vm);
+        return NULL;
+    }
+    // An embedded virtual machine must not write to the output of the embedding program
+    vm->core.silent = true;
+    // Zero selects the default seed of the core
+    vm->seed = 0u;
+    // No program was loaded - the empty memory ends the execution right away
+    vm->loaded = false;
+    vm->halted = false;
+    vm->haltReason = CHIP8_HALT_EXIT;
+    return vm;
+}
+
+void chip8_destroy(chip8_t * vm) {
+    if (!vm) {
+        return;
+    }
+    virtual_machine_core_free(&vm->core);
+    virtual_machine_image_free(&vm->image);
+    free(vm->template);
+    free(vm);
+}
+
+int chip8_load(chip8_t * vm, uint8_t const * program, size_t size) {
+    if (chip8_reinitialize(vm)) {
+        return -1;
+    }
+    if (size > (size_t)vm->core.memoryMask + 1u - PROGRAM_START_LOCATION) {
+        vm->halted = true;
+        vm->haltReason = CHIP8_HALT_ERROR;
+        return -1;
+    }
+    memcpy(vm->image.memory + PROGRAM_START_LOCATION, program, size);
+    chip8_capture_template(vm);
+    return 0;
+}
+
+int chip8_assemble(chip8_t * vm, char const * source) {
+    if (chip8_reinitialize(vm)) {
+        return -1;
+    }
+    // The assembler takes ownership of the source and frees it after the program was assembled
+    size_t const length = strlen(source);
+    char * copy = (char *)malloc(length + 1u);
+    if (!copy) {
+        vm->halted = true;
+        vm->haltReason = CHIP8_HALT_ERROR;
+        return -1;
+    }
+    memcpy(copy, source, length + 1u);
+    assembler_t assembler;
+    if (assembler_initialize(&assembler, copy)) {
+        free(copy);
+        vm->halted = true;
+        vm->haltReason = CHIP8_HALT_ERROR;
+        return -1;
+    }
+    // Just like the core, the assembler must not write to the output of the embedding program
+    assembler.silent = true;
+    if (assembler_process_file(&assembler, vm->image.memory)) {
+        // A partially assembled program is never executed
+        vm->halted = true;
+        vm->haltReason = CHIP8_HALT_ERROR;
+        return -1;
+    }
+    chip8_capture_template(vm);
+    return 0;
+}
+
+int chip8_reset(chip8_t * vm) {
+    if (!vm->loaded) {
+        return -1;
+    }
+    virtual_machine_core_reset(&vm->core, vm->template);
+    vm->halted = false;
+    vm->haltReason = CHIP8_HALT_EXIT;
+    return 0;
+}
+
+int chip8_set_quirks(chip8_t * vm, chip8_quirks quirks) {
+    // The quirk profile selects the interpreter, so an unknown one must never reach the core
+    if ((unsigned)quirks >= VIRTUAL_MACHINE_QUIRKS_COUNT) {
+        return -1;
+    }
+    vm->core.quirks = (virtual_machine_quirks)quirks;
+    return 0;
+}
+
+void chip8_seed(chip8_t * vm, uint32_t seed) {
+    vm->seed = seed;
+    virtual_machine_core_seed(&vm->core, seed);
+    if (vm->loaded) {
+        // A reset starts with the new seed as well
+        vm->template->randomState = vm->core.randomState;
+    }
+}
+
+uint64_t chip8_run(chip8_t * vm, uint64_t maxCycles, chip8_halt_reason * reason) {
+    uint64_t const startCycle = vm->core.cycles;
+    if (!vm->halted) {
+        // The budget is clamped, so UINT64_MAX can be passed to run until the frame is done
+        uint64_t const stopCycle = maxCycles > UINT64_MAX - startCycle ? UINT64_MAX : startCycle + maxCycles;
+        switch (virtual_machine_core_run(&vm->core, stopCycle)) {
+        case VIRTUAL_MACHINE_CORE_STOPPED:
+            vm->haltReason = CHIP8_HALT_BUDGET_EXHAUSTED;
+            break;
+        case VIRTUAL_MACHINE_CORE_FRAME_COMPLETE:
+            vm->haltReason = CHIP8_HALT_FRAME_DONE;
+            break;
+        case VIRTUAL_MACHINE_CORE_WAITING_FOR_KEY:
+            vm->haltReason = CHIP8_HALT_KEY_WAIT;
+            break;
+        case VIRTUAL_MACHINE_CORE_EXITED:
+            vm->halted = true;
+            vm->haltReason = CHIP8_HALT_EXIT;
+            break;
+        default:
+            vm->halted = true;
+            vm->haltReason = CHIP8_HALT_ERROR;
+            break;
+        }
+    }
+    if (reason) {
+        *reason = vm->haltReason;
+    }
+    return vm->core.cycles - startCycle;
+}
+
+void chip8_set_keys(chip8_t * vm, uint16_t keys) {
+    // Bit n of the keyboard state is the key n, just like in the mask
+    vm->core.keyBoardState = keys;
+}
+
+int chip8_framebuffer(chip8_t const * vm, uint8_t * pixels, size_t size, uint8_t * width, uint8_t * height) {
+    graphics_system_t const * graphicsSystem = &vm->core.graphicsSystem;
+    uint8_t const framebufferWidth = graphics_system_width(graphicsSystem);
+    uint8_t const framebufferHeight = graphics_system_height(graphicsSystem);
+    if (width) {
+        *width = framebufferWidth;
+    }
+    if (height) {
+        *height = framebufferHeight;
+    }
+    if (size < (size_t)framebufferWidth * framebufferHeight) {
+        return -1;
+    }
+    for (uint8_t y = 0u; y < framebufferHeight; y++) {
+        for (uint8_t x = 0u; x < framebufferWidth; x++) {
+            *pixels++ = graphics_system_pixel(graphicsSystem, x, y);
+        }
+    }
+    return 0;
+}
+
+uint64_t chip8_framebuffer_hash(chip8_t const * vm) {
+    return graphics_system_hash(&vm->core.graphicsSystem);
+}
+
+uint64_t chip8_cycles(chip8_t const * vm) {
+    return vm->core.cycles;
+}
+
+/// @brief Resets the virtual machine before a program is loaded
+/// @details The quirk profile and the seed that were set by the embedding program are kept
+/// @param vm The virtual machine that is reset
+/// @return 0 if the virtual machine was reset, -1 if no memory could be allocated
+static int chip8_reinitialize(chip8_t * vm) {
+    virtual_machine_mode const mode = vm->core.mode;
+    virtual_machine_quirks const quirks = vm->core.quirks;
+    virtual_machine_core_free(&vm->core);
+    if (virtual_machine_core_init(&vm->core, mode)) {
+        vm->halted = true;
+        vm->haltReason = CHIP8_HALT_ERROR;
+        return -1;
+    }
+    vm->core.quirks = quirks;
+    vm->core.silent = true;
+    // The image is not mapped by the new core, so the previous program can be removed
+    memset(vm->image.memory + PROGRAM_START_LOCATION, 0, vm->image.memoryMask + 1u - PROGRAM_START_LOCATION);
+    vm->loaded = false;
+    virtual_machine_core_seed(&vm->core, vm->seed);
+    vm->halted = false;
+    vm->haltReason = CHIP8_HALT_EXIT;
+    return 0;
+}
+
+/// @brief Maps the image a program was loaded into and captures the template the virtual machine is reset to
+/// @param vm The virtual machine whose program was loaded
+static void chip8_capture_template(chip8_t * vm) {
+    virtual_machine_core_map_image(&vm->core, &vm->image);
+    virtual_machine_core_capture_template(&vm->core, vm->template);
+    vm->loaded = true;
+}
@@ -0,0 +1,163 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file chip8_api.h
+ * @brief Embeddable C interface of the virtual machine
+ * @details The interface is built as a shared library, so tools can execute programs in-process instead of spawning
+ * a process per program. No function terminates the process - every call reports why the execution stopped.
+ */
+
+#ifndef CHIP8_API_H_
+#define CHIP8_API_H_
+
+#include "api_pre_compiled_header.h"
+
+// This file is included in the test-suite that is written in c++ using the google-test framework
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The header is also included by programs that are not built with the compile definitions of the project
+#if defined(_WIN32)
+#ifdef CHIP8_API_EXPORTS
+#define CHIP8_API __declspec(dllexport)
+#else
+#define CHIP8_API __declspec(dllimport)
+#endif
+#else
+#define CHIP8_API __attribute__((visibility("default")))
+#endif
+
+/// The width of the largest framebuffer in pixels (high resolution mode)
+#define CHIP8_FRAMEBUFFER_MAX_WIDTH  (128)
+
+/// The height of the largest framebuffer in pixels (high resolution mode)
+#define CHIP8_FRAMEBUFFER_MAX_HEIGHT (64)
+
+/// @brief A virtual machine - the instances share no state, so every thread can drive its own
+typedef struct chip8_t chip8_t;
+
+/// @brief The platforms a program can be written for
+typedef enum {
+    /// CHIP-8 and SUPER-CHIP programs - 4 KB of memory
+    CHIP8_MODE_CHIP8 = 0,
+    /// XO-CHIP programs - 64 KB of memory
+    CHIP8_MODE_XO_CHIP = 1
+} chip8_mode;
+
+/// @brief The quirk profiles - behaviors that differ between the interpreters programs were written for
+typedef enum {
+    /// COSMAC VIP
+    CHIP8_QUIRKS_VIP = 0,
+    /// SUPER-CHIP
+    CHIP8_QUIRKS_SCHIP = 1,
+    /// XO-CHIP
+    CHIP8_QUIRKS_XO_CHIP = 2
+} chip8_quirks;
+
+/// @brief The reasons chip8_run returns
+typedef enum {
+    /// The instructions of a frame were executed and the timers ticked - the framebuffer can be presented
+    CHIP8_HALT_FRAME_DONE = 0,
+    /// The amount of instructions that was passed to chip8_run was executed
+    CHIP8_HALT_BUDGET_EXHAUSTED = 1,
+    /// The program waits for a key press (FX0A) - the execution continues once a key is pressed (see chip8_set_keys)
+    CHIP8_HALT_KEY_WAIT = 2,
+    /// The program exited or reached the end of the program - further runs execute no instructions
+    CHIP8_HALT_EXIT = 3,
+    /// The program executed an unknown opcode or a call or return that leaves the stack - further runs execute no
+    /// instructions
+    CHIP8_HALT_ERROR = 4
+} chip8_halt_reason;
+
+/// @brief Creates a virtual machine
+/// @param mode The platform the programs that are loaded are written for
+/// @return The virtual machine or NULL if the mode is unknown or no memory could be allocated
+CHIP8_API chip8_t * chip8_create(chip8_mode mode);
+
+/// @brief Destroys a virtual machine
+/// @param vm The virtual machine that is destroyed (NULL is ignored)
+CHIP8_API void chip8_destroy(chip8_t * vm);
+
+/// @brief Loads a program in binary form (.ch8 or .xo8)
+/// @details The virtual machine is reset before the program is loaded - the quirk profile and the seed are kept
+/// @param vm The virtual machine the program is loaded into
+/// @param program The bytes of the program
+/// @param size The size of the program in bytes
+/// @return 0 if the program was loaded, -1 if it does not fit into the memory
+CHIP8_API int chip8_load(chip8_t * vm, uint8_t const * program, size_t size);
+
+/// @brief Assembles and loads a program in chip8 assembly language (.cp8)
+/// @details The virtual machine is reset before the program is loaded - the quirk profile and the seed are kept
+/// @param vm The virtual machine the program is loaded into
+/// @param source The null-terminated source of the program
+/// @return 0 if the program was loaded, -1 if the source contains an error
+CHIP8_API int chip8_assemble(chip8_t * vm, char const * source);
+
+/// @brief Resets the virtual machine to the state right after the program was loaded
+/// @details Only the memory that was written since the last reset is restored, so a program can be executed many times
+/// without loading it again
+/// @param vm The virtual machine that is reset
+/// @return 0 if the virtual machine was reset, -1 if no program was loaded
+CHIP8_API int chip8_reset(chip8_t * vm);
+
+/// @brief Sets the quirk profile the instructions are executed with
+/// @param vm The virtual machine
+/// @param quirks The quirk profile
+/// @return 0 if the quirk profile was set, -1 if it is unknown
+CHIP8_API int chip8_set_quirks(chip8_t * vm, chip8_quirks quirks);
+
+/// @brief Seeds the random number generator that is used by CXNN - a seed makes a run reproducible
+/// @param vm The virtual machine
+/// @param seed The seed
+CHIP8_API void chip8_seed(chip8_t * vm, uint32_t seed);
+
+/// @brief Executes instructions until a frame is done, the budget is exhausted or the program halts
+/// @param vm The virtual machine
+/// @param maxCycles The maximum amount of instructions that are executed
+/// @param reason Receives the reason the execution stopped (may be NULL)
+/// @return The amount of instructions that were executed
+CHIP8_API uint64_t chip8_run(chip8_t * vm, uint64_t maxCycles, chip8_halt_reason * reason);
+
+/// @brief Sets the keys that are pressed
+/// @param vm The virtual machine
+/// @param keys Bitmask of the pressed keys - bit n is set if key n (0 - F) is pressed
+CHIP8_API void chip8_set_keys(chip8_t * vm, uint16_t keys);
+
+/// @brief Copies the framebuffer - every pixel is stored as the index of its color in one byte, row by row
+/// @param vm The virtual machine
+/// @param pixels The buffer the pixels are written to
+/// @param size The size of the buffer (CHIP8_FRAMEBUFFER_MAX_WIDTH * CHIP8_FRAMEBUFFER_MAX_HEIGHT always suffices)
+/// @param width Receives the width of the framebuffer in the current resolution mode
+/// @param height Receives the height of the framebuffer in the current resolution mode
+/// @return 0 if the framebuffer was copied, -1 if the buffer is too small
+CHIP8_API int chip8_framebuffer(chip8_t const * vm, uint8_t * pixels, size_t size, uint8_t * width, uint8_t * height);
+
+/// @brief Computes a hash of the framebuffer - cheaper than copying it if frames are only compared
+/// @param vm The virtual machine
+/// @return The 64-bit FNV-1a hash of the framebuffer
+CHIP8_API uint64_t chip8_framebuffer_hash(chip8_t const * vm);
+
+/// @brief Determines the amount of instructions that were executed since the program was loaded
+/// @param vm The virtual machine
+/// @return The amount of executed instructions
+CHIP8_API uint64_t chip8_cycles(chip8_t const * vm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,200 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file chip8_vec_env.c
+ * @brief Many virtual machines that execute the same program and are stepped together
+ */
+
+#include "chip8_vec_env.h"
+#include "../../base/src/chip8.h"
+#include "../../core/src/virtual_machine_core.h"
+#include "thread_pool.h"
+
+/// @brief Environments that are stepped together
+struct chip8_vec_env_t {
+    /// The cores of the environments
+    virtual_machine_core_t * cores;
+    /// Flag per environment that is set if its program exited or failed
+    uint8_t * halted;
+    /// The amount of environments
+    size_t count;
+    /// The image the program was loaded into - shared by every environment
+    virtual_machine_image_t image;
+    /// The state of an environment right after the program was loaded - shared by every environment
+    virtual_machine_state_t * template;
+    /// The threads that step the environments
+    thread_pool_t threadPool;
+    /// The keys of the current step
+    uint16_t const * actions;
+    /// The buffer the framebuffers of the current step are written to
+    uint8_t * frames;
+};
+
+static void chip8_vec_env_step_task(void *, size_t, size_t);
+static void chip8_vec_env_step_one(chip8_vec_env_t *, size_t);
+static void chip8_vec_env_pack_frame(graphics_system_t const *, uint8_t *);
+
+chip8_vec_env_t * chip8_vec_env_create(chip8_mode mode, uint8_t const * program, size_t size, size_t count,
+                                       size_t threadCount) {
+    if ((unsigned)mode > CHIP8_MODE_XO_CHIP) {
+        return NULL;
+    }
+    chip8_vec_env_t * env = (chip8_vec_env_t *)calloc(1u, sizeof(chip8_vec_env_t));
+    if (!env) {
+        return NULL;
+    }
+    env->cores = (virtual_machine_core_t *)calloc(count, sizeof(virtual_machine_core_t));
+    env->halted = (uint8_t *)calloc(count, sizeof(uint8_t));
+    env->template = (virtual_machine_state_t *)malloc(sizeof(virtual_machine_state_t));
+    if (!env->cores || !env->halted || !env->template ||
+        virtual_machine_image_init(&env->image, (virtual_machine_mode)mode)) {
+        chip8_vec_env_destroy(env);
+        return NULL;
+    }
+    if (size > (size_t)env->image.memoryMask + 1u - PROGRAM_START_LOCATION ||
+        thread_pool_init(&env->threadPool, threadCount)) {
+        chip8_vec_env_destroy(env);
+        return NULL;
+    }
+    memcpy(env->image.memory + PROGRAM_START_LOCATION, program, size);
+    for (; env->count < count; env->count++) {
+        virtual_machine_core_t * core = env->cores + env->count;
+        if (virtual_machine_core_init(core, (virtual_machine_mode)mode)) {
+            chip8_vec_env_destroy(env);
+            return NULL;
+        }
+        core->silent = true;
+        virtual_machine_core_map_image(core, &env->image);
+    }
+    if (count) {
+        // Every environment starts from the template, so the dirty pages of every core are tracked from here on
+        virtual_machine_core_capture_template(env->cores, env->template);
+        chip8_vec_env_reset(env, NULL);
+        chip8_vec_env_seed(env, 0u);
+    }
+    return env;
+}
+
+void chip8_vec_env_destroy(chip8_vec_env_t * env) {
+    if (!env) {
+        return;
+    }
+    if (env->threadPool.threads) {
+        thread_pool_free(&env->threadPool);
+    }
+    for (size_t i = 0u; i < env->count; i++) {
+        virtual_machine_core_free(env->cores + i);
+    }
+    virtual_machine_image_free(&env->image);
+    free(env->template);
+    free(env->halted);
+    free(env->cores);
+    free(env);
+}
+
+int chip8_vec_env_set_quirks(chip8_vec_env_t * env, chip8_quirks quirks) {
+    // The quirk profile selects the interpreter, so an unknown one must never reach the cores
+    if ((unsigned)quirks >= VIRTUAL_MACHINE_QUIRKS_COUNT) {
+        return -1;
+    }
+    for (size_t i = 0u; i < env->count; i++) {
+        env->cores[i].quirks = (virtual_machine_quirks)quirks;
+    }
+    return 0;
+}
+
+void chip8_vec_env_seed(chip8_vec_env_t * env, uint32_t seed) {
+    for (size_t i = 0u; i < env->count; i++) {
+        virtual_machine_core_seed(env->cores + i, seed + (uint32_t)i);
+    }
+}
+
+void chip8_vec_env_step(chip8_vec_env_t * env, uint16_t const * actions, uint8_t * frames, uint8_t * done) {
+    env->actions = actions;
+    env->frames = frames;
+    thread_pool_run(&env->threadPool, chip8_vec_env_step_task, env);
+    if (done) {
+        memcpy(done, env->halted, env->count);
+    }
+}
+
+void chip8_vec_env_reset(chip8_vec_env_t * env, uint8_t const * mask) {
+    for (size_t i = 0u; i < env->count; i++) {
+        if (mask && !mask[i]) {
+            continue;
+        }
+        virtual_machine_core_t * core = env->cores + i;
+        // The random number generator continues, so the next episode differs from the previous one
+        uint32_t const randomState = core->randomState;
+        virtual_machine_core_reset(core, env->template);
+        core->randomState = randomState;
+        env->halted[i] = 0u;
+    }
+}
+
+/// @brief Steps the environments of a thread of the pool
+/// @details Each thread steps a contiguous range of environments. The halted flags and the frames of neighbouring
+/// environments share cache lines, which are then written by one thread only, except at the ends of the ranges. The
+/// ranges differ by at most one environment
+/// @param context The environments
+/// @param worker The index of the thread
+/// @param workerCount The amount of threads that step the environments
+static void chip8_vec_env_step_task(void * context, size_t worker, size_t workerCount) {
+    chip8_vec_env_t * env = (chip8_vec_env_t *)context;
+    size_t const end = env->count * (worker + 1u) / workerCount;
+    for (size_t i = env->count * worker / workerCount; i < end; i++) {
+        chip8_vec_env_step_one(env, i);
+    }
+}
+
+/// @brief Advances an environment by one frame and writes its framebuffer
+/// @param env The environments
+/// @param index The index of the environment
+static void chip8_vec_env_step_one(chip8_vec_env_t * env, size_t index) {
+    virtual_machine_core_t * core = env->cores + index;
+    if (!env->halted[index]) {
+        core->keyBoardState = env->actions ? env->actions[index] : 0u;
+        int8_t result;
+        // A key that is awaited is pressed or not for the whole frame, so waiting just continues the frame
+        do {
+            result = virtual_machine_core_run(core, UINT64_MAX);
+        } while (result == VIRTUAL_MACHINE_CORE_WAITING_FOR_KEY);
+        env->halted[index] = result == VIRTUAL_MACHINE_CORE_EXITED || result == VIRTUAL_MACHINE_CORE_ERROR;
+    }
+    if (env->frames) {
+        chip8_vec_env_pack_frame(&core->graphicsSystem, env->frames + index * CHIP8_VEC_ENV_FRAME_SIZE);
+    }
+}
+
+/// @brief Packs the framebuffer of an environment into one bit per pixel
+/// @param graphicsSystem The graphics system of the environment
+/// @param frame The frame the pixels are written to (CHIP8_VEC_ENV_FRAME_SIZE bytes)
+static void chip8_vec_env_pack_frame(graphics_system_t const * graphicsSystem, uint8_t * frame) {
+    for (uint8_t y = 0u; y < GRAPHICS_SYSTEM_HIGH_RESOLUTION_HEIGHT; y++) {
+        for (uint8_t word = 0u; word < GRAPHICS_SYSTEM_ROW_WORDS; word++) {
+            uint64_t pixels = 0u;
+            for (uint8_t plane = 0u; plane < GRAPHICS_SYSTEM_PLANE_COUNT; plane++) {
+                if (graphicsSystem->usedPlanes & (1u << plane)) {
+                    pixels |= graphicsSystem->planes[plane][y][word];
+                }
+            }
+            // The leftmost pixel is the most significant bit of the word and of the first byte
+            for (uint8_t byte = 0u; byte < 8u; byte++) {
+                *frame++ = (uint8_t)(pixels >> (56u - byte * 8u));
+            }
+        }
+    }
+}
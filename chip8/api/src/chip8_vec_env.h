@@ -0,0 +1,89 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file chip8_vec_env.h
+ * @brief Many virtual machines that execute the same program and are stepped together
+ * @details Every step advances each environment by one frame. The environments are distributed over a pool of
+ * threads and write their framebuffers directly into one buffer that is provided by the caller, so training loops can
+ * step thousands of environments without copying frames or calling into the library once per environment.
+ */
+
+#ifndef CHIP8_VEC_ENV_H_
+#define CHIP8_VEC_ENV_H_
+
+#include "chip8_api.h"
+
+// This file is included in the test-suite that is written in c++ using the google-test framework
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The size of the framebuffer of an environment in bytes - one bit per pixel of the high resolution mode
+#define CHIP8_VEC_ENV_FRAME_SIZE (CHIP8_FRAMEBUFFER_MAX_WIDTH * CHIP8_FRAMEBUFFER_MAX_HEIGHT / 8)
+
+/// @brief Environments that are stepped together
+typedef struct chip8_vec_env_t chip8_vec_env_t;
+
+/// @brief Creates environments that execute a program
+/// @details The environments share the pages of the program until they write them
+/// @param mode The platform the program is written for
+/// @param program The bytes of the program (.ch8 or .xo8)
+/// @param size The size of the program in bytes
+/// @param count The amount of environments
+/// @param threadCount The amount of threads that step the environments, including the thread that calls
+/// chip8_vec_env_step (0 or 1 steps every environment on the calling thread)
+/// @return The environments or NULL if the mode is unknown, the program does not fit into the memory or no memory could be allocated
+CHIP8_API chip8_vec_env_t * chip8_vec_env_create(chip8_mode mode, uint8_t const * program, size_t size, size_t count,
+                                                 size_t threadCount);
+
+/// @brief Destroys the environments
+/// @param env The environments that are destroyed (NULL is ignored)
+CHIP8_API void chip8_vec_env_destroy(chip8_vec_env_t * env);
+
+/// @brief Sets the quirk profile every environment is executed with
+/// @param env The environments
+/// @param quirks The quirk profile
+/// @return 0 if the quirk profile was set, -1 if it is unknown
+CHIP8_API int chip8_vec_env_set_quirks(chip8_vec_env_t * env, chip8_quirks quirks);
+
+/// @brief Seeds the random number generators - environment n is seeded with seed + n
+/// @details A reset keeps the state of the random number generator, so every episode is different
+/// @param env The environments
+/// @param seed The seed of the first environment
+CHIP8_API void chip8_vec_env_seed(chip8_vec_env_t * env, uint32_t seed);
+
+/// @brief Advances every environment by one frame
+/// @details An environment whose program exited or failed is not advanced until it is reset
+/// @param env The environments
+/// @param actions The keys that are pressed in each environment - bit n is set if key n (0 - F) is pressed
+/// @param frames The buffer the framebuffers are written to (CHIP8_VEC_ENV_FRAME_SIZE bytes per environment). A frame
+/// is stored row by row with 16 bytes per row and the leftmost pixel in the most significant bit. A pixel is set if it
+/// is set in any plane, low resolution frames occupy the top left 64x32 pixels. May be NULL.
+/// @param done Receives 1 for every environment whose program exited or failed, 0 otherwise (may be NULL)
+CHIP8_API void chip8_vec_env_step(chip8_vec_env_t * env, uint16_t const * actions, uint8_t * frames, uint8_t * done);
+
+/// @brief Resets environments to the state right after the program was loaded
+/// @details Only the memory that an environment wrote since its last reset is restored
+/// @param env The environments
+/// @param mask Flag per environment that is set if the environment is reset (NULL resets every environment) - the
+/// done flags of chip8_vec_env_step can be passed to reset every environment that finished
+CHIP8_API void chip8_vec_env_reset(chip8_vec_env_t * env, uint8_t const * mask);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
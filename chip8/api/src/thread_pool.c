@@ -0,0 +1,221 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file thread_pool.c
+ * @brief A pool of threads that execute a task together
+ */
+
+#include "thread_pool.h"
+
+#if defined(OS_WINDOWS)
+static DWORD WINAPI thread_pool_thread(LPVOID);
+#else
+static void * thread_pool_thread(void *);
+#endif
+static void thread_pool_lock(thread_pool_t *);
+static void thread_pool_unlock(thread_pool_t *);
+static void thread_pool_wait(thread_pool_t *, bool);
+static void thread_pool_signal(thread_pool_t *, bool);
+
+/// @brief Initializes a pool of threads
+/// @param pool The pool that is initialized
+/// @param threadCount The amount of threads that execute a task including the thread that runs it (at least 1)
+/// @return 0 if everything went well, -1 if the threads could not be created
+int thread_pool_init(thread_pool_t * pool, size_t threadCount) {
+    pool->threadCount = threadCount > 1u ? threadCount - 1u : 0u;
+    pool->task = NULL;
+    pool->context = NULL;
+    pool->generation = 0u;
+    pool->pending = 0u;
+    pool->stopping = false;
+    // One byte is allocated at least, so a pool without threads does not depend on malloc(0)
+    pool->threads = malloc(pool->threadCount * sizeof(*pool->threads) + 1u);
+    pool->workers = (thread_pool_worker_t *)malloc(pool->threadCount * sizeof(thread_pool_worker_t) + 1u);
+    if (!pool->threads || !pool->workers) {
+        free(pool->threads);
+        free(pool->workers);
+        pool->threads = NULL;
+        pool->workers = NULL;
+        return -1;
+    }
+#if defined(OS_WINDOWS)
+    InitializeCriticalSection(&pool->lock);
+    InitializeConditionVariable(&pool->taskStarted);
+    InitializeConditionVariable(&pool->taskFinished);
+#else
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->taskStarted, NULL);
+    pthread_cond_init(&pool->taskFinished, NULL);
+#endif
+    for (size_t i = 0u; i < pool->threadCount; i++) {
+        thread_pool_worker_t * worker = pool->workers + i;
+        worker->pool = pool;
+        worker->worker = i + 1u;
+#if defined(OS_WINDOWS)
+        pool->threads[i] = CreateThread(NULL, 0, thread_pool_thread, worker, 0, NULL);
+        bool const created = pool->threads[i] != NULL;
+#else
+        bool const created = !pthread_create(pool->threads + i, NULL, thread_pool_thread, worker);
+#endif
+        if (!created) {
+            // Only the threads that were created are stopped
+            pool->threadCount = i;
+            thread_pool_free(pool);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/// @brief Executes a task on every thread of the pool and on the calling thread
+/// @details Returns after every thread finished the task
+/// @param pool The pool of threads
+/// @param task The task that is executed
+/// @param context The context that is passed to the task
+void thread_pool_run(thread_pool_t * pool, thread_pool_task_t task, void * context) {
+    if (pool->threadCount) {
+        thread_pool_lock(pool);
+        pool->task = task;
+        pool->context = context;
+        pool->pending = pool->threadCount;
+        pool->generation++;
+        thread_pool_signal(pool, true);
+        thread_pool_unlock(pool);
+    }
+    task(context, 0u, pool->threadCount + 1u);
+    if (pool->threadCount) {
+        thread_pool_lock(pool);
+        while (pool->pending) {
+            thread_pool_wait(pool, false);
+        }
+        thread_pool_unlock(pool);
+    }
+}
+
+/// @brief Stops the threads of the pool and frees the pool
+/// @param pool The pool that is freed
+void thread_pool_free(thread_pool_t * pool) {
+    thread_pool_lock(pool);
+    pool->stopping = true;
+    thread_pool_signal(pool, true);
+    thread_pool_unlock(pool);
+    for (size_t i = 0u; i < pool->threadCount; i++) {
+#if defined(OS_WINDOWS)
+        WaitForSingleObject(pool->threads[i], INFINITE);
+        CloseHandle(pool->threads[i]);
+#else
+        pthread_join(pool->threads[i], NULL);
+#endif
+    }
+#if defined(OS_WINDOWS)
+    DeleteCriticalSection(&pool->lock);
+#else
+    pthread_cond_destroy(&pool->taskFinished);
+    pthread_cond_destroy(&pool->taskStarted);
+    pthread_mutex_destroy(&pool->lock);
+#endif
+    free(pool->threads);
+    free(pool->workers);
+    pool->threads = NULL;
+    pool->workers = NULL;
+}
+
+/// @brief Entry point of a thread of the pool
+/// @details Waits for a task, executes it and reports that it finished until the pool is freed
+/// @param data The worker of the thread
+#if defined(OS_WINDOWS)
+static DWORD WINAPI thread_pool_thread(LPVOID data) {
+#else
+static void * thread_pool_thread(void * data) {
+#endif
+    thread_pool_worker_t const * worker = (thread_pool_worker_t const *)data;
+    thread_pool_t * pool = worker->pool;
+    uint64_t generation = 0u;
+    thread_pool_lock(pool);
+    for (;;) {
+        while (!pool->stopping && pool->generation == generation) {
+            thread_pool_wait(pool, true);
+        }
+        if (pool->stopping) {
+            break;
+        }
+        generation = pool->generation;
+        thread_pool_task_t const task = pool->task;
+        void * context = pool->context;
+        thread_pool_unlock(pool);
+        task(context, worker->worker, pool->threadCount + 1u);
+        thread_pool_lock(pool);
+        if (!--pool->pending) {
+            thread_pool_signal(pool, false);
+        }
+    }
+    thread_pool_unlock(pool);
+#if defined(OS_WINDOWS)
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+/// @brief Acquires the lock of the pool
+/// @param pool The pool of threads
+static void thread_pool_lock(thread_pool_t * pool) {
+#if defined(OS_WINDOWS)
+    EnterCriticalSection(&pool->lock);
+#else
+    pthread_mutex_lock(&pool->lock);
+#endif
+}
+
+/// @brief Releases the lock of the pool
+/// @param pool The pool of threads
+static void thread_pool_unlock(thread_pool_t * pool) {
+#if defined(OS_WINDOWS)
+    LeaveCriticalSection(&pool->lock);
+#else
+    pthread_mutex_unlock(&pool->lock);
+#endif
+}
+
+/// @brief Waits until a task is started or finished - the lock of the pool must be held
+/// @param pool The pool of threads
+/// @param started Whether the thread waits for a task to be started or to be finished
+static void thread_pool_wait(thread_pool_t * pool, bool started) {
+#if defined(OS_WINDOWS)
+    SleepConditionVariableCS(started ? &pool->taskStarted : &pool->taskFinished, &pool->lock, INFINITE);
+#else
+    pthread_cond_wait(started ? &pool->taskStarted : &pool->taskFinished, &pool->lock);
+#endif
+}
+
+/// @brief Wakes up the threads that wait until a task is started or the thread that waits until it is finished
+/// @param pool The pool of threads
+/// @param started Whether a task was started or finished
+static void thread_pool_signal(thread_pool_t * pool, bool started) {
+#if defined(OS_WINDOWS)
+    if (started) {
+        WakeAllConditionVariable(&pool->taskStarted);
+    } else {
+        WakeConditionVariable(&pool->taskFinished);
+    }
+#else
+    if (started) {
+        pthread_cond_broadcast(&pool->taskStarted);
+    } else {
+        pthread_cond_signal(&pool->taskFinished);
+    }
+#endif
+}
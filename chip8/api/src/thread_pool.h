@@ -0,0 +1,88 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file thread_pool.h
+ * @brief A pool of threads that execute a task together
+ * @details The threads are created once and wait for the next task, so a task can be run every frame without
+ * creating threads
+ */
+
+#ifndef CHIP8_THREAD_POOL_H_
+#define CHIP8_THREAD_POOL_H_
+
+#include "api_pre_compiled_header.h"
+
+/// @brief A task that is executed by every thread of the pool
+/// @param context The context that was passed to thread_pool_run
+/// @param worker The index of the thread that executes the task (0 is the thread that called thread_pool_run)
+/// @param workerCount The amount of threads that execute the task
+typedef void (*thread_pool_task_t)(void * context, size_t worker, size_t workerCount);
+
+struct thread_pool_t;
+
+/// @brief A thread of the pool
+typedef struct {
+    /// The pool the thread belongs to
+    struct thread_pool_t * pool;
+    /// The index of the thread (1 up to the amount of threads of the pool)
+    size_t worker;
+} thread_pool_worker_t;
+
+/// @brief A pool of threads
+typedef struct thread_pool_t {
+    /// The threads of the pool - the thread that runs a task is not part of the pool, but executes the task as well
+#if defined(OS_WINDOWS)
+    HANDLE * threads;
+#else
+    pthread_t * threads;
+#endif
+    /// The workers that are passed to the threads
+    thread_pool_worker_t * workers;
+    /// The amount of threads of the pool
+    size_t threadCount;
+    /// Protects the fields below
+#if defined(OS_WINDOWS)
+    CRITICAL_SECTION lock;
+    /// Signaled when a task is started or the pool is freed
+    CONDITION_VARIABLE taskStarted;
+    /// Signaled when a thread finished the task
+    CONDITION_VARIABLE taskFinished;
+#else
+    pthread_mutex_t lock;
+    /// Signaled when a task is started or the pool is freed
+    pthread_cond_t taskStarted;
+    /// Signaled when a thread finished the task
+    pthread_cond_t taskFinished;
+#endif
+    /// The task that is executed
+    thread_pool_task_t task;
+    /// The context of the task
+    void * context;
+    /// Incremented for every task - a thread executes a task once
+    uint64_t generation;
+    /// The amount of threads of the pool that did not finish the current task
+    size_t pending;
+    /// Flag that indicates whether the threads have to exit
+    bool stopping;
+} thread_pool_t;
+
+int thread_pool_init(thread_pool_t * pool, size_t threadCount);
+
+void thread_pool_run(thread_pool_t * pool, thread_pool_task_t task, void * context);
+
+void thread_pool_free(thread_pool_t * pool);
+
+#endif
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+
+#include <stdint.h>
+
+#include "../src/chip8_api.h"
+
+// V0 = 0x01, then V0 += 0x01 in an endless loop
+static uint8_t const CountingProgram[] = {0x60, 0x01, 0x70, 0x01, 0x12, 0x02};
+
+class Chip8API : public testing::Test {
+  protected:
+    void SetUp() override {
+        vm = chip8_create(CHIP8_MODE_CHIP8);
+        ASSERT_NE(nullptr, vm);
+    }
+
+    void TearDown() override {
+        chip8_destroy(vm);
+    }
+
+    chip8_t * vm;
+};
+
+TEST_F(Chip8API, ReportsAFrameThatIsDone) {
+    ASSERT_EQ(0, chip8_load(vm, CountingProgram, sizeof(CountingProgram)));
+    chip8_halt_reason reason;
+    ASSERT_EQ(10u, chip8_run(vm, UINT64_MAX, &reason));
+    ASSERT_EQ(CHIP8_HALT_FRAME_DONE, reason);
+}
+
+TEST_F(Chip8API, ReportsAnExhaustedBudget) {
+    ASSERT_EQ(0, chip8_load(vm, CountingProgram, sizeof(CountingProgram)));
+    chip8_halt_reason reason;
+    ASSERT_EQ(3u, chip8_run(vm, 3u, &reason));
+    ASSERT_EQ(CHIP8_HALT_BUDGET_EXHAUSTED, reason);
+    ASSERT_EQ(3u, chip8_cycles(vm));
+}
+
+TEST_F(Chip8API, ReportsTheExitOfTheProgram) {
+    // V0 = 0x01, exit
+    uint8_t const program[] = {0x60, 0x01, 0x00, 0xFD};
+    ASSERT_EQ(0, chip8_load(vm, program, sizeof(program)));
+    chip8_halt_reason reason;
+    ASSERT_EQ(1u, chip8_run(vm, UINT64_MAX, &reason));
+    ASSERT_EQ(CHIP8_HALT_EXIT, reason);
+    // The program stays halted
+    ASSERT_EQ(0u, chip8_run(vm, UINT64_MAX, &reason));
+    ASSERT_EQ(CHIP8_HALT_EXIT, reason);
+}
+
+TEST_F(Chip8API, ReportsAnUnknownOpcodeInsteadOfTerminating) {
+    uint8_t const program[] = {0x60, 0x01, 0xE0, 0xFF};
+    ASSERT_EQ(0, chip8_load(vm, program, sizeof(program)));
+    chip8_halt_reason reason;
+    chip8_run(vm, UINT64_MAX, &reason);
+    ASSERT_EQ(CHIP8_HALT_ERROR, reason);
+}
+
+TEST_F(Chip8API, ReportsAStackOverflowInsteadOfTerminating) {
+    // Calls itself until the stack is full
+    uint8_t const program[] = {0x22, 0x00};
+    ASSERT_EQ(0, chip8_load(vm, program, sizeof(program)));
+    chip8_halt_reason reason;
+    // The calls may span a frame boundary
+    do {
+        chip8_run(vm, UINT64_MAX, &reason);
+    } while (reason == CHIP8_HALT_FRAME_DONE);
+    ASSERT_EQ(CHIP8_HALT_ERROR, reason);
+    // The call that overflows the stack is not executed
+    ASSERT_EQ(16u, chip8_cycles(vm));
+}
+
+TEST_F(Chip8API, ReportsAStackUnderflowInsteadOfTerminating) {
+    // Returns without a call
+    uint8_t const program[] = {0x00, 0xEE};
+    ASSERT_EQ(0, chip8_load(vm, program, sizeof(program)));
+    chip8_halt_reason reason;
+    ASSERT_EQ(0u, chip8_run(vm, UINT64_MAX, &reason));
+    ASSERT_EQ(CHIP8_HALT_ERROR, reason);
+}
+
+TEST_F(Chip8API, WaitsForAKey) {
+    // V0 = key, I = 0x208, draw the pixel at 0x208 at V0, V1, exit
+    uint8_t const program[] = {0xF0, 0x0A, 0xA2, 0x08, 0xD0, 0x11, 0x00, 0xFD, 0x80};
+    ASSERT_EQ(0, chip8_load(vm, program, sizeof(program)));
+    chip8_halt_reason reason;
+    chip8_run(vm, UINT64_MAX, &reason);
+    ASSERT_EQ(CHIP8_HALT_KEY_WAIT, reason);
+    chip8_set_keys(vm, 1u << 0x1);
+    chip8_run(vm, UINT64_MAX, &reason);
+    ASSERT_EQ(CHIP8_HALT_EXIT, reason);
+    uint8_t pixels[CHIP8_FRAMEBUFFER_MAX_WIDTH * CHIP8_FRAMEBUFFER_MAX_HEIGHT];
+    uint8_t width, height;
+    ASSERT_EQ(0, chip8_framebuffer(vm, pixels, sizeof(pixels), &width, &height));
+    ASSERT_EQ(64u, width);
+    ASSERT_EQ(32u, height);
+    // The pixel is drawn at the index of the key that was pressed
+    ASSERT_EQ(0u, pixels[0]);
+    ASSERT_EQ(1u, pixels[1]);
+}
+
+TEST_F(Chip8API, RejectsAFramebufferThatIsTooSmall) {
+    uint8_t pixels[16];
+    ASSERT_EQ(-1, chip8_framebuffer(vm, pixels, sizeof(pixels), nullptr, nullptr));
+}
+
+TEST_F(Chip8API, RejectsUnknownModesAndQuirkProfiles) {
+    ASSERT_EQ(nullptr, chip8_create((chip8_mode)2));
+    ASSERT_EQ(-1, chip8_set_quirks(vm, (chip8_quirks)3));
+    ASSERT_EQ(-1, chip8_set_quirks(vm, (chip8_quirks)-1));
+    ASSERT_EQ(0, chip8_set_quirks(vm, CHIP8_QUIRKS_XO_CHIP));
+    // The virtual machine still executes programs with the profile that was set
+    ASSERT_EQ(0, chip8_load(vm, CountingProgram, sizeof(CountingProgram)));
+    chip8_halt_reason reason;
+    ASSERT_EQ(3u, chip8_run(vm, 3u, &reason));
+}
+
+TEST_F(Chip8API, AssemblesAProgram) {
+    ASSERT_EQ(0, chip8_assemble(vm, "section .text:\n    MOV V0 0x01\n    EXT\n"));
+    chip8_halt_reason reason;
+    ASSERT_EQ(1u, chip8_run(vm, UINT64_MAX, &reason));
+    ASSERT_EQ(CHIP8_HALT_EXIT, reason);
+}
+
+TEST_F(Chip8API, ReportsAnAssemblerErrorInsteadOfTerminating) {
+    testing::internal::CaptureStdout();
+    testing::internal::CaptureStderr();
+    ASSERT_EQ(-1, chip8_assemble(vm, "section .text:\n    MOV V0 0x01\n    FOO V1\n"));
+    ASSERT_EQ(-1, chip8_assemble(vm, "section .text:\n    JMP missing\n"));
+    // The errors are not written to the output of the embedding program
+    ASSERT_EQ("", testing::internal::GetCapturedStdout());
+    ASSERT_EQ("", testing::internal::GetCapturedStderr());
+    chip8_halt_reason reason;
+    ASSERT_EQ(0u, chip8_run(vm, UINT64_MAX, &reason));
+    ASSERT_EQ(CHIP8_HALT_ERROR, reason);
+    // The virtual machine can be used again after the error
+    ASSERT_EQ(0, chip8_load(vm, CountingProgram, sizeof(CountingProgram)));
+    ASSERT_EQ(10u, chip8_run(vm, UINT64_MAX, &reason));
+}
+
+TEST_F(Chip8API, ResetsToTheLoadedProgram) {
+    ASSERT_EQ(-1, chip8_reset(vm));
+    // V0 += 1, I = 0x300, store V0 at 0x300, draw the byte at 0x300, jump to the start
+    uint8_t const program[] = {0x70, 0x01, 0xA3, 0x00, 0xF0, 0x55, 0xD1, 0x11, 0x12, 0x00};
+    ASSERT_EQ(0, chip8_load(vm, program, sizeof(program)));
+    chip8_halt_reason reason;
+    chip8_run(vm, UINT64_MAX, &reason);
+    uint64_t const hash = chip8_framebuffer_hash(vm);
+    chip8_run(vm, UINT64_MAX, &reason);
+    ASSERT_EQ(0, chip8_reset(vm));
+    ASSERT_EQ(0u, chip8_cycles(vm));
+    chip8_run(vm, UINT64_MAX, &reason);
+    ASSERT_EQ(CHIP8_HALT_FRAME_DONE, reason);
+    ASSERT_EQ(hash, chip8_framebuffer_hash(vm));
+}
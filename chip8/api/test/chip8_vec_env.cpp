@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <stdint.h>
+#include <vector>
+
+#include "../src/chip8_vec_env.h"
+
+// V0 = key, I = 0x208, draw the pixel at 0x208 at V0, V1, exit
+static uint8_t const KeyProgram[] = {0xF0, 0x0A, 0xA2, 0x08, 0xD0, 0x11, 0x00, 0xFD, 0x80};
+
+static size_t const EnvironmentCount = 5u;
+
+class Chip8VecEnv : public testing::Test {
+  protected:
+    void SetUp() override {
+        env = chip8_vec_env_create(CHIP8_MODE_CHIP8, KeyProgram, sizeof(KeyProgram), EnvironmentCount, 3u);
+        ASSERT_NE(nullptr, env);
+    }
+
+    void TearDown() override {
+        chip8_vec_env_destroy(env);
+    }
+
+    chip8_vec_env_t * env;
+    std::vector<uint8_t> frames = std::vector<uint8_t>(EnvironmentCount * CHIP8_VEC_ENV_FRAME_SIZE, 0xFF);
+    std::vector<uint8_t> done = std::vector<uint8_t>(EnvironmentCount, 0xFF);
+};
+
+TEST_F(Chip8VecEnv, StepsEveryEnvironmentWithItsAction) {
+    uint16_t const actions[EnvironmentCount] = {1u << 3, 0u, 1u << 7, 0u, 1u << 0};
+    chip8_vec_env_step(env, actions, frames.data(), done.data());
+    ASSERT_EQ(std::vector<uint8_t>({1u, 0u, 1u, 0u, 1u}), done);
+    ASSERT_EQ(0x10u, frames[0 * CHIP8_VEC_ENV_FRAME_SIZE]);
+    ASSERT_EQ(0x00u, frames[1 * CHIP8_VEC_ENV_FRAME_SIZE]);
+    ASSERT_EQ(0x01u, frames[2 * CHIP8_VEC_ENV_FRAME_SIZE]);
+    ASSERT_EQ(0x00u, frames[3 * CHIP8_VEC_ENV_FRAME_SIZE]);
+    ASSERT_EQ(0x80u, frames[4 * CHIP8_VEC_ENV_FRAME_SIZE]);
+    // Only the first pixel of each frame can be set
+    for (size_t i = 0u; i < EnvironmentCount; i++) {
+        for (size_t byte = 1u; byte < CHIP8_VEC_ENV_FRAME_SIZE; byte++) {
+            ASSERT_EQ(0u, frames[i * CHIP8_VEC_ENV_FRAME_SIZE + byte]);
+        }
+    }
+}
+
+TEST_F(Chip8VecEnv, ResetsTheEnvironmentsThatAreDone) {
+    uint16_t const actions[EnvironmentCount] = {1u << 3, 0u, 0u, 0u, 0u};
+    chip8_vec_env_step(env, actions, frames.data(), done.data());
+    ASSERT_EQ(1u, done[0]);
+    chip8_vec_env_reset(env, done.data());
+    uint16_t const noActions[EnvironmentCount] = {0u};
+    chip8_vec_env_step(env, noActions, frames.data(), done.data());
+    ASSERT_EQ(std::vector<uint8_t>(EnvironmentCount, 0u), done);
+    ASSERT_EQ(0x00u, frames[0]);
+    chip8_vec_env_step(env, actions, frames.data(), done.data());
+    ASSERT_EQ(1u, done[0]);
+    ASSERT_EQ(0x10u, frames[0]);
+}
+
+TEST_F(Chip8VecEnv, StopsOnlyTheEnvironmentWhoseStackOverflows) {
+    // Skip if key 0 is not pressed, call itself until the stack overflows, V5 += 1, jump to 0x200
+    uint8_t const program[] = {0xE0, 0xA1, 0x22, 0x02, 0x75, 0x01, 0x12, 0x00};
+    chip8_vec_env_t * recursiveEnv = chip8_vec_env_create(CHIP8_MODE_CHIP8, program, sizeof(program),
+                                                          EnvironmentCount, 3u);
+    ASSERT_NE(nullptr, recursiveEnv);
+    uint16_t const actions[EnvironmentCount] = {0u, 0u, 1u << 0, 0u, 0u};
+    // The calls span several frames
+    for (int step = 0; step < 16; step++) {
+        chip8_vec_env_step(recursiveEnv, actions, frames.data(), done.data());
+        if (done[2]) {
+            break;
+        }
+    }
+    ASSERT_EQ(std::vector<uint8_t>({0u, 0u, 1u, 0u, 0u}), done);
+    // The other environments keep running
+    chip8_vec_env_step(recursiveEnv, actions, frames.data(), done.data());
+    ASSERT_EQ(std::vector<uint8_t>({0u, 0u, 1u, 0u, 0u}), done);
+    chip8_vec_env_destroy(recursiveEnv);
+}
@@ -32,5 +32,17 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#if defined(OS_UNIX_LIKE)
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if defined(OS_LINUX)
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
 
 #endif
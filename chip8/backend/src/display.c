@@ -21,41 +21,79 @@
 #include "display.h"
 #include "../../../build/chip8/main/src/chip8_config.h"
 #include "../../base/src/logger.h"
+#include "../../base/src/memory.h"
 #include "../../io/src/path_utils.h"
 #include "backend_pre_compiled_header.h"
 
+static uint32_t display_refresh_rate(display_t const *);
+static void display_present(display_t *, display_frame_t const *, bool);
+static void display_record_render_cost(display_t *, uint64_t);
+static void display_render(SDL_Renderer *, display_frame_t const *);
 static int display_set_window_icon(SDL_Window *, char const *);
 
-void display_render(display_t display) {
-    // Setting renderer color
-    SDL_SetRenderDrawColor(display.renderer, 0xFF, 0xFF, 0xFF, 0xFF); // white color
-    uint8_t currentColor = 0xFF;
-    SDL_RenderClear(display.renderer);
-    for (size_t height = 0; height < GRAPHICS_SYSTEM_HEIGHT; height++) {
-        for (size_t width = 0; width < GRAPHICS_SYSTEM_WIDTH; width++) {
-            // Render black filled quad (Currently the display uses 20x20 pixels to simulate a single pixel of the
-            // graphics system)
-            SDL_Rect fillRect = {width * SCALE_FACTOR, height * SCALE_FACTOR, (width + 1) * SCALE_FACTOR,
-                                 (height + 1) * SCALE_FACTOR};
-            // Check if current color is white and pixel is set before changing renderer color
-            if (currentColor && display.graphicsSystem[width][height]) {
-                SDL_SetRenderDrawColor(display.renderer, 0x00, 0x00, 0x00, 0xFF); // black color
-                currentColor = 0x00;
-            }
-            // Check if current color is black and pixel is not set before changing renderer color
-            else if (!currentColor && !display.graphicsSystem[width][height]) {
-                SDL_SetRenderDrawColor(display.renderer, 0xFF, 0xFF, 0xFF, 0xFF); // white color
-                currentColor = 0xFF;
-            }
-            SDL_RenderFillRect(display.renderer, &fillRect);
+/// The amount of pixels that are passed to the renderer at once
+#define DISPLAY_RENDER_BATCH_SIZE (512)
+
+/// The colors of the pixels - white is the background and black the color of the first plane
+uint8_t const display_palette[GRAPHICS_SYSTEM_COLOR_COUNT][3] = {
+    {0xFF, 0xFF, 0xFF}, {0x00, 0x00, 0x00}, {0xAA, 0xAA, 0xAA}, {0x55, 0x55, 0x55},
+    {0xFF, 0x00, 0x00}, {0x80, 0x00, 0x00}, {0x00, 0xFF, 0x00}, {0x00, 0x80, 0x00},
+    {0x00, 0x00, 0xFF}, {0x00, 0x00, 0x80}, {0xFF, 0xFF, 0x00}, {0x80, 0x80, 0x00},
+    {0xFF, 0x00, 0xFF}, {0x80, 0x00, 0x80}, {0x00, 0xFF, 0xFF}, {0x00, 0x80, 0x80}};
+
+void display_publish_frame(display_t * display) {
+    display->publishedFrames++;
+    if (display->flags & DISPLAY_FLAG_OFFSCREEN) {
+        // Nobody consumes the frames of an offscreen display
+        return;
+    }
+    display_frame_t * frame = &display->frames[triple_buffer_back_index(&display->frameBuffer)];
+    frame->graphicsSystem = *display->graphicsSystem;
+    frame->inputTimestamp = 0u;
+    if (display->latency) {
+        uint64_t hash = display_hash(display);
+        if (display->latency->pendingFrameChange && hash != display->publishedHash) {
+            input_latency_record(display->latency, &display->latency->frameChange,
+                                 display->latency->pendingFrameChange, SDL_GetPerformanceCounter());
+            frame->inputTimestamp = display->latency->pendingFrameChange;
+            display->latency->pendingFrameChange = 0u;
         }
+        display->publishedHash = hash;
     }
-    // Update screen
-    SDL_RenderPresent(display.renderer);
-    SDL_UpdateWindowSurface(display.window);
+    triple_buffer_publish(&display->frameBuffer);
+}
+
+bool display_skip_frame(display_t * display) {
+    uint32_t const framePeriod = 1000000u / DISPLAY_FRAME_RATE;
+    // Only every presentInterval-th frame is presented, so the renderer gets as much time as it needs per frame
+    uint32_t const presentInterval = display->renderCost / framePeriod + 1u;
+    if (display->consecutiveSkips < DISPLAY_MAX_FRAME_SKIP && display->consecutiveSkips + 1u < presentInterval) {
+        display->consecutiveSkips++;
+        display->skippedFrames++;
+        return true;
+    }
+    display->consecutiveSkips = 0u;
+    return false;
+}
+
+uint64_t display_hash(display_t const * display) {
+    return graphics_system_hash(display->graphicsSystem);
 }
 
-int display_init(display_t * display) {
+int display_init(display_t * display, uint32_t flags) {
+    display->flags = flags;
+    display->publishedFrames = 0u;
+    display->skippedFrames = 0u;
+    display->consecutiveSkips = 0u;
+    display->renderCost = 0u;
+    display->statistics = NULL;
+    display->latency = NULL;
+    display->window = NULL;
+    display->renderer = NULL;
+    if (flags & DISPLAY_FLAG_OFFSCREEN) {
+        // The frames are only kept in memory - SDL is not needed at all
+        return 0;
+    }
     if (SDL_Init(SDL_INIT_VIDEO)) {
         printf("SDL could not initialize! SDL Error: %s\n", SDL_GetError());
         return -1;
@@ -67,25 +105,43 @@ int display_init(display_t * display) {
         }
         // Create window
         display->window = SDL_CreateWindow("CHIP-8", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-                                           GRAPHICS_SYSTEM_WIDTH * SCALE_FACTOR, GRAPHICS_SYSTEM_HEIGHT * SCALE_FACTOR,
-                                           SDL_WINDOW_SHOWN);
+                                           GRAPHICS_SYSTEM_LOW_RESOLUTION_WIDTH * SCALE_FACTOR,
+                                           GRAPHICS_SYSTEM_LOW_RESOLUTION_HEIGHT * SCALE_FACTOR, SDL_WINDOW_SHOWN);
         if (!display->window) {
             printf("Window could not be created! SDL Error: %s\n", SDL_GetError());
             return -1;
         } else {
-            // Create renderer for window
-            display->renderer = SDL_CreateRenderer(display->window, -1, SDL_RENDERER_ACCELERATED);
+            // Initialize the frames that are handed over by the emulation thread
+            memset(display->frames, 0, sizeof(display->frames));
+            triple_buffer_init(&display->frameBuffer);
+            if (flags & DISPLAY_FLAG_STATISTICS) {
+                display->statistics = new (frame_statistics_t);
+                if (!display->statistics) {
+                    printf("Could not allocate memory for the frame statistics\n");
+                    return -1;
+                }
+                frame_statistics_init(display->statistics, display_refresh_rate(display),
+                                      SDL_GetPerformanceFrequency());
+            }
+            if (flags & DISPLAY_FLAG_LATENCY) {
+                display->latency = new (input_latency_t);
+                if (!display->latency) {
+                    printf("Could not allocate memory for the input latency measurement\n");
+                    return -1;
+                }
+                input_latency_init(display->latency, SDL_GetPerformanceFrequency());
+                display->publishedHash = display_hash(display);
+            }
+            // Create renderer for window - with vsync SDL_RenderPresent waits for the next vertical blank
+            display->renderer = SDL_CreateRenderer(display->window, -1,
+                                                   (flags & DISPLAY_FLAG_VSYNC)
+                                                       ? SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC
+                                                       : SDL_RENDERER_ACCELERATED);
             if (!display->renderer) {
                 printf("Renderer could not be created! SDL Error: %s\n", SDL_GetError());
                 return -1;
             }
             SDL_SetRenderDrawColor(display->renderer, 0xFF, 0xFF, 0xFF, 0xFF); // white
-            // Initialize graphics system
-            for (size_t width = 0; width < GRAPHICS_SYSTEM_WIDTH; width++) {
-                for (size_t height = 0; height < GRAPHICS_SYSTEM_HEIGHT; height++) {
-                    display->graphicsSystem[width][height] = 0u;
-                }
-            }
             return display_set_window_icon(display->window, "chip8_window_icon.bmp");
         }
     }
@@ -93,14 +149,183 @@ int display_init(display_t * display) {
 }
 
 void display_quit(display_t * display) {
-    // Destroy window and renderer
-    SDL_DestroyRenderer(display->renderer);
+    if (display->flags & DISPLAY_FLAG_OFFSCREEN) {
+        return;
+    }
+    if (display->renderer) {
+        // Making sure the last published frame is still rendered, even if its presentation was skipped
+        uint8_t frontIndex;
+        if (triple_buffer_acquire(&display->frameBuffer, &frontIndex) || display->consecutiveSkips) {
+            display_present(display, &display->frames[frontIndex], true);
+        }
+        SDL_DestroyRenderer(display->renderer);
+        display->renderer = NULL;
+    }
+    if (display->statistics) {
+        frame_statistics_report(display->statistics, display->publishedFrames, display->skippedFrames, stdout);
+        free(display->statistics);
+        display->statistics = NULL;
+    }
+    if (display->latency) {
+        input_latency_report(display->latency, stdout);
+        free(display->latency);
+        display->latency = NULL;
+    }
+    // Destroy window
     SDL_DestroyWindow(display->window);
     display->window = NULL;
-    display->renderer = NULL;
     SDL_Quit();
 }
 
+bool display_present_frame(display_t * display) {
+    uint8_t frontIndex;
+    bool const newFrame = triple_buffer_acquire(&display->frameBuffer, &frontIndex);
+    // With vsync a frame is presented at every vertical blank, independent of the rate frames are published at.
+    // Emulated frames are repeated if the display is faster and dropped if it is slower than the emulation.
+    if (!newFrame && !(display->flags & DISPLAY_FLAG_VSYNC)) {
+        return false;
+    }
+    // If rendering takes longer than a frame period the presentation of new frames is skipped, so the events are still
+    // polled in time. The render cost is only measured without vsync, so frames are never skipped with vsync
+    if (newFrame && display_skip_frame(display)) {
+        return false;
+    }
+    uint64_t const renderStart = SDL_GetPerformanceCounter();
+    display_present(display, &display->frames[frontIndex], newFrame);
+    if (!(display->flags & DISPLAY_FLAG_VSYNC)) {
+        display_record_render_cost(display, renderStart);
+    }
+    return true;
+}
+
+int display_write_screenshot(display_t const * display, char const * path) {
+    return display_write_bitmap(display->graphicsSystem, path);
+}
+
+int display_write_bitmap(graphics_system_t const * graphicsSystem, char const * path) {
+    FILE * file = fopen(path, "wb");
+    if (!file) {
+        printf("Could not open file \"%s\"\n", path);
+        return -1;
+    }
+    // Header of a binary portable bitmap - followed by the rows, each pixel is a bit (1 is black). A pixel is black if
+    // it is set in any plane
+    uint8_t const width = graphics_system_width(graphicsSystem);
+    uint8_t const height = graphics_system_height(graphicsSystem);
+    fprintf(file, "P4\n%i %i\n", width, height);
+    uint8_t row[GRAPHICS_SYSTEM_HIGH_RESOLUTION_WIDTH / 8];
+    for (uint8_t y = 0; y < height; y++) {
+        // The words of a row are stored with the leftmost pixel in the most significant bit, like the bytes of a PBM
+        for (uint8_t byte = 0; byte < width / 8; byte++) {
+            uint64_t pixels = 0;
+            for (uint8_t plane = 0; plane < GRAPHICS_SYSTEM_PLANE_COUNT; plane++) {
+                pixels |= graphicsSystem->planes[plane][y][byte / 8];
+            }
+            row[byte] = (uint8_t)(pixels >> (56 - 8 * (byte % 8)));
+        }
+        if (fwrite(row, sizeof(uint8_t), width / 8, file) < width / 8u) {
+            printf("Could not write to file \"%s\"\n", path);
+            fclose(file);
+            return -1;
+        }
+    }
+    fclose(file);
+    return 0;
+}
+
+/// @brief Determines the rate frames are expected to be presented at
+/// @param display The display
+/// @return The refresh rate of the display if vsync is enabled, otherwise the rate frames are published at
+static uint32_t display_refresh_rate(display_t const * display) {
+    SDL_DisplayMode mode;
+    if ((display->flags & DISPLAY_FLAG_VSYNC) && !SDL_GetWindowDisplayMode(display->window, &mode) &&
+        mode.refresh_rate > 0) {
+        return (uint32_t)mode.refresh_rate;
+    }
+    return DISPLAY_FRAME_RATE;
+}
+
+/// @brief Renders and presents a frame and records its presentation in the statistics and the input latency
+/// @param display The display where the frame is presented
+/// @param frame The frame that is presented
+/// @param newFrame Whether the frame was not presented before
+static void display_present(display_t * display, display_frame_t const * frame, bool newFrame) {
+    display_render(display->renderer, frame);
+    if (display->statistics) {
+        frame_statistics_record_present(display->statistics, SDL_GetPerformanceCounter(), !newFrame);
+    }
+    if (display->latency && newFrame && frame->inputTimestamp) {
+        input_latency_record(display->latency, &display->latency->present, frame->inputTimestamp,
+                             SDL_GetPerformanceCounter());
+    }
+}
+
+/// @brief Adds the time a frame took to render to the moving average of the render cost
+/// @param display The display whose render cost is updated
+/// @param renderStart The time the rendering of the frame started (performance counter)
+static void display_record_render_cost(display_t * display, uint64_t renderStart) {
+    int64_t const renderTime =
+        (int64_t)((SDL_GetPerformanceCounter() - renderStart) * 1000000u / SDL_GetPerformanceFrequency());
+    int64_t const renderCost = display->renderCost;
+    display->renderCost = (uint32_t)(renderCost + (renderTime - renderCost) / DISPLAY_RENDER_COST_SMOOTHING);
+}
+
+/// @brief Renders a frame
+/// @param renderer The renderer that is used to render the frame
+/// @param frame The frame that is rendered
+static void display_render(SDL_Renderer * renderer, display_frame_t const * frame) {
+    graphics_system_t const * graphicsSystem = &frame->graphicsSystem;
+    uint8_t const width = graphics_system_width(graphicsSystem);
+    uint8_t const height = graphics_system_height(graphicsSystem);
+    // The window keeps its size, so the pixels of the high resolution mode are half as large
+    int const pixelSize = SCALE_FACTOR >> graphicsSystem->mode;
+    SDL_Rect fillRects[DISPLAY_RENDER_BATCH_SIZE];
+    int fillRectCount = 0;
+    SDL_SetRenderDrawColor(renderer, display_palette[0][0], display_palette[0][1], display_palette[0][2], 0xFF);
+    SDL_RenderClear(renderer);
+    // Only the set pixels are rendered as filled quads, one color after another. Only colors that are made up of used
+    // planes can occur, so a classic program renders the first plane only
+    for (uint8_t color = 1; color < GRAPHICS_SYSTEM_COLOR_COUNT; color++) {
+        if (color & ~graphicsSystem->usedPlanes) {
+            continue;
+        }
+        if (fillRectCount) {
+            SDL_RenderFillRects(renderer, fillRects, fillRectCount);
+            fillRectCount = 0;
+        }
+        SDL_SetRenderDrawColor(renderer, display_palette[color][0], display_palette[color][1],
+                               display_palette[color][2], 0xFF);
+        for (uint8_t y = 0; y < height; y++) {
+            for (uint8_t word = 0; word < width / 64; word++) {
+                // The pixels that have exactly this color - set in the planes of the color and cleared in the others
+                uint64_t pixels = UINT64_MAX;
+                for (uint8_t plane = 0; plane < GRAPHICS_SYSTEM_PLANE_COUNT; plane++) {
+                    if (graphicsSystem->usedPlanes & (1u << plane)) {
+                        pixels &= (color & (1u << plane)) ? graphicsSystem->planes[plane][y][word]
+                                                          : ~graphicsSystem->planes[plane][y][word];
+                    }
+                }
+                // Stops as soon as the remaining pixels of the word are cleared
+                for (uint8_t x = word * 64; pixels; pixels <<= 1, x++) {
+                    if (!(pixels >> 63)) {
+                        continue;
+                    }
+                    fillRects[fillRectCount++] = (SDL_Rect){x * pixelSize, y * pixelSize, pixelSize, pixelSize};
+                    if (fillRectCount == DISPLAY_RENDER_BATCH_SIZE) {
+                        SDL_RenderFillRects(renderer, fillRects, fillRectCount);
+                        fillRectCount = 0;
+                    }
+                }
+            }
+        }
+    }
+    if (fillRectCount) {
+        SDL_RenderFillRects(renderer, fillRects, fillRectCount);
+    }
+    // Update screen
+    SDL_RenderPresent(renderer);
+}
+
 /// @brief Sets the icon of a window
 /// @param window The window where the icon is set
 /// @param iconPath Path to the icon
@@ -22,39 +22,147 @@
 #define CHIP8_DISPLAY_H_
 
 #include "../../../external/SDL/include/SDL.h"
+#include "backend_pre_compiled_header.h"
 
-/// The graphics system of the chip-8 has a height of 32 pixels
-#define GRAPHICS_SYSTEM_HEIGHT (32)
+// This file is included in the test-suite that is written in c++ using the google-test framework
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../../core/src/graphics_system.h"
+#include "frame_statistics.h"
+#include "input_latency.h"
+#include "triple_buffer.h"
+
+/// The scale factor from the emulator display to the real display in low resolution mode
+#define SCALE_FACTOR                  (20)
+
+/// The amount of frames that are used to hand over finished frames to the thread that presents them
+#define DISPLAY_FRAME_COUNT           (3)
+
+/// The rate frames are published at by the emulation - used if the refresh rate of the display is unknown
+#define DISPLAY_FRAME_RATE            (60)
 
-/// The graphics system of the chip-8 has a width of 64 pixels
-#define GRAPHICS_SYSTEM_WIDTH  (64)
+/// The maximum amount of consecutive new frames that are not presented if rendering is slower than the frame rate
+#define DISPLAY_MAX_FRAME_SKIP        (4)
 
-/// The scale factor from the emulator display to the real display
-#define SCALE_FACTOR           (20)
+/// The weight of the latest render cost in the moving average is 1 / DISPLAY_RENDER_COST_SMOOTHING
+#define DISPLAY_RENDER_COST_SMOOTHING (8)
+
+/// The colors of the pixels - white is the background and black the color of the first plane
+extern uint8_t const display_palette[GRAPHICS_SYSTEM_COLOR_COUNT][3];
+
+/// @brief Flags that configure the display
+typedef enum {
+    /// Presents a frame at every vertical blank of the display instead of every published frame
+    DISPLAY_FLAG_VSYNC = 0b00000001,
+    /// Collects frame pacing statistics that are reported when the display is closed
+    DISPLAY_FLAG_STATISTICS = 0b00000010,
+    /// Keeps the frames in memory only - no window or renderer is created
+    DISPLAY_FLAG_OFFSCREEN = 0b00000100,
+    /// Measures the latency from key events to the reaction of the program - reported when the display is closed
+    DISPLAY_FLAG_LATENCY = 0b00001000
+} display_flag;
+
+/// @brief A finished frame that is handed from the emulation thread to the thread that owns the window
+typedef struct {
+    /// The pixels of the frame
+    graphics_system_t graphicsSystem;
+    /// Time the key event that caused the frame was received (0 if the frame was not caused by a key event)
+    uint64_t inputTimestamp;
+} display_frame_t;
 
 /// @brief Models the display of the emulator using SDL
 typedef struct {
     /// The window where the display of the emulator is displayed
     SDL_Window * window;
-    /// The renderer that is used to render the display of the emulator in the window
+    /// The renderer that is used to render the display of the emulator in the window (owned by the thread that created
+    /// the window)
     SDL_Renderer * renderer;
-    /// The underlying graphics system of the CHIP-8
-    uint8_t graphicsSystem[GRAPHICS_SYSTEM_WIDTH][GRAPHICS_SYSTEM_HEIGHT];
+    /// The framebuffer of the CHIP-8 that is presented (owned by the emulation thread, set by virtual_machine_init)
+    graphics_system_t const * graphicsSystem;
+    /// Finished frames that are handed over to the thread that presents them
+    display_frame_t frames[DISPLAY_FRAME_COUNT];
+    /// Triple buffer that determines which of the frames is written, published or rendered
+    triple_buffer_t frameBuffer;
+    /// Flags that configure the display
+    uint32_t flags;
+    /// The amount of frames that were published (owned by the emulation thread)
+    uint64_t publishedFrames;
+    /// The amount of published frames whose presentation was skipped (owned by the thread that presents the frames)
+    uint64_t skippedFrames;
+    /// The amount of frames that were skipped since the last presented frame (owned by the thread that presents the
+    /// frames)
+    uint8_t consecutiveSkips;
+    /// Moving average of the time it takes to render and present a frame in microseconds (owned by the thread that
+    /// presents the frames, measured without vsync only, because a present with vsync waits for the vertical blank)
+    uint32_t renderCost;
+    /// Frame pacing statistics collected when the frames are presented (NULL if they are not collected)
+    frame_statistics_t * statistics;
+    /// Input latency measurement shared by the emulation thread and the thread that presents the frames (NULL if it is
+    /// not measured)
+    input_latency_t * latency;
+    /// The hash of the last published frame - only computed if the input latency is measured
+    uint64_t publishedHash;
 } display_t;
 
-/// @brief Renders the display
-/// @param display The display that is rendered
-void display_render(display_t display);
+/// @brief Publishes the current state of the graphics system as a finished frame
+/// @details Never blocks - display_present_frame always presents the latest published frame. If the input latency is
+/// measured, the first changed frame after a key event is stamped with the time of the key event.
+/// @param display The display where the frame is published
+void display_publish_frame(display_t * display);
+
+/// @brief Decides whether the presentation of a new frame is skipped, because rendering is slower than the frame rate
+/// @details Called by display_present_frame on the thread that presents the frames, which is also the thread that
+/// measures the render cost. If rendering a frame takes n frame periods, only every n-th frame is presented, but at
+/// least every (DISPLAY_MAX_FRAME_SKIP + 1)th frame. The emulation is never slowed down by the presentation
+/// @param display The display where the frame would be presented
+/// @return true if the frame should not be presented, false if it should
+bool display_skip_frame(display_t * display);
+
+/// @brief Computes a hash of the current state of the graphics system
+/// @details Used to compare frames cheaply, e.g. in automated runs
+/// @param display The display whose graphics system is hashed
+/// @return The 64-bit FNV-1a hash of the graphics system (see graphics_system_hash)
+uint64_t display_hash(display_t const * display);
+
+/// @brief Presents the latest published frame
+/// @details Called by the thread that initialized the display between polling the SDL events. With vsync a frame is
+/// presented at every vertical blank, so the call waits for the next one and repeats the last frame if no new frame was
+/// published. Without vsync only new frames are presented, and some of them are skipped if rendering is slower than the
+/// frame rate (see display_skip_frame)
+/// @param display The display where the frame is presented
+/// @return true if a frame was presented, false if no new frame was published
+bool display_present_frame(display_t * display);
 
 /// @brief Initializes the display
-/// @param window The window where the display of the emulator is emulated
-/// @param renderer The renderer that is used to create image from
+/// @details The window and the renderer are created on the calling thread, which has to be the thread that polls the
+/// SDL events - SDL only supports rendering on that thread on every platform. If the display is offscreen only the
+/// graphics system is initialized
+/// @param display The display that is initialized
+/// @param flags Flags that configure the display (see display_flag)
 /// @return 0 if everything went well, -1 if an error occured
-int display_init(display_t * display);
+int display_init(display_t * display, uint32_t flags);
 
-/// @brief Quits SDL
-/// @param window The window that is closed
-/// @param renderer The renderer used to render the display of the emulator
+/// @brief Presents the last published frame, reports the frame pacing statistics and the input latency if they were
+/// collected and quits SDL
+/// @param display The display that is closed
 void display_quit(display_t * display);
 
+/// @brief Stores the current state of the graphics system as a portable bitmap (binary PBM)
+/// @param display The display whose graphics system is stored
+/// @param path The path of the file that is written
+/// @return 0 if everything went well, -1 if an error occured
+int display_write_screenshot(display_t const * display, char const * path);
+
+/// @brief Stores a frame as a portable bitmap (binary PBM) - a pixel is black if it is set in any plane
+/// @param graphicsSystem The frame that is stored
+/// @param path The path of the file that is written
+/// @return 0 if everything went well, -1 if an error occured
+int display_write_bitmap(graphics_system_t const * graphicsSystem, char const * path);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
@@ -0,0 +1,109 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file frame_export.c
+ * @brief Definitions regarding the export of the framebuffer into a POSIX shared memory segment
+ */
+
+#include "frame_export.h"
+
+static inline int frame_export_sequence(frame_export_segment_t const *);
+
+int frame_export_init(frame_export_t * frameExport, char const * name) {
+#if defined(OS_UNIX_LIKE)
+    if (name[0] != '/') {
+        printf("The name of the shared memory segment \"%s\" has to start with a slash\n", name);
+        return -1;
+    }
+    frameExport->name = name;
+    frameExport->sequence = 0;
+    shm_unlink(name);
+    int const file = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (file < 0) {
+        printf("Could not create the shared memory segment \"%s\": %s\n", name, strerror(errno));
+        return -1;
+    }
+    void * segment = MAP_FAILED;
+    if (!ftruncate(file, sizeof(frame_export_segment_t))) {
+        segment = mmap(NULL, sizeof(frame_export_segment_t), PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    }
+    // The mapping keeps the segment alive
+    close(file);
+    if (segment == MAP_FAILED) {
+        printf("Could not map the shared memory segment \"%s\": %s\n", name, strerror(errno));
+        shm_unlink(name);
+        return -1;
+    }
+    frameExport->segment = (frame_export_segment_t *)segment;
+    // The segment is zero filled, so readers see an empty frame until the first frame is published
+    frameExport->segment->version = FRAME_EXPORT_VERSION;
+    frameExport->segment->mode = GRAPHICS_SYSTEM_MODE_LOW_RESOLUTION;
+    SDL_MemoryBarrierRelease();
+    frameExport->segment->magic = FRAME_EXPORT_MAGIC;
+    return 0;
+#else
+    (void)frameExport;
+    printf("Exporting the frames to \"%s\" is only supported on unix-like systems\n", name);
+    return -1;
+#endif
+}
+
+void frame_export_free(frame_export_t * frameExport) {
+#if defined(OS_UNIX_LIKE)
+    munmap(frameExport->segment, sizeof(frame_export_segment_t));
+    shm_unlink(frameExport->name);
+#else
+    (void)frameExport;
+#endif
+}
+
+void frame_export_publish(frame_export_t * frameExport, graphics_system_t const * graphicsSystem) {
+    frame_export_segment_t * segment = frameExport->segment;
+    // The exchange is a full barrier, the frame is not written before the sequence is odd
+    SDL_AtomicSet(&segment->sequence, frameExport->sequence + 1);
+    segment->mode = graphicsSystem->mode;
+    segment->usedPlanes = graphicsSystem->usedPlanes;
+    segment->frames++;
+    // Planes that were never used are always empty, so a classic program only copies the first plane
+    memcpy(segment->planes, graphicsSystem->planes, graphics_system_used_planes_size(graphicsSystem));
+    frameExport->sequence += 2;
+    SDL_AtomicSet(&segment->sequence, frameExport->sequence);
+}
+
+bool frame_export_read(frame_export_segment_t const * segment, graphics_system_t * graphicsSystem, uint64_t * frames) {
+    int const sequence = frame_export_sequence(segment);
+    if (sequence & 1) {
+        return false;
+    }
+    // Makes sure the frame is read after the sequence
+    SDL_MemoryBarrierAcquire();
+    graphicsSystem->mode = (graphics_system_mode)segment->mode;
+    graphicsSystem->usedPlanes = (uint8_t)segment->usedPlanes;
+    *frames = segment->frames;
+    memcpy(graphicsSystem->planes, segment->planes, sizeof(graphicsSystem->planes));
+    // Makes sure the frame was read before the sequence is read again
+    SDL_MemoryBarrierAcquire();
+    return frame_export_sequence(segment) == sequence;
+}
+
+/// @brief Reads the sequence of the seqlock
+/// @details A plain volatile load, because an atomic read-modify-write would fault on a segment that is mapped
+/// read-only by a reader
+/// @param segment The mapped segment
+/// @return The sequence
+static inline int frame_export_sequence(frame_export_segment_t const * segment) {
+    return *(int const volatile *)&segment->sequence.value;
+}
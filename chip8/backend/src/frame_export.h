@@ -0,0 +1,102 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file frame_export.h
+ * @brief Declarations regarding the export of the framebuffer into a POSIX shared memory segment
+ * @details Local processes like recorders, overlays and test harnesses map the segment and read the frames without
+ * copies by the emulator, sockets or serialization. The segment is protected by a seqlock: the sequence is odd while a
+ * frame is written. A reader copies the frame while the sequence is even and retries if the sequence has changed in the
+ * meantime (see frame_export_read). Publishing a frame is a copy of the planes that were used and two atomic stores.
+ */
+
+#ifndef CHIP8_FRAME_EXPORT_H_
+#define CHIP8_FRAME_EXPORT_H_
+
+#include "../../../external/SDL/include/SDL.h"
+#include "backend_pre_compiled_header.h"
+
+// This file is included in the test-suite that is written in c++ using the google-test framework
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../../core/src/graphics_system.h"
+
+/// The magic at the start of the segment ("C8FB" in little endian)
+#define FRAME_EXPORT_MAGIC   (0x42463843u)
+
+/// The version of the layout of the segment
+#define FRAME_EXPORT_VERSION (1u)
+
+/// @brief The layout of the shared memory segment
+typedef struct {
+    /// FRAME_EXPORT_MAGIC - written once the segment is initialized
+    uint32_t magic;
+    /// FRAME_EXPORT_VERSION
+    uint32_t version;
+    /// The sequence of the seqlock (a 32-bit integer) - odd while a frame is written
+    SDL_atomic_t sequence;
+    /// The resolution mode of the frame (see graphics_system_mode)
+    uint32_t mode;
+    /// Bitmask of the planes that were used - the other planes are empty
+    uint32_t usedPlanes;
+    /// Reserved - aligns the amount of frames to 8 bytes
+    uint32_t reserved;
+    /// The amount of frames that were published
+    uint64_t frames;
+    /// The rows of every plane as native 64-bit words, the leftmost pixel is the most significant bit (see
+    /// graphics_system_t)
+    uint64_t planes[GRAPHICS_SYSTEM_PLANE_COUNT][GRAPHICS_SYSTEM_HIGH_RESOLUTION_HEIGHT][GRAPHICS_SYSTEM_ROW_WORDS];
+} frame_export_segment_t;
+
+/// @brief Models the export of the framebuffer
+typedef struct {
+    /// The mapped segment
+    frame_export_segment_t * segment;
+    /// The name of the segment
+    char const * name;
+    /// The sequence of the last published frame - only the emulator writes the sequence, so it never reads it back
+    int sequence;
+} frame_export_t;
+
+/// @brief Creates the shared memory segment the framebuffer is exported to
+/// @details An existing segment with the same name is replaced. Only supported on unix-like systems
+/// @param frameExport The export that is initialized
+/// @param name The name of the segment - starts with a slash and has to stay valid until the export is freed
+/// @return 0 if everything went well, -1 if an error occured
+int frame_export_init(frame_export_t * frameExport, char const * name);
+
+/// @brief Unmaps and removes the shared memory segment - readers keep their mapping
+/// @param frameExport The export that is freed
+void frame_export_free(frame_export_t * frameExport);
+
+/// @brief Publishes a frame into the shared memory segment
+/// @param frameExport The export where the frame is published
+/// @param graphicsSystem The framebuffer that is published
+void frame_export_publish(frame_export_t * frameExport, graphics_system_t const * graphicsSystem);
+
+/// @brief Reads a consistent frame from a shared memory segment
+/// @param segment The mapped segment
+/// @param graphicsSystem Is set to the mode, the used planes and the planes of the frame
+/// @param frames Is set to the amount of frames that were published
+/// @return true if a consistent frame was read, false if a frame was written meanwhile and the read has to be retried
+bool frame_export_read(frame_export_segment_t const * segment, graphics_system_t * graphicsSystem, uint64_t * frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,345 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file frame_server.c
+ * @brief Definitions regarding the server that streams the frames to local viewers over a unix domain socket
+ */
+
+#include "frame_server.h"
+
+/// The bit of a key event of a viewer that is set if the key was pressed
+#define FRAME_SERVER_KEY_PRESSED (0x80u)
+
+/// The bit of a control byte of the payload that is set if the bytes of the run have changed
+#define FRAME_SERVER_CHANGED_RUN (0x80u)
+
+/// The longest run of the run-length encoding
+#define FRAME_SERVER_MAX_RUN     (128u)
+
+#if defined(OS_LINUX)
+static void frame_server_accept(frame_server_t *);
+static void frame_server_apply_input(frame_server_viewer_t *, keyBoardState_t *, keyBoardState_t *);
+static void frame_server_disconnect(frame_server_t *, frame_server_viewer_t *);
+static void frame_server_flush(frame_server_t *, frame_server_viewer_t *);
+static void frame_server_receive(frame_server_t *, frame_server_viewer_t *);
+static void frame_server_watch(frame_server_t *, frame_server_viewer_t *, bool);
+#endif
+
+int frame_server_init(frame_server_t * server, char const * path) {
+#if defined(OS_LINUX)
+    server->path = path;
+    server->frames = 0u;
+    memset(server->frame, 0, sizeof(server->frame));
+    for (uint8_t i = 0; i < FRAME_SERVER_MAX_VIEWERS; i++) {
+        server->viewers[i].socket = -1;
+    }
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        printf("The path of the socket \"%s\" is too long\n", path);
+        return -1;
+    }
+    strcpy(address.sun_path, path);
+    // A socket that was left behind by a previous server is replaced
+    struct stat status;
+    if (!lstat(path, &status) && S_ISSOCK(status.st_mode)) {
+        unlink(path);
+    }
+    server->listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (server->listener < 0) {
+        printf("Could not create the socket \"%s\": %s\n", path, strerror(errno));
+        return -1;
+    }
+    if (bind(server->listener, (struct sockaddr const *)&address, sizeof(address)) ||
+        listen(server->listener, FRAME_SERVER_MAX_VIEWERS)) {
+        printf("Could not listen on the socket \"%s\": %s\n", path, strerror(errno));
+        close(server->listener);
+        return -1;
+    }
+    server->eventLoop = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event event = {EPOLLIN, {.u32 = FRAME_SERVER_MAX_VIEWERS}};
+    if (server->eventLoop < 0 || epoll_ctl(server->eventLoop, EPOLL_CTL_ADD, server->listener, &event)) {
+        printf("Could not create the event loop of the frame server: %s\n", strerror(errno));
+        if (server->eventLoop >= 0) {
+            close(server->eventLoop);
+        }
+        close(server->listener);
+        unlink(path);
+        return -1;
+    }
+    return 0;
+#else
+    (void)server;
+    printf("Streaming the frames to \"%s\" is only supported under Linux\n", path);
+    return -1;
+#endif
+}
+
+void frame_server_free(frame_server_t * server) {
+#if defined(OS_LINUX)
+    for (uint8_t i = 0; i < FRAME_SERVER_MAX_VIEWERS; i++) {
+        if (server->viewers[i].socket >= 0) {
+            close(server->viewers[i].socket);
+        }
+    }
+    close(server->eventLoop);
+    close(server->listener);
+    unlink(server->path);
+#else
+    (void)server;
+#endif
+}
+
+void frame_server_publish(frame_server_t * server, graphics_system_t const * graphicsSystem) {
+    server->frames++;
+#if defined(OS_LINUX)
+    frame_server_pack_frame(graphicsSystem, server->frame);
+    for (uint8_t i = 0; i < FRAME_SERVER_MAX_VIEWERS; i++) {
+        frame_server_viewer_t * viewer = &server->viewers[i];
+        // A viewer that has not received its previous frame yet misses this one
+        if (viewer->socket < 0 || viewer->outputOffset < viewer->outputSize) {
+            continue;
+        }
+        uint16_t const size =
+            frame_server_encode_delta(viewer->frame, server->frame, viewer->output + FRAME_SERVER_HEADER_SIZE);
+        if (!size && viewer->mode == graphicsSystem->mode && viewer->usedPlanes == graphicsSystem->usedPlanes) {
+            continue;
+        }
+        memcpy(viewer->frame, server->frame, FRAME_SERVER_FRAME_SIZE);
+        viewer->mode = (uint8_t)graphicsSystem->mode;
+        viewer->usedPlanes = graphicsSystem->usedPlanes;
+        viewer->output[0] = (uint8_t)server->frames;
+        viewer->output[1] = (uint8_t)(server->frames >> 8);
+        viewer->output[2] = (uint8_t)(server->frames >> 16);
+        viewer->output[3] = (uint8_t)(server->frames >> 24);
+        viewer->output[4] = viewer->mode;
+        viewer->output[5] = viewer->usedPlanes;
+        viewer->output[6] = (uint8_t)size;
+        viewer->output[7] = (uint8_t)(size >> 8);
+        viewer->outputSize = FRAME_SERVER_HEADER_SIZE + size;
+        viewer->outputOffset = 0u;
+        frame_server_flush(server, viewer);
+    }
+#else
+    (void)graphicsSystem;
+#endif
+}
+
+void frame_server_poll(frame_server_t * server, keyBoardState_t * keyBoardState) {
+#if defined(OS_LINUX)
+    struct epoll_event events[FRAME_SERVER_MAX_VIEWERS + 1];
+    int const count = epoll_wait(server->eventLoop, events, FRAME_SERVER_MAX_VIEWERS + 1, 0);
+    for (int i = 0; i < count; i++) {
+        if (events[i].data.u32 == FRAME_SERVER_MAX_VIEWERS) {
+            frame_server_accept(server);
+            continue;
+        }
+        frame_server_viewer_t * viewer = &server->viewers[events[i].data.u32];
+        if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+            frame_server_receive(server, viewer);
+        }
+        if (viewer->socket >= 0 && (events[i].events & EPOLLOUT)) {
+            frame_server_flush(server, viewer);
+        }
+    }
+    // Keys that were pressed during this poll are released by the next one at the earliest
+    keyBoardState_t pressedKeys = 0u;
+    for (uint8_t i = 0; i < FRAME_SERVER_MAX_VIEWERS; i++) {
+        if (server->viewers[i].socket >= 0) {
+            frame_server_apply_input(&server->viewers[i], keyBoardState, &pressedKeys);
+        }
+    }
+#else
+    (void)server;
+    (void)keyBoardState;
+#endif
+}
+
+void frame_server_pack_frame(graphics_system_t const * graphicsSystem, uint8_t * frame) {
+    for (uint8_t plane = 0; plane < GRAPHICS_SYSTEM_PLANE_COUNT; plane++) {
+        for (uint8_t y = 0; y < GRAPHICS_SYSTEM_HIGH_RESOLUTION_HEIGHT; y++) {
+            for (uint8_t word = 0; word < GRAPHICS_SYSTEM_ROW_WORDS; word++) {
+                for (uint8_t byte = 0; byte < 8; byte++) {
+                    *frame++ = (uint8_t)(graphicsSystem->planes[plane][y][word] >> (56 - 8 * byte));
+                }
+            }
+        }
+    }
+}
+
+uint16_t frame_server_encode_delta(uint8_t const * previous, uint8_t const * frame, uint8_t * payload) {
+    uint16_t size = 0u;
+    // The size of the payload up to the last changed byte
+    uint16_t end = 0u;
+    for (uint16_t i = 0u; i < FRAME_SERVER_FRAME_SIZE;) {
+        bool const changed = previous[i] != frame[i];
+        uint16_t run = 1u;
+        while (i + run < FRAME_SERVER_FRAME_SIZE && run < FRAME_SERVER_MAX_RUN &&
+               (previous[i + run] != frame[i + run]) == changed) {
+            run++;
+        }
+        if (changed) {
+            payload[size++] = (uint8_t)(FRAME_SERVER_CHANGED_RUN | (run - 1u));
+            for (uint16_t j = 0u; j < run; j++) {
+                payload[size++] = previous[i + j] ^ frame[i + j];
+            }
+            end = size;
+        } else {
+            payload[size++] = (uint8_t)(run - 1u);
+        }
+        i += run;
+    }
+    return end;
+}
+
+int frame_server_decode_delta(uint8_t const * payload, uint16_t size, uint8_t * frame) {
+    uint16_t position = 0u;
+    for (uint16_t i = 0u; i < size;) {
+        uint8_t const control = payload[i++];
+        uint16_t const run = (control & (FRAME_SERVER_CHANGED_RUN - 1u)) + 1u;
+        if (position + run > FRAME_SERVER_FRAME_SIZE) {
+            return -1;
+        }
+        if (control & FRAME_SERVER_CHANGED_RUN) {
+            if (i + run > size) {
+                return -1;
+            }
+            for (uint16_t j = 0u; j < run; j++) {
+                frame[position + j] ^= payload[i + j];
+            }
+            i += run;
+        }
+        position += run;
+    }
+    return 0;
+}
+
+#if defined(OS_LINUX)
+/// @brief Accepts the viewers that are waiting - viewers beyond the maximum amount are disconnected right away
+/// @param server The server where the viewers connect to
+static void frame_server_accept(frame_server_t * server) {
+    int socket;
+    while ((socket = accept(server->listener, NULL, NULL)) >= 0) {
+        fcntl(socket, F_SETFL, O_NONBLOCK);
+        fcntl(socket, F_SETFD, FD_CLOEXEC);
+        uint8_t i = 0u;
+        while (i < FRAME_SERVER_MAX_VIEWERS && server->viewers[i].socket >= 0) {
+            i++;
+        }
+        struct epoll_event event = {EPOLLIN, {.u32 = i}};
+        if (i == FRAME_SERVER_MAX_VIEWERS || epoll_ctl(server->eventLoop, EPOLL_CTL_ADD, socket, &event)) {
+            close(socket);
+            continue;
+        }
+        frame_server_viewer_t * viewer = &server->viewers[i];
+        viewer->socket = socket;
+        // The first frame is encoded against an empty frame, the header is always sent
+        memset(viewer->frame, 0, sizeof(viewer->frame));
+        viewer->mode = GRAPHICS_SYSTEM_MODE_LOW_RESOLUTION;
+        viewer->usedPlanes = 0u;
+        viewer->outputSize = 0u;
+        viewer->outputOffset = 0u;
+        viewer->inputSize = 0u;
+        viewer->blocked = false;
+    }
+}
+
+/// @brief Applies the key events of a viewer to the state of the keyboard
+/// @param viewer The viewer whose key events are applied
+/// @param keyBoardState The state of the keyboard
+/// @param pressedKeys The keys that were pressed during the current poll - a release of one of them is deferred
+static void frame_server_apply_input(frame_server_viewer_t * viewer, keyBoardState_t * keyBoardState,
+                                     keyBoardState_t * pressedKeys) {
+    uint8_t applied = 0u;
+    while (applied < viewer->inputSize) {
+        uint8_t const event = viewer->input[applied];
+        keyBoardState_t const keyCode = (keyBoardState_t)(1u << (event & 0x0Fu));
+        bool const pressed = event & FRAME_SERVER_KEY_PRESSED;
+        if (!pressed && (*pressedKeys & keyCode)) {
+            break;
+        }
+        if (pressed) {
+            *pressedKeys |= keyCode;
+        }
+        keyboard_apply(keyBoardState, keyCode, pressed);
+        applied++;
+    }
+    viewer->inputSize -= applied;
+    memmove(viewer->input, viewer->input + applied, viewer->inputSize);
+}
+
+/// @brief Closes the connection to a viewer
+/// @param server The server the viewer is connected to
+/// @param viewer The viewer that is disconnected
+static void frame_server_disconnect(frame_server_t * server, frame_server_viewer_t * viewer) {
+    epoll_ctl(server->eventLoop, EPOLL_CTL_DEL, viewer->socket, NULL);
+    close(viewer->socket);
+    viewer->socket = -1;
+}
+
+/// @brief Sends as much of the pending message of a viewer as the socket takes without waiting
+/// @param server The server the viewer is connected to
+/// @param viewer The viewer whose message is sent
+static void frame_server_flush(frame_server_t * server, frame_server_viewer_t * viewer) {
+    while (viewer->outputOffset < viewer->outputSize) {
+        ssize_t const sent = send(viewer->socket, viewer->output + viewer->outputOffset,
+                                  viewer->outputSize - viewer->outputOffset, MSG_NOSIGNAL);
+        if (sent >= 0) {
+            viewer->outputOffset += (uint16_t)sent;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            // The rest is sent once the viewer has read enough
+            if (!viewer->blocked) {
+                frame_server_watch(server, viewer, true);
+            }
+            return;
+        } else if (errno != EINTR) {
+            frame_server_disconnect(server, viewer);
+            return;
+        }
+    }
+    if (viewer->blocked) {
+        frame_server_watch(server, viewer, false);
+    }
+}
+
+/// @brief Receives the key events of a viewer - a closed connection disconnects the viewer
+/// @param server The server the viewer is connected to
+/// @param viewer The viewer whose key events are received
+static void frame_server_receive(frame_server_t * server, frame_server_viewer_t * viewer) {
+    if (viewer->inputSize == FRAME_SERVER_INPUT_CAPACITY) {
+        // The key events are received once the buffered ones were applied
+        return;
+    }
+    ssize_t const received =
+        recv(viewer->socket, viewer->input + viewer->inputSize, FRAME_SERVER_INPUT_CAPACITY - viewer->inputSize, 0);
+    if (received > 0) {
+        viewer->inputSize += (uint8_t)received;
+    } else if (!received || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+        frame_server_disconnect(server, viewer);
+    }
+}
+
+/// @brief Determines whether the event loop waits until the socket of a viewer is writable
+/// @param server The server the viewer is connected to
+/// @param viewer The viewer
+/// @param writable Whether the event loop reports a writable socket
+static void frame_server_watch(frame_server_t * server, frame_server_viewer_t * viewer, bool writable) {
+    viewer->blocked = writable;
+    struct epoll_event event = {EPOLLIN | (writable ? EPOLLOUT : 0u), {.u32 = (uint32_t)(viewer - server->viewers)}};
+    epoll_ctl(server->eventLoop, EPOLL_CTL_MOD, viewer->socket, &event);
+}
+#endif
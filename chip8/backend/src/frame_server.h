@@ -0,0 +1,146 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file frame_server.h
+ * @brief Declarations regarding the server that streams the frames to local viewers over a unix domain socket
+ * @details Every message of the server starts with a header of 8 bytes: the number of the frame (32-bit little
+ * endian), the resolution mode, the bitmask of the used planes and the size of the payload (16-bit little endian). The
+ * payload is the xor of the frame and the previous frame the viewer received, compressed with a run-length encoding.
+ * A frame is made up of the 64 rows of 16 bytes of every plane, the leftmost pixel is the most significant bit. Each
+ * token of the payload starts with a control byte. If its most significant bit is clear the next (control + 1) bytes
+ * are unchanged, otherwise (control & 0x7F) + 1 bytes of the xor follow. Bytes after the last token are unchanged. A
+ * frame that is the same as the previous one is not sent at all. A viewer sends one byte per key event, the lower four
+ * bits are the index of the key and the most significant bit is set if the key was pressed. All sockets are
+ * non-blocking and handled by one event loop that is polled once per frame, so a slow viewer only misses frames and
+ * never stalls the emulation.
+ */
+
+#ifndef CHIP8_FRAME_SERVER_H_
+#define CHIP8_FRAME_SERVER_H_
+
+#include "backend_pre_compiled_header.h"
+
+// This file is included in the test-suite that is written in c++ using the google-test framework
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../../core/src/graphics_system.h"
+#include "../../core/src/keyboard_state.h"
+
+/// The amount of viewers that can be connected at the same time
+#define FRAME_SERVER_MAX_VIEWERS      (8)
+
+/// The size of a frame - the rows of every plane in high resolution mode
+#define FRAME_SERVER_FRAME_SIZE                                                                                      \
+    (GRAPHICS_SYSTEM_PLANE_COUNT * GRAPHICS_SYSTEM_HIGH_RESOLUTION_HEIGHT * GRAPHICS_SYSTEM_HIGH_RESOLUTION_WIDTH / 8)
+
+/// The size of the header of a message
+#define FRAME_SERVER_HEADER_SIZE      (8)
+
+/// The maximum size of a payload - every changed byte is followed by an unchanged one
+#define FRAME_SERVER_MAX_PAYLOAD_SIZE (FRAME_SERVER_FRAME_SIZE + FRAME_SERVER_FRAME_SIZE / 2)
+
+/// The amount of key events of a viewer that are buffered until they are applied
+#define FRAME_SERVER_INPUT_CAPACITY   (64)
+
+/// @brief A viewer that is connected to the server
+typedef struct {
+    /// The socket of the viewer (-1 if the slot is not used)
+    int socket;
+    /// The frame the viewer has once the pending message was sent - the next frame is encoded against it
+    uint8_t frame[FRAME_SERVER_FRAME_SIZE];
+    /// The resolution mode of the frame the viewer has
+    uint8_t mode;
+    /// The used planes of the frame the viewer has
+    uint8_t usedPlanes;
+    /// The message that is sent to the viewer
+    uint8_t output[FRAME_SERVER_HEADER_SIZE + FRAME_SERVER_MAX_PAYLOAD_SIZE];
+    /// The size of the message that is sent
+    uint16_t outputSize;
+    /// The amount of bytes of the message that were already sent
+    uint16_t outputOffset;
+    /// Whether the socket was full - the event loop reports once it is writable again
+    bool blocked;
+    /// Key events that were received but not applied yet
+    uint8_t input[FRAME_SERVER_INPUT_CAPACITY];
+    /// The amount of key events that were received but not applied yet
+    uint8_t inputSize;
+} frame_server_viewer_t;
+
+/// @brief Models the server that streams the frames to the viewers
+typedef struct {
+    /// The socket the viewers connect to
+    int listener;
+    /// The event loop of the sockets
+    int eventLoop;
+    /// The path of the socket
+    char const * path;
+    /// The amount of frames that were published
+    uint32_t frames;
+    /// The frame that was published last
+    uint8_t frame[FRAME_SERVER_FRAME_SIZE];
+    /// The viewers of the server
+    frame_server_viewer_t viewers[FRAME_SERVER_MAX_VIEWERS];
+} frame_server_t;
+
+/// @brief Creates the socket of the server at a path and starts listening for viewers
+/// @details A stale socket at the path is replaced, any other file is left untouched. Only supported under Linux
+/// @param server The server that is initialized
+/// @param path The path of the socket - has to stay valid until the server is freed
+/// @return 0 if everything went well, -1 if an error occured
+int frame_server_init(frame_server_t * server, char const * path);
+
+/// @brief Disconnects all viewers and removes the socket of the server
+/// @param server The server that is freed
+void frame_server_free(frame_server_t * server);
+
+/// @brief Sends a frame to every viewer that has received its previous frame completely
+/// @param server The server that publishes the frame
+/// @param graphicsSystem The framebuffer that is published
+void frame_server_publish(frame_server_t * server, graphics_system_t const * graphicsSystem);
+
+/// @brief Accepts new viewers, sends pending messages and applies the key events of the viewers
+/// @details Never waits for a socket. If a key is pressed and released during the same poll, the remaining key events
+/// of the viewer are applied by the next poll, so the program sees every tap for at least one frame
+/// @param server The server that is polled
+/// @param keyBoardState The state of the keyboard where the key events are applied
+void frame_server_poll(frame_server_t * server, keyBoardState_t * keyBoardState);
+
+/// @brief Packs the visible pixels of a framebuffer into a frame
+/// @param graphicsSystem The framebuffer that is packed
+/// @param frame The frame (FRAME_SERVER_FRAME_SIZE bytes)
+void frame_server_pack_frame(graphics_system_t const * graphicsSystem, uint8_t * frame);
+
+/// @brief Encodes the xor of two frames with the run-length encoding of the payload
+/// @param previous The frame the viewer has
+/// @param frame The frame that is encoded
+/// @param payload The encoded payload (at least FRAME_SERVER_MAX_PAYLOAD_SIZE bytes)
+/// @return The size of the payload (0 if the frames are equal)
+uint16_t frame_server_encode_delta(uint8_t const * previous, uint8_t const * frame, uint8_t * payload);
+
+/// @brief Applies a payload to the previous frame of a viewer
+/// @param payload The payload that is applied
+/// @param size The size of the payload
+/// @param frame The previous frame that becomes the new frame
+/// @return 0 if everything went well, -1 if the payload exceeds the frame
+int frame_server_decode_delta(uint8_t const * payload, uint16_t size, uint8_t * frame);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,110 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file frame_statistics.c
+ * @brief Definitions regarding the frame pacing statistics of the display
+ */
+
+#include "frame_statistics.h"
+
+static int frame_statistics_compare_frame_times(void const *, void const *);
+static uint32_t frame_statistics_percentile(uint32_t const *, size_t, uint8_t);
+
+void frame_statistics_init(frame_statistics_t * statistics, uint32_t refreshRate, uint64_t counterFrequency) {
+    statistics->recordedFrameTimes = 0u;
+    statistics->presentedFrames = 0u;
+    statistics->maximumFrameTime = 0u;
+    statistics->missedVsyncs = 0u;
+    statistics->repeatedFrames = 0u;
+    statistics->lastPresent = 0u;
+    statistics->counterFrequency = counterFrequency;
+    // A display that does not report its refresh rate must not cause a division by zero
+    statistics->refreshRate = refreshRate ? refreshRate : FRAME_STATISTICS_DEFAULT_REFRESH_RATE;
+    statistics->expectedFrameTime = 1000000u / statistics->refreshRate;
+}
+
+void frame_statistics_record_present(frame_statistics_t * statistics, uint64_t timestamp, bool repeated) {
+    statistics->presentedFrames++;
+    if (repeated) {
+        statistics->repeatedFrames++;
+    }
+    if (statistics->lastPresent) {
+        uint32_t frameTime =
+            (uint32_t)((timestamp - statistics->lastPresent) * 1000000u / statistics->counterFrequency);
+        statistics->frameTimes[statistics->recordedFrameTimes % FRAME_STATISTICS_CAPACITY] = frameTime;
+        statistics->recordedFrameTimes++;
+        if (frameTime > statistics->maximumFrameTime) {
+            statistics->maximumFrameTime = frameTime;
+        }
+        // A frame that took one and a half refresh periods or longer missed at least one vsync
+        if (frameTime * 2u >= statistics->expectedFrameTime * 3u) {
+            statistics->missedVsyncs++;
+        }
+    }
+    statistics->lastPresent = timestamp;
+}
+
+void frame_statistics_report(frame_statistics_t const * statistics, uint64_t publishedFrames, uint64_t skippedFrames,
+                             FILE * stream) {
+    size_t sampleCount = statistics->recordedFrameTimes < FRAME_STATISTICS_CAPACITY
+                             ? (size_t)statistics->recordedFrameTimes
+                             : FRAME_STATISTICS_CAPACITY;
+    fprintf(stream, "Frame pacing (%u Hz)\n", statistics->refreshRate);
+    fprintf(stream, "  Presented frames:\t%llu\n", (unsigned long long)statistics->presentedFrames);
+    fprintf(stream, "  Repeated frames:\t%llu\n", (unsigned long long)statistics->repeatedFrames);
+    // Every emulated frame that was not presented at least once was dropped
+    uint64_t presentedEmulatedFrames = statistics->presentedFrames - statistics->repeatedFrames;
+    fprintf(stream, "  Dropped frames:\t%llu\n",
+            (unsigned long long)(publishedFrames > presentedEmulatedFrames ? publishedFrames - presentedEmulatedFrames
+                                                                           : 0u));
+    fprintf(stream, "  Skipped frames:\t%llu\n", (unsigned long long)skippedFrames);
+    if (!sampleCount) {
+        return;
+    }
+    uint32_t * sortedFrameTimes = (uint32_t *)malloc(sampleCount * sizeof(uint32_t));
+    if (!sortedFrameTimes) {
+        return;
+    }
+    memcpy(sortedFrameTimes, statistics->frameTimes, sampleCount * sizeof(uint32_t));
+    qsort(sortedFrameTimes, sampleCount, sizeof(uint32_t), frame_statistics_compare_frame_times);
+    fprintf(stream, "  Frame time p50:\t%.3f ms\n",
+            frame_statistics_percentile(sortedFrameTimes, sampleCount, 50u) / 1000.0);
+    fprintf(stream, "  Frame time p99:\t%.3f ms\n",
+            frame_statistics_percentile(sortedFrameTimes, sampleCount, 99u) / 1000.0);
+    fprintf(stream, "  Frame time max:\t%.3f ms\n", statistics->maximumFrameTime / 1000.0);
+    fprintf(stream, "  Missed vsyncs:\t%llu\n", (unsigned long long)statistics->missedVsyncs);
+    free(sortedFrameTimes);
+}
+
+/// @brief Compares two frame times (used for sorting)
+/// @param a Pointer to the first frame time
+/// @param b Pointer to the second frame time
+/// @return A negative value if a is smaller than b, a positive value if a is larger than b and 0 if they are equal
+static int frame_statistics_compare_frame_times(void const * a, void const * b) {
+    uint32_t frameTimeA = *(uint32_t const *)a;
+    uint32_t frameTimeB = *(uint32_t const *)b;
+    return (frameTimeA > frameTimeB) - (frameTimeA < frameTimeB);
+}
+
+/// @brief Determines a percentile of sorted frame times (nearest-rank method)
+/// @param sortedFrameTimes The sorted frame times
+/// @param count The amount of frame times
+/// @param percentile The percentile that is determined (0-100)
+/// @return The frame time at the specified percentile
+static uint32_t frame_statistics_percentile(uint32_t const * sortedFrameTimes, size_t count, uint8_t percentile) {
+    size_t rank = (count * percentile + 99u) / 100u;
+    return sortedFrameTimes[rank ? rank - 1u : 0u];
+}
@@ -0,0 +1,85 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file frame_statistics.h
+ * @brief Declarations regarding the frame pacing statistics of the display
+ */
+
+#ifndef CHIP8_FRAME_STATISTICS_H_
+#define CHIP8_FRAME_STATISTICS_H_
+
+#include "backend_pre_compiled_header.h"
+
+// This file is included in the test-suite that is written in c++ using the google-test framework
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The amount of frame times that are kept to compute the percentiles (a bit more than two minutes at 60 Hz)
+#define FRAME_STATISTICS_CAPACITY             (8192u)
+
+/// The refresh rate that is assumed if the refresh rate of the display is unknown
+#define FRAME_STATISTICS_DEFAULT_REFRESH_RATE (60u)
+
+/// @brief Collects the time between two presented frames
+typedef struct {
+    /// Frame times in microseconds (ring buffer of the latest frames)
+    uint32_t frameTimes[FRAME_STATISTICS_CAPACITY];
+    /// The amount of frame times that were recorded in total
+    uint64_t recordedFrameTimes;
+    /// The amount of frames that were presented
+    uint64_t presentedFrames;
+    /// The longest frame time that was recorded in microseconds
+    uint32_t maximumFrameTime;
+    /// The amount of frames that took longer than one and a half refresh periods
+    uint64_t missedVsyncs;
+    /// The amount of presents that showed the same emulated frame again
+    uint64_t repeatedFrames;
+    /// The time where the last frame was presented (performance counter)
+    uint64_t lastPresent;
+    /// Frequency of the performance counter
+    uint64_t counterFrequency;
+    /// The expected time between two presented frames in microseconds
+    uint32_t expectedFrameTime;
+    /// The refresh rate of the display in Hz
+    uint32_t refreshRate;
+} frame_statistics_t;
+
+/// @brief Initializes the frame statistics
+/// @param statistics The statistics that are initialized
+/// @param refreshRate The rate in Hz frames are expected to be presented at (0 if it is unknown)
+/// @param counterFrequency The frequency of the counter that is used for the timestamps
+void frame_statistics_init(frame_statistics_t * statistics, uint32_t refreshRate, uint64_t counterFrequency);
+
+/// @brief Records that a frame was presented
+/// @param statistics The statistics where the frame is recorded
+/// @param timestamp The time when the frame was presented (performance counter)
+/// @param repeated Whether the same emulated frame was presented again
+void frame_statistics_record_present(frame_statistics_t * statistics, uint64_t timestamp, bool repeated);
+
+/// @brief Prints the frame time percentiles and the amount of missed vsyncs
+/// @param statistics The statistics that are reported
+/// @param publishedFrames The amount of frames that were published by the emulation
+/// @param skippedFrames The amount of published frames that were not presented, because rendering was too slow
+/// @param stream The stream where the report is written to
+void frame_statistics_report(frame_statistics_t const * statistics, uint64_t publishedFrames, uint64_t skippedFrames,
+                             FILE * stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
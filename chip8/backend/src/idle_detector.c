@@ -0,0 +1,67 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file idle_detector.c
+ * @brief Definitions regarding the detection of programs that will not do anything anymore
+ */
+
+#include "idle_detector.h"
+
+#include "../../base/src/chip8.h"
+
+static bool idle_detector_frames_equal(graphics_system_t const *, graphics_system_t const *);
+
+void idle_detector_init(idle_detector_t * detector, uint32_t maximumStaticFrames,
+                        graphics_system_t const * graphicsSystem) {
+    detector->maximumStaticFrames = maximumStaticFrames;
+    detector->staticFrames = 0u;
+    detector->lastFrame = *graphicsSystem;
+}
+
+bool idle_detector_halted(virtual_machine_core_t const * vm) {
+    uint16_t const address = vm->programCounter * 2 + PROGRAM_START_LOCATION;
+    uint16_t const opcode =
+        (uint16_t)(virtual_machine_core_read(vm, address) << 8u) | virtual_machine_core_read(vm, address + 1u);
+    return (opcode & 0xF000u) == 0x1000u && (opcode & 0x0FFFu) == address;
+}
+
+bool idle_detector_record_frame(idle_detector_t * detector, graphics_system_t const * graphicsSystem) {
+    if (!idle_detector_frames_equal(&detector->lastFrame, graphicsSystem)) {
+        detector->lastFrame = *graphicsSystem;
+        detector->staticFrames = 0u;
+        return false;
+    }
+    return ++detector->staticFrames >= detector->maximumStaticFrames;
+}
+
+/// @brief Compares the visible pixels of two framebuffers
+/// @details Only the rows of the current resolution of the planes that were used are compared, which is a few hundred
+/// bytes for a classic program - much cheaper than hashing the framebuffer every frame
+/// @param first The first framebuffer
+/// @param second The second framebuffer
+/// @return true if both framebuffers show the same frame, false if not
+static bool idle_detector_frames_equal(graphics_system_t const * first, graphics_system_t const * second) {
+    if (first->mode != second->mode || first->usedPlanes != second->usedPlanes) {
+        return false;
+    }
+    size_t const size = graphics_system_height(first) * sizeof(first->planes[0][0]);
+    for (uint8_t plane = 0; plane < GRAPHICS_SYSTEM_PLANE_COUNT; plane++) {
+        if ((first->usedPlanes & (1u << plane)) && memcmp(first->planes[plane], second->planes[plane], size)) {
+            return false;
+        }
+    }
+    return true;
+}
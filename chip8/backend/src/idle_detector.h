@@ -0,0 +1,70 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file idle_detector.h
+ * @brief Declarations regarding the detection of programs that will not do anything anymore
+ * @details Many programs never exit. They end in a jump to itself, wait for a key or keep showing the same frame. The
+ * detector recognizes these programs at the end of a frame, so a headless execution can be stopped early instead of
+ * running into its budget of instructions or time.
+ */
+
+#ifndef CHIP8_IDLE_DETECTOR_H_
+#define CHIP8_IDLE_DETECTOR_H_
+
+#include "backend_pre_compiled_header.h"
+
+// This file is included in the test-suite that is written in c++ using the google-test framework
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../../core/src/virtual_machine_core.h"
+
+/// @brief Keeps track of how long the framebuffer of a virtual machine has not changed
+typedef struct {
+    /// The amount of frames the framebuffer has to stay unchanged until the program is considered idle
+    uint32_t maximumStaticFrames;
+    /// The amount of frames the framebuffer has not changed
+    uint32_t staticFrames;
+    /// The framebuffer at the end of the last frame it changed in
+    graphics_system_t lastFrame;
+} idle_detector_t;
+
+/// @brief Initializes the detector
+/// @param detector The detector that is initialized
+/// @param maximumStaticFrames The amount of frames the framebuffer has to stay unchanged until the program is
+/// considered idle
+/// @param graphicsSystem The current framebuffer of the virtual machine
+void idle_detector_init(idle_detector_t * detector, uint32_t maximumStaticFrames,
+                        graphics_system_t const * graphicsSystem);
+
+/// @brief Determines whether the program is stuck in a jump to itself
+/// @details Nothing but the timers can change anymore once the next instruction jumps to itself
+/// @param vm The core of the virtual machine
+/// @return true if the next instruction jumps to itself, false if not
+bool idle_detector_halted(virtual_machine_core_t const * vm);
+
+/// @brief Records the framebuffer at the end of a frame
+/// @param detector The detector where the frame is recorded
+/// @param graphicsSystem The framebuffer at the end of the frame
+/// @return true if the framebuffer has not changed for the maximum amount of frames, false if not
+bool idle_detector_record_frame(idle_detector_t * detector, graphics_system_t const * graphicsSystem);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,90 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file input_latency.c
+ * @brief Definitions regarding the measurement of the input latency
+ */
+
+#include "input_latency.h"
+
+static void input_latency_report_maximum(char const *, latency_histogram_t const *, FILE *);
+
+void input_latency_init(input_latency_t * latency, uint64_t counterFrequency) {
+    memset(latency, 0, sizeof(input_latency_t));
+    latency->counterFrequency = counterFrequency;
+}
+
+void input_latency_stamp(input_latency_t * latency, uint8_t keyIndex, uint64_t timestamp) {
+    // A key that is pressed again before it was read is measured from the first event
+    if (!latency->pendingKeyReads[keyIndex]) {
+        latency->pendingKeyReads[keyIndex] = timestamp;
+    }
+    if (!latency->pendingFrameChange) {
+        latency->pendingFrameChange = timestamp;
+    }
+}
+
+void input_latency_record(input_latency_t const * latency, latency_histogram_t * histogram, uint64_t start,
+                          uint64_t end) {
+    uint64_t microseconds = end > start ? (end - start) * 1000000u / latency->counterFrequency : 0u;
+    uint8_t bucket = 0u;
+    while (bucket < INPUT_LATENCY_BUCKET_COUNT - 1 && microseconds >> (bucket + 1)) {
+        bucket++;
+    }
+    histogram->buckets[bucket]++;
+    histogram->count++;
+    if (microseconds > histogram->maximum) {
+        histogram->maximum = microseconds;
+    }
+}
+
+void input_latency_report(input_latency_t const * latency, FILE * stream) {
+    latency_histogram_t const * histograms[] = {&latency->keyRead, &latency->frameChange, &latency->present};
+    // Only the range of buckets that hold any latency is printed
+    int8_t first = INPUT_LATENCY_BUCKET_COUNT;
+    int8_t last = -1;
+    for (uint8_t i = 0u; i < sizeof(histograms) / sizeof(histograms[0]); i++) {
+        for (int8_t bucket = 0; bucket < INPUT_LATENCY_BUCKET_COUNT; bucket++) {
+            if (histograms[i]->buckets[bucket]) {
+                first = bucket < first ? bucket : first;
+                last = bucket > last ? bucket : last;
+            }
+        }
+    }
+    fprintf(stream, "Input latency\n");
+    fprintf(stream, "  Latency\t\tKey read\tFramebuffer\tPresent\n");
+    for (int8_t bucket = first; bucket <= last; bucket++) {
+        fprintf(stream, "  < %9.3f ms\t\t%llu\t\t%llu\t\t%llu\n", (2u << bucket) / 1000.0,
+                (unsigned long long)latency->keyRead.buckets[bucket],
+                (unsigned long long)latency->frameChange.buckets[bucket],
+                (unsigned long long)latency->present.buckets[bucket]);
+    }
+    fprintf(stream, "  Measured events\t%llu\t\t%llu\t\t%llu\n", (unsigned long long)latency->keyRead.count,
+            (unsigned long long)latency->frameChange.count, (unsigned long long)latency->present.count);
+    input_latency_report_maximum("Key read", &latency->keyRead, stream);
+    input_latency_report_maximum("Framebuffer", &latency->frameChange, stream);
+    input_latency_report_maximum("Present", &latency->present, stream);
+}
+
+/// @brief Prints the longest latency of a histogram
+/// @param name The name of the histogram
+/// @param histogram The histogram
+/// @param stream The stream where the latency is written to
+static void input_latency_report_maximum(char const * name, latency_histogram_t const * histogram, FILE * stream) {
+    if (histogram->count) {
+        fprintf(stream, "  %s max:\t%.3f ms\n", name, histogram->maximum / 1000.0);
+    }
+}
@@ -0,0 +1,93 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file input_latency.h
+ * @brief Declarations regarding the measurement of the input latency
+ * @details Every key event is stamped when it is received. The time until the program reads the key, until the
+ * framebuffer changes and until the changed frame is presented is collected in histograms with power of two buckets.
+ */
+
+#ifndef CHIP8_INPUT_LATENCY_H_
+#define CHIP8_INPUT_LATENCY_H_
+
+#include "backend_pre_compiled_header.h"
+
+// This file is included in the test-suite that is written in c++ using the google-test framework
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The amount of buckets of a latency histogram - bucket n holds latencies below 2^(n+1) microseconds (up to ~16 s)
+#define INPUT_LATENCY_BUCKET_COUNT (24)
+
+/// The amount of keys of the CHIP-8 keyboard
+#define INPUT_LATENCY_KEY_COUNT    (16)
+
+/// @brief A histogram of latencies
+typedef struct {
+    /// The amount of latencies per bucket
+    uint64_t buckets[INPUT_LATENCY_BUCKET_COUNT];
+    /// The amount of latencies that were recorded
+    uint64_t count;
+    /// The longest latency that was recorded in microseconds
+    uint64_t maximum;
+} latency_histogram_t;
+
+/// @brief Collects the latencies of the key events
+typedef struct {
+    /// Time until the program reads the key (written by the emulation thread)
+    latency_histogram_t keyRead;
+    /// Time until the framebuffer changes (written by the emulation thread)
+    latency_histogram_t frameChange;
+    /// Time until the changed frame was presented (written by the thread that presents the frames)
+    latency_histogram_t present;
+    /// Time the oldest key event that was not read yet was received, per key (0 if there is none)
+    uint64_t pendingKeyReads[INPUT_LATENCY_KEY_COUNT];
+    /// Time the oldest key event that did not change the framebuffer yet was received (0 if there is none)
+    uint64_t pendingFrameChange;
+    /// Frequency of the performance counter
+    uint64_t counterFrequency;
+} input_latency_t;
+
+/// @brief Initializes the input latency measurement
+/// @param latency The input latency measurement that is initialized
+/// @param counterFrequency The frequency of the counter that is used for the timestamps
+void input_latency_init(input_latency_t * latency, uint64_t counterFrequency);
+
+/// @brief Stamps a key event that was applied to the keyboard state
+/// @param latency The input latency measurement
+/// @param keyIndex The index of the key (0 - 15)
+/// @param timestamp The time when the key event was received (performance counter)
+void input_latency_stamp(input_latency_t * latency, uint8_t keyIndex, uint64_t timestamp);
+
+/// @brief Records a latency
+/// @param latency The input latency measurement
+/// @param histogram The histogram where the latency is recorded
+/// @param start The time when the key event was received (performance counter)
+/// @param end The time when the reaction happened (performance counter)
+void input_latency_record(input_latency_t const * latency, latency_histogram_t * histogram, uint64_t start,
+                          uint64_t end);
+
+/// @brief Prints the latency histograms
+/// @param latency The input latency measurement that is reported
+/// @param stream The stream where the report is written to
+void input_latency_report(input_latency_t const * latency, FILE * stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
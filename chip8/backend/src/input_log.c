@@ -0,0 +1,158 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file input_log.c
+ * @brief Definitions regarding the recording and replay of keyboard input
+ */
+
+#include "input_log.h"
+
+/// The magic number an input log starts with
+#define INPUT_LOG_MAGIC   ("C8I")
+
+/// The version of the format of the input log
+#define INPUT_LOG_VERSION (1)
+
+static bool input_log_read_record(input_log_t *);
+static bool input_log_read_varint(FILE *, uint64_t *);
+static void input_log_write_varint(FILE *, uint64_t);
+
+int input_log_open_recording(input_log_t * inputLog, char const * path, uint32_t seed) {
+    inputLog->file = fopen(path, "wb");
+    if (!inputLog->file) {
+        printf("Could not open file \"%s\"\n", path);
+        return -1;
+    }
+    inputLog->replaying = false;
+    inputLog->cycle = 0u;
+    inputLog->keyBoardState = 0u;
+    fputs(INPUT_LOG_MAGIC, inputLog->file);
+    fputc(INPUT_LOG_VERSION, inputLog->file);
+    input_log_write_varint(inputLog->file, seed);
+    return 0;
+}
+
+int input_log_open_replay(input_log_t * inputLog, char const * path, uint32_t * seed) {
+    inputLog->file = fopen(path, "rb");
+    if (!inputLog->file) {
+        printf("Could not open file \"%s\"\n", path);
+        return -1;
+    }
+    inputLog->replaying = true;
+    inputLog->cycle = 0u;
+    inputLog->keyBoardState = 0u;
+    char magic[sizeof(INPUT_LOG_MAGIC)] = {0};
+    uint64_t value;
+    if (fread(magic, sizeof(char), sizeof(magic) - 1, inputLog->file) < sizeof(magic) - 1 ||
+        strcmp(magic, INPUT_LOG_MAGIC) || fgetc(inputLog->file) != INPUT_LOG_VERSION ||
+        !input_log_read_varint(inputLog->file, &value) || value > UINT32_MAX) {
+        printf("\"%s\" is not a valid input log\n", path);
+        fclose(inputLog->file);
+        inputLog->file = NULL;
+        return -1;
+    }
+    *seed = (uint32_t)value;
+    if (!input_log_read_record(inputLog)) {
+        // A log without records (e.g. from an aborted recording) ends immediately
+        inputLog->nextCycle = 0u;
+        inputLog->nextChange = 0u;
+    }
+    return 0;
+}
+
+void input_log_record(input_log_t * inputLog, uint64_t cycle, keyBoardState_t keyBoardState) {
+    if (keyBoardState == inputLog->keyBoardState) {
+        return;
+    }
+    input_log_write_varint(inputLog->file, cycle - inputLog->cycle);
+    input_log_write_varint(inputLog->file, keyBoardState ^ inputLog->keyBoardState);
+    inputLog->cycle = cycle;
+    inputLog->keyBoardState = keyBoardState;
+}
+
+bool input_log_replay(input_log_t * inputLog, uint64_t cycle, keyBoardState_t * keyBoardState) {
+    while (cycle >= inputLog->nextCycle) {
+        if (!inputLog->nextChange) {
+            return true;
+        }
+        inputLog->keyBoardState ^= inputLog->nextChange;
+        inputLog->cycle = inputLog->nextCycle;
+        if (!input_log_read_record(inputLog)) {
+            // A truncated log ends after the last complete record
+            inputLog->nextChange = 0u;
+        }
+    }
+    *keyBoardState = inputLog->keyBoardState;
+    return false;
+}
+
+void input_log_close(input_log_t * inputLog, uint64_t cycle) {
+    if (!inputLog->file) {
+        return;
+    }
+    if (!inputLog->replaying) {
+        // The end of the session is marked by a record without a change
+        input_log_write_varint(inputLog->file, cycle - inputLog->cycle);
+        input_log_write_varint(inputLog->file, 0u);
+    }
+    fclose(inputLog->file);
+    inputLog->file = NULL;
+}
+
+/// @brief Reads the next record of an input log that is replayed
+/// @param inputLog The input log
+/// @return true if a complete record was read, false if not
+static bool input_log_read_record(input_log_t * inputLog) {
+    uint64_t delta;
+    uint64_t change;
+    if (!input_log_read_varint(inputLog->file, &delta) || !input_log_read_varint(inputLog->file, &change) ||
+        change > UINT16_MAX) {
+        return false;
+    }
+    inputLog->nextCycle = inputLog->cycle + delta;
+    inputLog->nextChange = (keyBoardState_t)change;
+    return true;
+}
+
+/// @brief Reads an unsigned LEB128 encoded integer
+/// @param file The file the integer is read from
+/// @param value The value that was read
+/// @return true if the integer was read, false if the file ended or the integer is too large
+static bool input_log_read_varint(FILE * file, uint64_t * value) {
+    *value = 0u;
+    for (uint8_t shift = 0u; shift < 64u; shift += 7u) {
+        int byte = fgetc(file);
+        if (byte == EOF) {
+            return false;
+        }
+        *value |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// @brief Writes an unsigned integer LEB128 encoded - seven bits per byte, the highest bit marks a following byte
+/// @param file The file the integer is written to
+/// @param value The value that is written
+static void input_log_write_varint(FILE * file, uint64_t value) {
+    while (value >= 0x80u) {
+        fputc((int)(value & 0x7f) | 0x80, file);
+        value >>= 7;
+    }
+    fputc((int)value, file);
+}
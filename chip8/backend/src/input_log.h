@@ -0,0 +1,89 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file input_log.h
+ * @brief Declarations regarding the recording and replay of keyboard input
+ * @details An input log starts with the magic "C8I", a version byte and the seed of the random number generator as a
+ * varint. It is followed by one record per change of the keyboard state: the amount of instructions since the
+ * previous record and the xor of the previous and the new keyboard state, both as varints. A record with an empty
+ * xor marks the end of the recorded session.
+ */
+
+#ifndef CHIP8_INPUT_LOG_H_
+#define CHIP8_INPUT_LOG_H_
+
+#include "backend_pre_compiled_header.h"
+
+// This file is included in the test-suite that is written in c++ using the google-test framework
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../../core/src/keyboard_state.h"
+
+/// @brief Models a file where keyboard input is recorded to or replayed from
+typedef struct {
+    /// The file of the input log
+    FILE * file;
+    /// Whether the input is replayed from the file or recorded to it
+    bool replaying;
+    /// The amount of instructions that were executed when the previous record was applied or written
+    uint64_t cycle;
+    /// The keyboard state after the previous record
+    keyBoardState_t keyBoardState;
+    /// The amount of instructions after which the next record is applied (replay only)
+    uint64_t nextCycle;
+    /// The xor of the next record (replay only) - 0 if the next record ends the session
+    keyBoardState_t nextChange;
+} input_log_t;
+
+/// @brief Creates an input log where the keyboard input is recorded to
+/// @param inputLog The input log that is created
+/// @param path The path of the file that is written
+/// @param seed The seed of the random number generator that is used for the recorded session
+/// @return 0 if everything went well, -1 if an error occured
+int input_log_open_recording(input_log_t * inputLog, char const * path, uint32_t seed);
+
+/// @brief Opens an input log where the keyboard input is replayed from
+/// @param inputLog The input log that is opened
+/// @param path The path of the file that is read
+/// @param seed Is set to the seed of the random number generator that was used for the recorded session
+/// @return 0 if everything went well, -1 if an error occured
+int input_log_open_replay(input_log_t * inputLog, char const * path, uint32_t * seed);
+
+/// @brief Records the keyboard state if it changed since the previous record
+/// @param inputLog The input log where the keyboard state is recorded
+/// @param cycle The amount of instructions that were executed when the keyboard state applied
+/// @param keyBoardState The current keyboard state
+void input_log_record(input_log_t * inputLog, uint64_t cycle, keyBoardState_t keyBoardState);
+
+/// @brief Applies every record that is due
+/// @param inputLog The input log that is replayed
+/// @param cycle The amount of instructions that were executed
+/// @param keyBoardState The keyboard state the records are applied to
+/// @return true if the recorded session has ended, false if not
+bool input_log_replay(input_log_t * inputLog, uint64_t cycle, keyBoardState_t * keyBoardState);
+
+/// @brief Closes an input log - a recording is ended at the specified cycle
+/// @param inputLog The input log that is closed
+/// @param cycle The amount of instructions that were executed when the session ended
+void input_log_close(input_log_t * inputLog, uint64_t cycle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
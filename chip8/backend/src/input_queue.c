@@ -0,0 +1,52 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file input_queue.c
+ * @brief Definitions regarding the lock-free queue used to hand key events to the emulation thread
+ */
+
+#include "input_queue.h"
+
+void input_queue_init(input_queue_t * queue) {
+    SDL_AtomicSet(&queue->head, 0);
+    SDL_AtomicSet(&queue->tail, 0);
+}
+
+bool input_queue_push(input_queue_t * queue, input_event_t const * event) {
+    int head = SDL_AtomicGet(&queue->head);
+    if (head - SDL_AtomicGet(&queue->tail) == INPUT_QUEUE_CAPACITY) {
+        return false;
+    }
+    queue->events[head & (INPUT_QUEUE_CAPACITY - 1)] = *event;
+    // Makes sure the event is visible before it is handed over
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&queue->head, head + 1);
+    return true;
+}
+
+bool input_queue_pop(input_queue_t * queue, input_event_t * event) {
+    int tail = SDL_AtomicGet(&queue->tail);
+    if (tail == SDL_AtomicGet(&queue->head)) {
+        return false;
+    }
+    // Makes sure the event is read after it was handed over
+    SDL_MemoryBarrierAcquire();
+    *event = queue->events[tail & (INPUT_QUEUE_CAPACITY - 1)];
+    // Makes sure the event was read before the slot is handed back to the producer
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&queue->tail, tail + 1);
+    return true;
+}
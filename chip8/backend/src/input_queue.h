@@ -0,0 +1,84 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file input_queue.h
+ * @brief Declarations regarding the lock-free queue used to hand key events to the emulation thread
+ * @details The queue is a ring buffer with a single producer (the thread that polls the SDL events) and a single
+ * consumer (the emulation thread). Each side only writes its own index, so neither side ever waits for the other.
+ */
+
+#ifndef CHIP8_INPUT_QUEUE_H_
+#define CHIP8_INPUT_QUEUE_H_
+
+#include "../../../external/SDL/include/SDL.h"
+#include "backend_pre_compiled_header.h"
+
+// This file is included in the test-suite that is written in c++ using the google-test framework
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../../core/src/keyboard_state.h"
+
+/// The amount of events the queue can hold (has to be a power of two)
+#define INPUT_QUEUE_CAPACITY         (256)
+
+/// Size of a cache line - used to keep the producer and consumer owned indices apart
+#define INPUT_QUEUE_CACHE_LINE_SIZE  (64)
+
+/// @brief A key event of the host
+typedef struct {
+    /// Value of the performance counter when the event was received
+    uint64_t timestamp;
+    /// The key code of the CHIP-8 key
+    keyBoardState_t keyCode;
+    /// Whether the key was pressed or released
+    bool pressed;
+} input_event_t;
+
+/// @brief Models a lock-free single-producer / single-consumer queue of key events
+typedef struct {
+    /// The events of the queue
+    input_event_t events[INPUT_QUEUE_CAPACITY];
+    /// The amount of events that were pushed (written by the producer)
+    SDL_atomic_t head;
+    /// Padding to avoid false sharing between the producer and the consumer
+    uint8_t headPadding[INPUT_QUEUE_CACHE_LINE_SIZE - sizeof(SDL_atomic_t)];
+    /// The amount of events that were popped (written by the consumer)
+    SDL_atomic_t tail;
+} input_queue_t;
+
+/// @brief Initializes the queue
+/// @param queue The queue that is initialized
+void input_queue_init(input_queue_t * queue);
+
+/// @brief Pushes an event into the queue (producer only)
+/// @param queue The queue where the event is pushed
+/// @param event The event that is pushed
+/// @return true if the event was pushed, false if the queue is full
+bool input_queue_push(input_queue_t * queue, input_event_t const * event);
+
+/// @brief Pops the oldest event from the queue (consumer only)
+/// @param queue The queue where the event is popped from
+/// @param event Is set to the event that was popped
+/// @return true if an event was popped, false if the queue is empty
+bool input_queue_pop(input_queue_t * queue, input_event_t * event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
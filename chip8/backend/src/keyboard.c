@@ -0,0 +1,60 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file keyboard.c
+ * @brief Definitions regarding the keyboard of the host
+ */
+
+#include "keyboard.h"
+
+keyBoardState_t keyboard_key_code(SDL_Scancode scancode) {
+    switch (scancode) {
+    case SDL_SCANCODE_0:
+        return CHIP8_KEY_CODE_0;
+    case SDL_SCANCODE_1:
+        return CHIP8_KEY_CODE_1;
+    case SDL_SCANCODE_2:
+        return CHIP8_KEY_CODE_2;
+    case SDL_SCANCODE_3:
+        return CHIP8_KEY_CODE_3;
+    case SDL_SCANCODE_4:
+        return CHIP8_KEY_CODE_4;
+    case SDL_SCANCODE_5:
+        return CHIP8_KEY_CODE_5;
+    case SDL_SCANCODE_6:
+        return CHIP8_KEY_CODE_6;
+    case SDL_SCANCODE_7:
+        return CHIP8_KEY_CODE_7;
+    case SDL_SCANCODE_8:
+        return CHIP8_KEY_CODE_8;
+    case SDL_SCANCODE_9:
+        return CHIP8_KEY_CODE_9;
+    case SDL_SCANCODE_A:
+        return CHIP8_KEY_CODE_A;
+    case SDL_SCANCODE_B:
+        return CHIP8_KEY_CODE_B;
+    case SDL_SCANCODE_C:
+        return CHIP8_KEY_CODE_C;
+    case SDL_SCANCODE_D:
+        return CHIP8_KEY_CODE_D;
+    case SDL_SCANCODE_E:
+        return CHIP8_KEY_CODE_E;
+    case SDL_SCANCODE_F:
+        return CHIP8_KEY_CODE_F;
+    default:
+        return 0u;
+    }
+}
@@ -0,0 +1,34 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file keyboard.h
+ * @brief Declarations regarding the keyboard of the host
+ */
+
+#ifndef CHIP8_KEYBOARD_H_
+#define CHIP8_KEYBOARD_H_
+
+#include "../../../external/SDL/include/SDL.h"
+#include "backend_pre_compiled_header.h"
+
+#include "../../core/src/keyboard_state.h"
+
+/// @brief Maps a key of the host keyboard to a key of the CHIP-8 keyboard
+/// @param scancode The scancode of the key of the host keyboard
+/// @return The key code of the CHIP-8 key, 0 if the key is not part of the CHIP-8 keyboard
+keyBoardState_t keyboard_key_code(SDL_Scancode scancode);
+
+#endif
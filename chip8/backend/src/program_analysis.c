@@ -0,0 +1,509 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file program_analysis.c
+ * @brief Definitions regarding the static analysis of a loaded CHIP-8 program
+ */
+
+#include "program_analysis.h"
+
+/// The address of I is not known statically
+#define PROGRAM_ANALYSIS_UNKNOWN_ADDRESS (-1)
+
+/// @brief The states of a basic block during the search for loops
+typedef enum {
+    PROGRAM_ANALYSIS_BLOCK_UNVISITED,
+    /// The block is on the path of the search - an edge to it closes a loop
+    PROGRAM_ANALYSIS_BLOCK_ACTIVE,
+    PROGRAM_ANALYSIS_BLOCK_VISITED
+} program_analysis_block_state;
+
+static void program_analysis_build_blocks(program_analysis_t *);
+static uint8_t program_analysis_extensions(uint16_t);
+static void program_analysis_find_reachable_instructions(program_analysis_t *);
+static void program_analysis_record_write(program_analysis_t *, int32_t, uint16_t);
+static bool program_analysis_reads_register(uint16_t, uint8_t);
+static void program_analysis_scan_block(program_analysis_t *, program_analysis_block_t const *);
+static uint8_t program_analysis_successors(uint16_t, uint16_t, uint16_t *);
+static bool program_analysis_transfers_control(uint16_t);
+static bool program_analysis_uses_I(uint16_t);
+static void program_analysis_visit_block(program_analysis_t *, uint16_t, uint8_t *);
+static bool program_analysis_writes_register(uint16_t, uint8_t);
+
+/// The names of the quirk profiles, indexed by virtual_machine_quirks
+static char const * const program_analysis_quirk_names[VIRTUAL_MACHINE_QUIRKS_COUNT] = {"vip", "schip", "xochip"};
+
+void program_analysis_analyze(program_analysis_t * analysis, uint8_t const * program, uint16_t programSize) {
+    if (programSize > PROGRAM_ANALYSIS_MAX_INSTRUCTIONS * 2) {
+        programSize = PROGRAM_ANALYSIS_MAX_INSTRUCTIONS * 2;
+    }
+    analysis->program = program;
+    analysis->programSize = programSize;
+    analysis->instructionCount = (programSize + 1u) / 2;
+    analysis->blockCount = 0u;
+    analysis->loopCount = 0u;
+    analysis->indirectJumps = 0u;
+    analysis->selfModifyingWrites = 0u;
+    analysis->unknownWrites = 0u;
+    analysis->dataBytes = 0u;
+    analysis->quirkDependencies = 0u;
+    analysis->extensions = 0u;
+    program_analysis_find_reachable_instructions(analysis);
+    program_analysis_build_blocks(analysis);
+    if (analysis->blockCount) {
+        uint8_t states[PROGRAM_ANALYSIS_MAX_INSTRUCTIONS];
+        memset(states, PROGRAM_ANALYSIS_BLOCK_UNVISITED, analysis->blockCount);
+        program_analysis_visit_block(analysis, 0u, states);
+    }
+    for (uint16_t i = 0u; i < analysis->blockCount; i++) {
+        program_analysis_scan_block(analysis, &analysis->blocks[i]);
+    }
+    for (uint16_t i = 0u; i < programSize; i++) {
+        analysis->dataBytes += !analysis->reachable[i / 2];
+    }
+}
+
+uint16_t program_analysis_opcode(program_analysis_t const * analysis, uint16_t index) {
+    uint16_t const address = index * 2u;
+    uint8_t const low = address + 1u < analysis->programSize ? analysis->program[address + 1u] : 0u;
+    return analysis->program[address] << 8 | low;
+}
+
+void program_analysis_report(program_analysis_t const * analysis, FILE * stream) {
+    uint16_t reachableInstructions = 0u;
+    for (uint16_t i = 0u; i < analysis->instructionCount; i++) {
+        reachableInstructions += analysis->reachable[i];
+    }
+    fprintf(stream, "Program analysis\n");
+    fprintf(stream, "  Reachable instructions:\t%u\n", reachableInstructions);
+    fprintf(stream, "  Basic blocks:\t\t\t%u\n", analysis->blockCount);
+    fprintf(stream, "  Loops:\t\t\t%u\n", analysis->loopCount);
+    fprintf(stream, "  Indirect jumps:\t\t%u\n", analysis->indirectJumps);
+    fprintf(stream, "  Writes into the code:\t\t%u\n", analysis->selfModifyingWrites);
+    fprintf(stream, "  Writes to unknown addresses:\t%u\n", analysis->unknownWrites);
+    fprintf(stream, "  Data bytes:\t\t\t%u\n", analysis->dataBytes);
+    // The data regions are the ranges of bytes that are not part of a reachable instruction
+    for (uint16_t i = 0u; i < analysis->programSize; i++) {
+        if (!analysis->reachable[i / 2] && (!i || analysis->reachable[(i - 1u) / 2])) {
+            uint16_t end = i;
+            while (end + 1u < analysis->programSize && !analysis->reachable[(end + 1u) / 2]) {
+                end++;
+            }
+            fprintf(stream, "  Data region:\t\t\t0x%03X - 0x%03X\n", PROGRAM_START_LOCATION + i,
+                    PROGRAM_START_LOCATION + end);
+        }
+    }
+    fprintf(stream, "  Quirk dependencies:\t\t%s%s%s%s%s\n", analysis->quirkDependencies ? "" : "none",
+            analysis->quirkDependencies & PROGRAM_ANALYSIS_QUIRK_SHIFT ? "shift " : "",
+            analysis->quirkDependencies & PROGRAM_ANALYSIS_QUIRK_LOAD_STORE ? "load-store " : "",
+            analysis->quirkDependencies & PROGRAM_ANALYSIS_QUIRK_JUMP ? "jump " : "",
+            analysis->quirkDependencies & PROGRAM_ANALYSIS_QUIRK_LOGIC ? "logic " : "");
+    fprintf(stream, "  Extensions:\t\t\t%s%s%s\n", analysis->extensions ? "" : "none",
+            analysis->extensions & PROGRAM_ANALYSIS_EXTENSION_SCHIP ? "SUPER-CHIP " : "",
+            analysis->extensions & PROGRAM_ANALYSIS_EXTENSION_XO_CHIP ? "XO-CHIP " : "");
+    fprintf(stream, "  Suggested quirk profile:\t%s\n",
+            program_analysis_quirk_names[program_analysis_suggest_quirks(analysis)]);
+}
+
+virtual_machine_quirks program_analysis_suggest_quirks(program_analysis_t const * analysis) {
+    if (analysis->extensions & PROGRAM_ANALYSIS_EXTENSION_XO_CHIP) {
+        return VIRTUAL_MACHINE_QUIRKS_XO_CHIP;
+    }
+    // BXNN only exists on the SUPER-CHIP
+    if (analysis->extensions & PROGRAM_ANALYSIS_EXTENSION_SCHIP ||
+        analysis->quirkDependencies & PROGRAM_ANALYSIS_QUIRK_JUMP) {
+        return VIRTUAL_MACHINE_QUIRKS_SCHIP;
+    }
+    // A program that shifts VY or keeps using I after a load or store relies on the original interpreter
+    if (analysis->quirkDependencies & (PROGRAM_ANALYSIS_QUIRK_SHIFT | PROGRAM_ANALYSIS_QUIRK_LOAD_STORE)) {
+        return VIRTUAL_MACHINE_QUIRKS_VIP;
+    }
+    return VIRTUAL_MACHINE_QUIRKS_SCHIP;
+}
+
+/// @brief Splits the reachable instructions into basic blocks
+/// @details A block starts at the start of the program and at every instruction that can be executed after a jump, a
+/// call, a return or a skip. Calls are treated like branches to the subroutine and the return address
+/// @param analysis The analysis
+static void program_analysis_build_blocks(program_analysis_t * analysis) {
+    bool leaders[PROGRAM_ANALYSIS_MAX_INSTRUCTIONS] = {false};
+    uint16_t successors[2];
+    for (uint16_t i = 0u; i < analysis->instructionCount; i++) {
+        uint16_t const opcode = program_analysis_opcode(analysis, i);
+        if (analysis->reachable[i] && program_analysis_transfers_control(opcode)) {
+            uint8_t const successorCount = program_analysis_successors(opcode, i, successors);
+            for (uint8_t j = 0u; j < successorCount; j++) {
+                if (successors[j] < analysis->instructionCount) {
+                    leaders[successors[j]] = true;
+                }
+            }
+        }
+    }
+    program_analysis_block_t * block = NULL;
+    for (uint16_t i = 0u; i < analysis->instructionCount; i++) {
+        if (!analysis->reachable[i]) {
+            block = NULL;
+            continue;
+        }
+        if (!block || leaders[i]) {
+            block = &analysis->blocks[analysis->blockCount++];
+            block->start = i;
+            block->length = 0u;
+            block->loopHeader = false;
+        }
+        block->length++;
+        analysis->instructionBlocks[i] = analysis->blockCount - 1u;
+        if (program_analysis_transfers_control(program_analysis_opcode(analysis, i))) {
+            block = NULL;
+        }
+    }
+    for (uint16_t i = 0u; i < analysis->blockCount; i++) {
+        block = &analysis->blocks[i];
+        uint16_t const last = block->start + block->length - 1u;
+        uint8_t const successorCount = program_analysis_successors(program_analysis_opcode(analysis, last), last,
+                                                                    successors);
+        for (uint8_t j = 0u; j < 2u; j++) {
+            block->successors[j] = j < successorCount && successors[j] < analysis->instructionCount
+                                       ? analysis->instructionBlocks[successors[j]]
+                                       : PROGRAM_ANALYSIS_NO_BLOCK;
+        }
+    }
+}
+
+/// @brief Determines the instruction set extensions an instruction belongs to
+/// @details F000 is no evidence for the XO-CHIP, because it prints V0 in the CHIP-8 mode of this emulator
+/// @param opcode The opcode of the instruction
+/// @return The extensions (see program_analysis_extension)
+static uint8_t program_analysis_extensions(uint16_t opcode) {
+    switch (opcode & 0xf000) {
+    case 0x0000:
+        if ((opcode & 0xfff0) == 0x00C0 || (opcode >= 0x00FB && opcode <= 0x00FF)) {
+            return PROGRAM_ANALYSIS_EXTENSION_SCHIP;
+        }
+        return (opcode & 0xfff0) == 0x00D0 ? PROGRAM_ANALYSIS_EXTENSION_XO_CHIP : 0u;
+    case 0x5000:
+        return (opcode & 0x000f) == 0x2 || (opcode & 0x000f) == 0x3 ? PROGRAM_ANALYSIS_EXTENSION_XO_CHIP : 0u;
+    case 0xd000:
+        return (opcode & 0x000f) ? 0u : PROGRAM_ANALYSIS_EXTENSION_SCHIP;
+    case 0xf000:
+        switch (opcode & 0x00ff) {
+        case 0x30:
+        case 0x75:
+        case 0x85:
+            return PROGRAM_ANALYSIS_EXTENSION_SCHIP;
+        case 0x01:
+        case 0x02:
+        case 0x3a:
+            return PROGRAM_ANALYSIS_EXTENSION_XO_CHIP;
+        default:
+            return 0u;
+        }
+    default:
+        return 0u;
+    }
+}
+
+/// @brief Finds the instructions that can be reached from the start of the program
+/// @param analysis The analysis
+static void program_analysis_find_reachable_instructions(program_analysis_t * analysis) {
+    uint16_t worklist[PROGRAM_ANALYSIS_MAX_INSTRUCTIONS];
+    uint16_t pending = 0u;
+    memset(analysis->reachable, 0, sizeof(analysis->reachable));
+    if (analysis->instructionCount) {
+        analysis->reachable[0] = true;
+        worklist[pending++] = 0u;
+    }
+    while (pending) {
+        uint16_t const index = worklist[--pending];
+        uint16_t successors[2];
+        uint8_t const successorCount = program_analysis_successors(program_analysis_opcode(analysis, index), index,
+                                                                    successors);
+        for (uint8_t i = 0u; i < successorCount; i++) {
+            if (successors[i] < analysis->instructionCount && !analysis->reachable[successors[i]]) {
+                // Every instruction is added to the worklist once
+                analysis->reachable[successors[i]] = true;
+                worklist[pending++] = successors[i];
+            }
+        }
+    }
+}
+
+/// @brief Records a write into memory
+/// @param analysis The analysis
+/// @param address The address of the first byte that is written (PROGRAM_ANALYSIS_UNKNOWN_ADDRESS if it is unknown)
+/// @param size The amount of bytes that are written
+static void program_analysis_record_write(program_analysis_t * analysis, int32_t address, uint16_t size) {
+    if (address == PROGRAM_ANALYSIS_UNKNOWN_ADDRESS) {
+        analysis->unknownWrites++;
+        return;
+    }
+    for (uint16_t i = 0u; i < size; i++) {
+        uint16_t const location = (address + i) & (VIRTUAL_MACHINE_MEMORY_SIZE - 1u);
+        if (location >= PROGRAM_START_LOCATION && location - PROGRAM_START_LOCATION < analysis->programSize &&
+            analysis->reachable[(location - PROGRAM_START_LOCATION) / 2]) {
+            analysis->selfModifyingWrites++;
+            return;
+        }
+    }
+}
+
+/// @brief Determines whether an instruction reads a register
+/// @param opcode The opcode of the instruction
+/// @param reg The index of the register
+/// @return true if the register is read
+static bool program_analysis_reads_register(uint16_t opcode, uint8_t reg) {
+    uint8_t const x = (opcode & 0x0f00u) >> 8;
+    uint8_t const y = (opcode & 0x00f0u) >> 4;
+    switch (opcode & 0xf000) {
+    case 0x3000:
+    case 0x4000:
+    case 0x7000:
+    case 0xe000:
+        return x == reg;
+    case 0x5000:
+    case 0x9000:
+    case 0xd000:
+        return x == reg || y == reg;
+    case 0x8000:
+        return y == reg || ((opcode & 0x000f) && x == reg);
+    case 0xb000:
+        return !reg || x == reg;
+    case 0xf000:
+        switch (opcode & 0x00ff) {
+        case 0x55:
+        case 0x75:
+            return reg <= x;
+        case 0x07:
+        case 0x0a:
+        case 0x65:
+        case 0x85:
+            return false;
+        default:
+            return x == reg;
+        }
+    default:
+        return false;
+    }
+}
+
+/// @brief Scans the instructions of a basic block for writes into memory, quirk dependencies and extensions
+/// @details I is tracked from the ANNN instructions of the block. It is unknown at the start of the block
+/// @param analysis The analysis
+/// @param block The basic block
+static void program_analysis_scan_block(program_analysis_t * analysis, program_analysis_block_t const * block) {
+    int32_t address = PROGRAM_ANALYSIS_UNKNOWN_ADDRESS;
+    // I was used by FX55 or FX65 and not set since - its value depends on the quirk profile
+    bool loadStoreChangedI = false;
+    // VF was set by 8XY1, 8XY2 or 8XY3 and not set since - its value depends on the quirk profile
+    bool logicChangedVF = false;
+    for (uint16_t i = block->start; i < block->start + block->length; i++) {
+        uint16_t const opcode = program_analysis_opcode(analysis, i);
+        uint8_t const x = (opcode & 0x0f00u) >> 8;
+        uint8_t const y = (opcode & 0x00f0u) >> 4;
+        analysis->extensions |= program_analysis_extensions(opcode);
+        if (loadStoreChangedI && program_analysis_uses_I(opcode)) {
+            analysis->quirkDependencies |= PROGRAM_ANALYSIS_QUIRK_LOAD_STORE;
+        }
+        if (logicChangedVF && program_analysis_reads_register(opcode, 0xf)) {
+            analysis->quirkDependencies |= PROGRAM_ANALYSIS_QUIRK_LOGIC;
+        }
+        if (program_analysis_writes_register(opcode, 0xf)) {
+            logicChangedVF = false;
+        }
+        switch (opcode & 0xf000) {
+        case 0x5000:
+            if ((opcode & 0x000f) == 0x2) {
+                program_analysis_record_write(analysis, address, (x <= y ? y - x : x - y) + 1u);
+            }
+            break;
+        case 0x8000:
+            if (((opcode & 0x000f) == 0x6 || (opcode & 0x000f) == 0xe) && x != y) {
+                analysis->quirkDependencies |= PROGRAM_ANALYSIS_QUIRK_SHIFT;
+            } else if ((opcode & 0x000f) >= 0x1 && (opcode & 0x000f) <= 0x3) {
+                logicChangedVF = true;
+            }
+            break;
+        case 0xa000:
+            address = opcode & 0x0fff;
+            loadStoreChangedI = false;
+            break;
+        case 0xb000:
+            analysis->indirectJumps++;
+            if (x) {
+                analysis->quirkDependencies |= PROGRAM_ANALYSIS_QUIRK_JUMP;
+            }
+            break;
+        case 0xf000:
+            switch (opcode & 0x00ff) {
+            case 0x00:
+            case 0x1e:
+            case 0x29:
+            case 0x30:
+                address = PROGRAM_ANALYSIS_UNKNOWN_ADDRESS;
+                loadStoreChangedI = false;
+                break;
+            case 0x33:
+                program_analysis_record_write(analysis, address, 3u);
+                break;
+            case 0x55:
+            case 0x65:
+                if ((opcode & 0x00ff) == 0x55) {
+                    program_analysis_record_write(analysis, address, x + 1u);
+                }
+                address = PROGRAM_ANALYSIS_UNKNOWN_ADDRESS;
+                loadStoreChangedI = true;
+                break;
+            default:
+                break;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+/// @brief Determines the instructions that can be executed after an instruction
+/// @param opcode The opcode of the instruction
+/// @param index The index of the instruction
+/// @param successors The indices of the instructions that can be executed next
+/// @return The amount of successors (0 - 2)
+static uint8_t program_analysis_successors(uint16_t opcode, uint16_t index, uint16_t * successors) {
+    switch (opcode & 0xf000) {
+    case 0x0000:
+        // The end of the program, the exits and the returns (continued after the calls) have no successors
+        if (!opcode || opcode == 0x0002 || opcode == 0x00EE || opcode == 0x00FD) {
+            return 0u;
+        }
+        break;
+    case 0x1000:
+    case 0x2000:
+        // Computed like the program counter of the interpreter, so targets below the start of the program wrap around
+        successors[0] = (uint16_t)(((opcode & 0x0fffu) - PROGRAM_START_LOCATION) / 2);
+        successors[1] = index + 1u;
+        return (opcode & 0xf000) == 0x1000 ? 1u : 2u;
+    case 0x3000:
+    case 0x4000:
+    case 0x9000:
+    case 0xe000:
+        successors[0] = index + 1u;
+        successors[1] = index + 2u;
+        return 2u;
+    case 0x5000:
+        successors[0] = index + 1u;
+        successors[1] = index + 2u;
+        return (opcode & 0x000f) ? 1u : 2u;
+    case 0xb000:
+        return 0u;
+    default:
+        break;
+    }
+    successors[0] = index + 1u;
+    return 1u;
+}
+
+/// @brief Determines whether an instruction ends a basic block
+/// @param opcode The opcode of the instruction
+/// @return true if the instruction is a jump, a call, a return, a skip or an exit
+static bool program_analysis_transfers_control(uint16_t opcode) {
+    uint16_t successors[2];
+    switch (opcode & 0xf000) {
+    case 0x1000:
+    case 0x2000:
+        return true;
+    default:
+        return program_analysis_successors(opcode, 0u, successors) != 1u;
+    }
+}
+
+/// @brief Determines whether an instruction uses the address in I
+/// @param opcode The opcode of the instruction
+/// @return true if I is read
+static bool program_analysis_uses_I(uint16_t opcode) {
+    switch (opcode & 0xf000) {
+    case 0x5000:
+        return (opcode & 0x000f) == 0x2 || (opcode & 0x000f) == 0x3;
+    case 0xd000:
+        return true;
+    case 0xf000:
+        switch (opcode & 0x00ff) {
+        case 0x02:
+        case 0x1e:
+        case 0x33:
+        case 0x55:
+        case 0x65:
+            return true;
+        default:
+            return false;
+        }
+    default:
+        return false;
+    }
+}
+
+/// @brief Searches the control flow graph for loops
+/// @details A depth-first search from the block - an edge to a block on the path of the search closes a loop
+/// @param analysis The analysis
+/// @param block The block that is visited
+/// @param states The states of the blocks (see program_analysis_block_state)
+static void program_analysis_visit_block(program_analysis_t * analysis, uint16_t block, uint8_t * states) {
+    states[block] = PROGRAM_ANALYSIS_BLOCK_ACTIVE;
+    for (uint8_t i = 0u; i < 2u; i++) {
+        uint16_t const successor = analysis->blocks[block].successors[i];
+        if (successor == PROGRAM_ANALYSIS_NO_BLOCK) {
+            continue;
+        }
+        if (states[successor] == PROGRAM_ANALYSIS_BLOCK_ACTIVE) {
+            analysis->blocks[successor].loopHeader = true;
+            analysis->loopCount++;
+        } else if (states[successor] == PROGRAM_ANALYSIS_BLOCK_UNVISITED) {
+            program_analysis_visit_block(analysis, successor, states);
+        }
+    }
+    states[block] = PROGRAM_ANALYSIS_BLOCK_VISITED;
+}
+
+/// @brief Determines whether an instruction writes a register
+/// @param opcode The opcode of the instruction
+/// @param reg The index of the register
+/// @return true if the register is written
+static bool program_analysis_writes_register(uint16_t opcode, uint8_t reg) {
+    uint8_t const x = (opcode & 0x0f00u) >> 8;
+    switch (opcode & 0xf000) {
+    case 0x6000:
+    case 0x7000:
+    case 0xc000:
+        return x == reg;
+    case 0x8000:
+        // Arithmetic and shifts set VF
+        return x == reg || (reg == 0xf && (opcode & 0x000f) >= 0x4);
+    case 0xd000:
+        return reg == 0xf;
+    case 0xf000:
+        switch (opcode & 0x00ff) {
+        case 0x07:
+        case 0x0a:
+            return x == reg;
+        case 0x65:
+        case 0x85:
+            return reg <= x;
+        default:
+            return false;
+        }
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,135 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file program_analysis.h
+ * @brief Declarations regarding the static analysis of a loaded CHIP-8 program
+ * @details The control flow graph is built from PROGRAM_START_LOCATION by following the jumps, calls and skips. The
+ * bytes of the program that are never reached are data. Writes whose address is known from a preceding ANNN are
+ * checked against the reachable code, the targets of indirect jumps (BNNN) are unknown. Instructions whose result
+ * depends on the quirk profile reveal the platform the program was written for.
+ */
+
+#ifndef CHIP8_PROGRAM_ANALYSIS_H_
+#define CHIP8_PROGRAM_ANALYSIS_H_
+
+#include "../../base/src/chip8.h"
+#include "virtual_machine.h"
+
+// This file is included in the test-suite that is written in c++ using the google-test framework
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The maximum amount of instructions that are analyzed (the program memory of the CHIP-8)
+#define PROGRAM_ANALYSIS_MAX_INSTRUCTIONS ((VIRTUAL_MACHINE_MEMORY_SIZE - PROGRAM_START_LOCATION) / 2)
+
+/// Marks a basic block that does not exist (a successor outside of the analyzed program)
+#define PROGRAM_ANALYSIS_NO_BLOCK         (UINT16_MAX)
+
+/// @brief Behaviors of a program that depend on the quirk profile
+typedef enum {
+    /// 8XY6 or 8XYE with different registers - the result depends on whether VX or VY is shifted
+    PROGRAM_ANALYSIS_QUIRK_SHIFT = 0b00000001,
+    /// I is used after FX55 or FX65 without being set again - the address depends on whether I was incremented
+    PROGRAM_ANALYSIS_QUIRK_LOAD_STORE = 0b00000010,
+    /// BNNN with X other than zero - the jump depends on whether V0 or VX is added
+    PROGRAM_ANALYSIS_QUIRK_JUMP = 0b00000100,
+    /// VF is read after 8XY1, 8XY2 or 8XY3 without being set again - the value depends on whether VF was reset
+    PROGRAM_ANALYSIS_QUIRK_LOGIC = 0b00001000
+} program_analysis_quirk_dependency;
+
+/// @brief Instruction set extensions a program uses
+typedef enum {
+    /// Scrolling, the high resolution, large sprites, large characters or the user flags
+    PROGRAM_ANALYSIS_EXTENSION_SCHIP = 0b00000001,
+    /// Register ranges in memory, planes, audio patterns or scrolling up
+    PROGRAM_ANALYSIS_EXTENSION_XO_CHIP = 0b00000010
+} program_analysis_extension;
+
+/// @brief A sequence of instructions that is only entered at the first and only left after the last instruction
+typedef struct {
+    /// The index of the first instruction
+    uint16_t start;
+    /// The amount of instructions
+    uint16_t length;
+    /// The basic blocks that can be executed next (PROGRAM_ANALYSIS_NO_BLOCK if there is none)
+    uint16_t successors[2];
+    /// Flag that indicates whether the block is the target of a loop (a backward edge of the control flow graph)
+    bool loopHeader;
+} program_analysis_block_t;
+
+/// @brief The result of the analysis of a program
+typedef struct {
+    /// The program that was analyzed (starts at PROGRAM_START_LOCATION)
+    uint8_t const * program;
+    /// The size of the analyzed program in bytes
+    uint16_t programSize;
+    /// The amount of instructions of the analyzed program
+    uint16_t instructionCount;
+    /// Flags that indicate whether an instruction can be reached from the start of the program
+    bool reachable[PROGRAM_ANALYSIS_MAX_INSTRUCTIONS];
+    /// The basic block of every reachable instruction
+    uint16_t instructionBlocks[PROGRAM_ANALYSIS_MAX_INSTRUCTIONS];
+    /// The basic blocks in the order of their addresses
+    program_analysis_block_t blocks[PROGRAM_ANALYSIS_MAX_INSTRUCTIONS];
+    /// The amount of basic blocks
+    uint16_t blockCount;
+    /// The amount of loops (backward edges of the control flow graph)
+    uint16_t loopCount;
+    /// The amount of reachable indirect jumps (BNNN) - their targets are unknown
+    uint16_t indirectJumps;
+    /// The amount of writes into memory that change reachable instructions
+    uint16_t selfModifyingWrites;
+    /// The amount of writes into memory whose address is not known statically
+    uint16_t unknownWrites;
+    /// The amount of bytes of the program that are not part of a reachable instruction
+    uint16_t dataBytes;
+    /// The behaviors that depend on the quirk profile (see program_analysis_quirk_dependency)
+    uint8_t quirkDependencies;
+    /// The instruction set extensions the program uses (see program_analysis_extension)
+    uint8_t extensions;
+} program_analysis_t;
+
+/// @brief Analyzes a program
+/// @details Programs that are larger than the program memory of the CHIP-8 are only analyzed up to its end
+/// @param analysis The analysis that is written
+/// @param program The program (starts at PROGRAM_START_LOCATION)
+/// @param programSize The size of the program in bytes
+void program_analysis_analyze(program_analysis_t * analysis, uint8_t const * program, uint16_t programSize);
+
+/// @brief Determines the opcode of an instruction of the analyzed program
+/// @param analysis The analysis
+/// @param index The index of the instruction
+/// @return The opcode (the memory behind the program is zero)
+uint16_t program_analysis_opcode(program_analysis_t const * analysis, uint16_t index);
+
+/// @brief Reports the result of an analysis
+/// @param analysis The analysis that is reported
+/// @param stream The stream the report is written to
+void program_analysis_report(program_analysis_t const * analysis, FILE * stream);
+
+/// @brief Suggests the quirk profile a program was most likely written for
+/// @details The extensions decide first, then the quirk dependencies. A program without any evidence gets the
+/// SUPER-CHIP profile, the default of the CHIP-8 mode
+/// @param analysis The analysis of the program
+/// @return The suggested quirk profile
+virtual_machine_quirks program_analysis_suggest_quirks(program_analysis_t const * analysis);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,502 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file recompiler.c
+ * @brief Definitions regarding the ahead-of-time recompiler that translates a CHIP-8 program to C
+ */
+
+#include "recompiler.h"
+
+/// The indentation of the statements of the translated function
+#define RECOMPILER_INDENTATION        "    "
+
+/// The indentation of the statements in a block of the translated function
+#define RECOMPILER_BLOCK_INDENTATION  "        "
+
+/// The size of the map of the bytes that belong to translated instructions
+#define RECOMPILER_CODE_MAP_SIZE      ((VIRTUAL_MACHINE_MEMORY_SIZE - PROGRAM_START_LOCATION) / 8)
+
+/// @brief The quirks of a profile that change the translated instructions (see virtual_machine_interpreter.inc)
+typedef struct {
+    /// 8XY6 and 8XYE shift VY instead of VX
+    bool shiftUsesVY;
+    /// FX55 and FX65 increment I
+    bool loadStoreIncrementsI;
+    /// 8XY1, 8XY2 and 8XY3 reset VF
+    bool logicResetsVF;
+} recompiler_quirks_t;
+
+/// @brief The state of a translation
+typedef struct {
+    /// The analysis of the program that is translated
+    program_analysis_t const * analysis;
+    /// The quirks the program is translated with
+    recompiler_quirks_t const * quirks;
+    /// The stream the translation unit is written to
+    FILE * output;
+    /// Flag that indicates whether the writes into memory are checked - the analysis proved that a program without
+    /// writes into its code or to unknown addresses never changes its code
+    bool checksWrites;
+} recompiler_t;
+
+/// The quirks of the profiles, indexed by virtual_machine_quirks
+static recompiler_quirks_t const recompiler_quirks[VIRTUAL_MACHINE_QUIRKS_COUNT] = {
+    {true, true, true}, {false, false, false}, {true, true, false}};
+
+/// The names of the quirk profiles in the translation unit, indexed by virtual_machine_quirks
+static char const * const recompiler_quirk_names[VIRTUAL_MACHINE_QUIRKS_COUNT] = {
+    "VIRTUAL_MACHINE_QUIRKS_VIP", "VIRTUAL_MACHINE_QUIRKS_SCHIP", "VIRTUAL_MACHINE_QUIRKS_XO_CHIP"};
+
+static void recompiler_emit_code_check(recompiler_t const *, char const *, uint16_t);
+static void recompiler_emit_function(recompiler_t const *);
+static void recompiler_emit_main(recompiler_t const *, virtual_machine_quirks);
+static void recompiler_emit_program(recompiler_t const *);
+static void recompiler_emit_transfer(recompiler_t const *, char const *, uint16_t);
+static bool recompiler_emit_instruction(recompiler_t const *, uint16_t);
+static inline uint16_t recompiler_jump_target(uint16_t);
+static bool recompiler_translates(uint16_t);
+static inline bool recompiler_writes_memory(uint16_t);
+
+int recompiler_translate(program_analysis_t const * analysis, virtual_machine_quirks quirks, FILE * output) {
+    if (!analysis->programSize) {
+        printf("An empty program can not be translated\n");
+        return -1;
+    }
+    recompiler_t recompiler;
+    recompiler.analysis = analysis;
+    recompiler.quirks = &recompiler_quirks[quirks];
+    recompiler.output = output;
+    recompiler.checksWrites = analysis->selfModifyingWrites || analysis->unknownWrites;
+    fprintf(output, "// Translated ahead of time from a CHIP-8 program - do not edit\n");
+    fprintf(output, "// Compile with the include directories chip8/base/src and chip8/backend/src and link against\n"
+                    "// the backend, the core and the io library\n\n");
+    fprintf(output, "#include \"chip8.h\"\n#include \"virtual_machine.h\"\n\n");
+    recompiler_emit_program(&recompiler);
+    recompiler_emit_function(&recompiler);
+    recompiler_emit_main(&recompiler, quirks);
+    uint16_t reachableInstructions = 0u;
+    uint16_t translatedInstructions = 0u;
+    for (uint16_t i = 0u; i < analysis->instructionCount; i++) {
+        if (analysis->reachable[i]) {
+            reachableInstructions++;
+            translatedInstructions += recompiler_translates(program_analysis_opcode(analysis, i));
+        }
+    }
+    printf("Translated %u of %u reachable instructions, the others are interpreted\n", translatedInstructions,
+           reachableInstructions);
+    return 0;
+}
+
+/// @brief Emits a check whether a write into memory changes a translated instruction
+/// @details Once the program changes its translated code the translated function is no longer used
+/// @param recompiler The recompiler
+/// @param indentation The indentation of the check
+/// @param size The amount of bytes that are written starting at I
+static void recompiler_emit_code_check(recompiler_t const * recompiler, char const * indentation, uint16_t size) {
+    if (!recompiler->checksWrites) {
+        return;
+    }
+    fprintf(recompiler->output, "%sif (chip8_aot_writes_code(vm, %uu)) {\n", indentation, size);
+    fprintf(recompiler->output, "%s    vm->compiledProgram = NULL;\n%s}\n", indentation, indentation);
+}
+
+/// @brief Emits the function that executes the translated instructions
+/// @details Every reachable instruction gets a label. The function is entered at the label of the program counter and
+/// checks before every instruction whether it has to stop
+/// @param recompiler The recompiler
+static void recompiler_emit_function(recompiler_t const * recompiler) {
+    FILE * output = recompiler->output;
+    program_analysis_t const * analysis = recompiler->analysis;
+    bool returns = false;
+    for (uint16_t i = 0u; i < analysis->instructionCount; i++) {
+        returns |= analysis->reachable[i] && program_analysis_opcode(analysis, i) == 0x00EE;
+    }
+    fprintf(output, "/// @brief Executes the translated instructions (see virtual_machine_compiled_program_t)\n");
+    fprintf(output, "static int8_t chip8_aot_execute(struct virtual_machine_core_t * vm, uint64_t stopCycle) {\n");
+    if (returns) {
+        fprintf(output, "dispatch:\n");
+    }
+    fprintf(output, RECOMPILER_INDENTATION "switch (vm->programCounter) {\n");
+    for (uint16_t i = 0u; i < analysis->instructionCount; i++) {
+        if (analysis->reachable[i]) {
+            fprintf(output, RECOMPILER_INDENTATION "case 0x%04Xu:\n", i);
+            fprintf(output, RECOMPILER_BLOCK_INDENTATION "goto L_%04X;\n", i);
+        }
+    }
+    fprintf(output, RECOMPILER_INDENTATION "default:\n");
+    fprintf(output, RECOMPILER_BLOCK_INDENTATION "return VIRTUAL_MACHINE_COMPILED_INTERPRET;\n");
+    fprintf(output, RECOMPILER_INDENTATION "}\n");
+    for (uint16_t i = 0u; i < analysis->instructionCount; i++) {
+        if (!analysis->reachable[i]) {
+            continue;
+        }
+        uint16_t opcode = program_analysis_opcode(analysis, i);
+        // The analysis found the loops, so the hot paths can be recognized in the translation
+        program_analysis_block_t const * block = &analysis->blocks[analysis->instructionBlocks[i]];
+        fprintf(output, "L_%04X: // 0x%03X: %04X%s\n", i, PROGRAM_START_LOCATION + i * 2u, opcode,
+                block->start == i && block->loopHeader ? " (loop)" : "");
+        fprintf(output, RECOMPILER_INDENTATION "if (vm->cycles >= stopCycle) {\n");
+        fprintf(output, RECOMPILER_BLOCK_INDENTATION "vm->programCounter = 0x%04Xu;\n", i);
+        fprintf(output, RECOMPILER_BLOCK_INDENTATION "return VIRTUAL_MACHINE_COMPILED_YIELDED;\n");
+        fprintf(output, RECOMPILER_INDENTATION "}\n");
+        if (!recompiler_emit_instruction(recompiler, i)) {
+            // Executed by the interpreter, which continues with the translated code afterwards
+            fprintf(output, RECOMPILER_INDENTATION "vm->programCounter = 0x%04Xu;\n", i);
+            fprintf(output, RECOMPILER_INDENTATION "return VIRTUAL_MACHINE_COMPILED_INTERPRET;\n");
+        }
+    }
+    fprintf(output, "}\n\n");
+}
+
+/// @brief Emits the main function that executes the program with the translated instructions
+/// @param recompiler The recompiler
+/// @param quirks The quirk profile the program was translated for
+static void recompiler_emit_main(recompiler_t const * recompiler, virtual_machine_quirks quirks) {
+    fprintf(recompiler->output,
+            "int main(int argc, char * argv[]) {\n"
+            "    virtual_machine_t vm;\n"
+            "    virtual_machine_image_t image;\n"
+            "    virtual_machine_execution_options_t options = {0};\n"
+            "    uint32_t displayFlags = 0u;\n"
+            "    for (int i = 1; i < argc; i++) {\n"
+            "        if (!strcmp(argv[i], \"--headless\")) {\n"
+            "            displayFlags |= DISPLAY_FLAG_OFFSCREEN;\n"
+            "        } else if (!strcmp(argv[i], \"--cycles\") && i + 1 < argc) {\n"
+            "            options.maximumCycles = strtoull(argv[++i], NULL, 10);\n"
+            "        } else {\n"
+            "            fprintf(stderr, \"Usage: %%s [--headless] [--cycles <n>]\\n\", argv[0]);\n"
+            "            return 1;\n"
+            "        }\n"
+            "    }\n"
+            "    if (virtual_machine_init(&vm, VIRTUAL_MACHINE_MODE_CHIP8)) {\n"
+            "        return 1;\n"
+            "    }\n"
+            "    if (virtual_machine_image_init(&image, VIRTUAL_MACHINE_MODE_CHIP8)) {\n"
+            "        virtual_machine_free(&vm);\n"
+            "        return 1;\n"
+            "    }\n"
+            "    memcpy(image.memory + PROGRAM_START_LOCATION, chip8_aot_program, sizeof(chip8_aot_program));\n"
+            "    virtual_machine_core_map_image(&vm.core, &image);\n"
+            "    virtual_machine_core_seed(&vm.core, 0u);\n"
+            "    vm.core.quirks = %s;\n"
+            "    vm.core.compiledProgram = chip8_aot_execute;\n"
+            "    if (display_init(&vm.display, displayFlags)) {\n"
+            "        virtual_machine_free(&vm);\n"
+            "        virtual_machine_image_free(&image);\n"
+            "        return 1;\n"
+            "    }\n"
+            "    virtual_machine_execute(&vm, &options);\n"
+            "    if (displayFlags & DISPLAY_FLAG_OFFSCREEN) {\n"
+            "        printf(\"Executed %%llu instructions, framebuffer hash 0x%%016llX\\n\", "
+            "(unsigned long long)vm.core.cycles,\n"
+            "               (unsigned long long)display_hash(&vm.display));\n"
+            "    }\n"
+            "    display_quit(&vm.display);\n"
+            "    virtual_machine_free(&vm);\n"
+            "    virtual_machine_image_free(&image);\n"
+            "    return 0;\n"
+            "}\n",
+            recompiler_quirk_names[quirks]);
+}
+
+/// @brief Emits the program and the map of the bytes that belong to translated instructions
+/// @details The map is only emitted if the program may write into its code
+/// @param recompiler The recompiler
+static void recompiler_emit_program(recompiler_t const * recompiler) {
+    FILE * output = recompiler->output;
+    program_analysis_t const * analysis = recompiler->analysis;
+    fprintf(output, "/// The program that was translated - loaded into memory, so the interpreter can execute it\n");
+    fprintf(output, "static uint8_t const chip8_aot_program[] = {");
+    for (uint16_t i = 0u; i < analysis->programSize; i++) {
+        fprintf(output, "%s0x%02X%s", i % 16 ? " " : "\n    ", analysis->program[i],
+                i + 1u < analysis->programSize ? "," : "");
+    }
+    fprintf(output, "};\n\n");
+    if (!recompiler->checksWrites) {
+        return;
+    }
+    uint8_t codeMap[RECOMPILER_CODE_MAP_SIZE] = {0u};
+    for (uint16_t i = 0u; i < analysis->instructionCount; i++) {
+        if (analysis->reachable[i] && recompiler_translates(program_analysis_opcode(analysis, i))) {
+            // Both bytes of an instruction share a byte of the map
+            codeMap[i / 4] |= 0x3u << (i % 4 * 2);
+        }
+    }
+    fprintf(output, "/// One bit per byte of memory after 0x%03X that is set if the byte belongs to a translated "
+                    "instruction\n", PROGRAM_START_LOCATION);
+    fprintf(output, "static uint8_t const chip8_aot_code_map[%u] = {", RECOMPILER_CODE_MAP_SIZE);
+    for (uint16_t i = 0u; i < RECOMPILER_CODE_MAP_SIZE; i++) {
+        fprintf(output, "%s0x%02X%s", i % 16 ? " " : "\n    ", codeMap[i],
+                i + 1u < RECOMPILER_CODE_MAP_SIZE ? "," : "");
+    }
+    fprintf(output, "};\n\n");
+    fprintf(output, "/// @brief Determines whether a write of size bytes starting at I changes a translated\n"
+                    "/// instruction\n"
+                    "static bool chip8_aot_writes_code(struct virtual_machine_core_t const * vm, uint16_t size) {\n"
+                    "    for (uint16_t i = 0u; i < size; i++) {\n"
+                    "        uint16_t const address = (vm->I + i) & vm->memoryMask;\n"
+                    "        if (address >= PROGRAM_START_LOCATION) {\n"
+                    "            uint16_t const offset = address - PROGRAM_START_LOCATION;\n"
+                    "            if (chip8_aot_code_map[offset / 8] & (1u << (offset %% 8))) {\n"
+                    "                return true;\n"
+                    "            }\n"
+                    "        }\n"
+                    "    }\n"
+                    "    return false;\n"
+                    "}\n\n");
+}
+
+/// @brief Emits the transfer of the control to an instruction
+/// @details Translated instructions are reached by a goto, the others are executed by the interpreter
+/// @param recompiler The recompiler
+/// @param indentation The indentation of the transfer
+/// @param index The index of the instruction
+static void recompiler_emit_transfer(recompiler_t const * recompiler, char const * indentation, uint16_t index) {
+    if (index < recompiler->analysis->instructionCount && recompiler->analysis->reachable[index]) {
+        fprintf(recompiler->output, "%sgoto L_%04X;\n", indentation, index);
+        return;
+    }
+    fprintf(recompiler->output, "%svm->programCounter = 0x%04Xu;\n", indentation, index);
+    fprintf(recompiler->output, "%sreturn VIRTUAL_MACHINE_COMPILED_INTERPRET;\n", indentation);
+}
+
+/// @brief Emits a translated instruction
+/// @details The statements match virtual_machine_interpreter.inc, so the translated program behaves exactly like the
+/// interpreted one. Every instruction increments the amount of executed instructions and transfers the control
+/// @param recompiler The recompiler
+/// @param index The index of the instruction
+/// @return true if the instruction was translated, false if it is executed by the interpreter
+static bool recompiler_emit_instruction(recompiler_t const * recompiler, uint16_t index) {
+    FILE * output = recompiler->output;
+    uint16_t const opcode = program_analysis_opcode(recompiler->analysis, index);
+    uint8_t const x = (opcode & 0x0f00u) >> 8;
+    uint8_t const y = (opcode & 0x00f0u) >> 4;
+    uint8_t const value = opcode & 0x00ffu;
+    if (!recompiler_translates(opcode) && recompiler_writes_memory(opcode)) {
+        // 0x5XY2 is interpreted, but the translated code must not be used once it was overwritten
+        recompiler_emit_code_check(recompiler, RECOMPILER_INDENTATION, (x <= y ? y - x : x - y) + 1u);
+    }
+    if (!recompiler_translates(opcode)) {
+        return false;
+    }
+    switch (opcode & 0xf000) {
+    case 0x0000:
+        if (opcode == 0x00EE) {
+            // The address of the return is only known at runtime - the interpreter reports an empty stack
+            fprintf(output, RECOMPILER_INDENTATION "if (vm->stackPointer == vm->stack) {\n");
+            fprintf(output, RECOMPILER_BLOCK_INDENTATION "vm->programCounter = 0x%04Xu;\n", index);
+            fprintf(output, RECOMPILER_BLOCK_INDENTATION "return VIRTUAL_MACHINE_COMPILED_INTERPRET;\n");
+            fprintf(output, RECOMPILER_INDENTATION "}\n");
+            fprintf(output, RECOMPILER_INDENTATION "vm->programCounter = *--vm->stackPointer + 1u;\n");
+            fprintf(output, RECOMPILER_INDENTATION "vm->cycles++;\n" RECOMPILER_INDENTATION "goto dispatch;\n");
+            return true;
+        }
+        fprintf(output, RECOMPILER_INDENTATION "graphics_system_clear(&vm->graphicsSystem);\n");
+        break;
+    case 0x1000:
+        fprintf(output, RECOMPILER_INDENTATION "vm->cycles++;\n");
+        recompiler_emit_transfer(recompiler, RECOMPILER_INDENTATION, recompiler_jump_target(opcode));
+        return true;
+    case 0x2000:
+        // The interpreter reports a full stack
+        fprintf(output, RECOMPILER_INDENTATION
+                "if (vm->stackPointer == vm->stack + sizeof(vm->stack) / sizeof(*vm->stack)) {\n");
+        fprintf(output, RECOMPILER_BLOCK_INDENTATION "vm->programCounter = 0x%04Xu;\n", index);
+        fprintf(output, RECOMPILER_BLOCK_INDENTATION "return VIRTUAL_MACHINE_COMPILED_INTERPRET;\n");
+        fprintf(output, RECOMPILER_INDENTATION "}\n");
+        fprintf(output, RECOMPILER_INDENTATION "*vm->stackPointer++ = 0x%04Xu;\n", index);
+        fprintf(output, RECOMPILER_INDENTATION "vm->cycles++;\n");
+        recompiler_emit_transfer(recompiler, RECOMPILER_INDENTATION, recompiler_jump_target(opcode));
+        return true;
+    case 0x3000:
+    case 0x4000:
+    case 0x5000:
+        fprintf(output, RECOMPILER_INDENTATION "vm->cycles++;\n");
+        if ((opcode & 0xf000) == 0x5000) {
+            fprintf(output, RECOMPILER_INDENTATION "if (vm->V[0x%X] == vm->V[0x%X]) {\n", x, y);
+        } else {
+            fprintf(output, RECOMPILER_INDENTATION "if (vm->V[0x%X] %s 0x%02Xu) {\n", x,
+                    (opcode & 0xf000) == 0x3000 ? "==" : "!=", value);
+        }
+        recompiler_emit_transfer(recompiler, RECOMPILER_BLOCK_INDENTATION, index + 2u);
+        fprintf(output, RECOMPILER_INDENTATION "}\n");
+        recompiler_emit_transfer(recompiler, RECOMPILER_INDENTATION, index + 1u);
+        return true;
+    case 0x6000:
+        fprintf(output, RECOMPILER_INDENTATION "vm->V[0x%X] = 0x%02Xu;\n", x, value);
+        break;
+    case 0x7000:
+        fprintf(output, RECOMPILER_INDENTATION "vm->V[0x%X] += 0x%02Xu;\n", x, value);
+        break;
+    case 0x8000:
+        switch (opcode & 0x000f) {
+        case 0x0:
+            fprintf(output, RECOMPILER_INDENTATION "vm->V[0x%X] = vm->V[0x%X];\n", x, y);
+            break;
+        case 0x1:
+        case 0x2:
+        case 0x3:
+            fprintf(output, RECOMPILER_INDENTATION "vm->V[0x%X] %c= vm->V[0x%X];\n", x, "|&^"[(opcode & 0x000f) - 1],
+                    y);
+            if (recompiler->quirks->logicResetsVF) {
+                fprintf(output, RECOMPILER_INDENTATION "vm->V[0xF] = 0u;\n");
+            }
+            break;
+        case 0x4:
+        case 0x5:
+        case 0x7:
+            {
+                // The flag is only ever set, like in the interpreter
+                uint8_t const minuend = (opcode & 0x000f) == 0x7 ? y : x;
+                uint8_t const subtrahend = (opcode & 0x000f) == 0x7 ? x : y;
+                fprintf(output, RECOMPILER_INDENTATION "{\n");
+                fprintf(output, RECOMPILER_BLOCK_INDENTATION "uint8_t result = vm->V[0x%X] %c vm->V[0x%X];\n", minuend,
+                        (opcode & 0x000f) == 0x4 ? '+' : '-', subtrahend);
+                fprintf(output, RECOMPILER_BLOCK_INDENTATION "if (result %c (result - vm->V[0x%X])) {\n",
+                        (opcode & 0x000f) == 0x5 ? '<' : '>', x);
+                fprintf(output, RECOMPILER_BLOCK_INDENTATION "    vm->V[0xF] = 0x1u;\n");
+                fprintf(output, RECOMPILER_BLOCK_INDENTATION "}\n");
+                fprintf(output, RECOMPILER_BLOCK_INDENTATION "vm->V[0x%X] = result;\n", x);
+                fprintf(output, RECOMPILER_INDENTATION "}\n");
+                break;
+            }
+        default: // 0x8XY6 and 0x8XYE
+            fprintf(output, RECOMPILER_INDENTATION "{\n");
+            fprintf(output, RECOMPILER_BLOCK_INDENTATION "uint8_t const source = vm->V[0x%X];\n",
+                    recompiler->quirks->shiftUsesVY ? y : x);
+            if ((opcode & 0x000f) == 0x6) {
+                fprintf(output, RECOMPILER_BLOCK_INDENTATION "vm->V[0x%X] = source >> 1;\n", x);
+                fprintf(output, RECOMPILER_BLOCK_INDENTATION "vm->V[0xF] = source & 0x01u;\n");
+            } else {
+                fprintf(output, RECOMPILER_BLOCK_INDENTATION "vm->V[0x%X] = (uint8_t)(source << 1);\n", x);
+                fprintf(output, RECOMPILER_BLOCK_INDENTATION "vm->V[0xF] = source >> 7;\n");
+            }
+            fprintf(output, RECOMPILER_INDENTATION "}\n");
+            break;
+        }
+        break;
+    case 0xa000:
+        fprintf(output, RECOMPILER_INDENTATION "vm->I = 0x%03Xu;\n", opcode & 0x0fff);
+        break;
+    default: // 0xF000
+        switch (value) {
+        case 0x07:
+            fprintf(output,
+                    RECOMPILER_INDENTATION "vm->V[0x%X] = virtual_machine_core_timer_value(vm, &vm->delayTimer);\n", x);
+            break;
+        case 0x15:
+        case 0x18:
+            // A timer is set at the current frame (see virtual_machine_set_timer)
+            fprintf(output, RECOMPILER_INDENTATION "vm->%s = (virtual_machine_timer_t){vm->V[0x%X], vm->frames};\n",
+                    value == 0x15 ? "delayTimer" : "soundTimer", x);
+            break;
+        case 0x1e:
+            fprintf(output, RECOMPILER_INDENTATION "vm->I += vm->V[0x%X];\n", x);
+            break;
+        case 0x33:
+            recompiler_emit_code_check(recompiler, RECOMPILER_INDENTATION, 3u);
+            fprintf(output, RECOMPILER_INDENTATION "virtual_machine_core_write(vm, vm->I, vm->V[0x%X] / 100u);\n", x);
+            fprintf(output,
+                    RECOMPILER_INDENTATION "virtual_machine_core_write(vm, vm->I + 1u, vm->V[0x%X] %% 100u / 10u);\n",
+                    x);
+            fprintf(output, RECOMPILER_INDENTATION "virtual_machine_core_write(vm, vm->I + 2u, vm->V[0x%X] %% 10u);\n",
+                    x);
+            break;
+        case 0x55:
+        case 0x65:
+            if (value == 0x55) {
+                recompiler_emit_code_check(recompiler, RECOMPILER_INDENTATION, x + 1u);
+            }
+            fprintf(output, RECOMPILER_INDENTATION "for (uint8_t i = 0u; i <= 0x%X; i++) {\n", x);
+            if (value == 0x55) {
+                fprintf(output, RECOMPILER_BLOCK_INDENTATION "virtual_machine_core_write(vm, vm->I + i, vm->V[i]);\n");
+            } else {
+                fprintf(output, RECOMPILER_BLOCK_INDENTATION "vm->V[i] = virtual_machine_core_read(vm, vm->I + i);\n");
+            }
+            fprintf(output, RECOMPILER_INDENTATION "}\n");
+            if (recompiler->quirks->loadStoreIncrementsI) {
+                fprintf(output, RECOMPILER_INDENTATION "vm->I += 0x%Xu;\n", x + 1u);
+            }
+            break;
+        }
+        break;
+    }
+    fprintf(output, RECOMPILER_INDENTATION "vm->cycles++;\n");
+    if (recompiler->checksWrites && recompiler_writes_memory(opcode)) {
+        // The program changed its translated code - it is interpreted from the next instruction on
+        fprintf(output, RECOMPILER_INDENTATION "if (!vm->compiledProgram) {\n");
+        fprintf(output, RECOMPILER_BLOCK_INDENTATION "vm->programCounter = 0x%04Xu;\n", index + 1u);
+        fprintf(output, RECOMPILER_BLOCK_INDENTATION "return VIRTUAL_MACHINE_COMPILED_YIELDED;\n");
+        fprintf(output, RECOMPILER_INDENTATION "}\n");
+    }
+    recompiler_emit_transfer(recompiler, RECOMPILER_INDENTATION, index + 1u);
+    return true;
+}
+
+/// @brief Determines the instruction a jump or a call continues at
+/// @details Computed like the program counter of the interpreter, so targets below the start of the program wrap
+/// around the same way
+/// @param opcode The opcode of the jump or the call
+/// @return The index of the instruction
+static inline uint16_t recompiler_jump_target(uint16_t opcode) {
+    return (uint16_t)(((opcode & 0x0fffu) - PROGRAM_START_LOCATION) / 2);
+}
+
+/// @brief Determines whether an instruction is translated
+/// @details Drawing, random numbers, the keyboard, the font, the extensions and the indirect jump are left to the
+/// interpreter. So is 9XY0, which skips if VX equals VY in the interpreter
+/// @param opcode The opcode of the instruction
+/// @return true if the instruction is translated, false if it is executed by the interpreter
+static bool recompiler_translates(uint16_t opcode) {
+    switch (opcode & 0xf000) {
+    case 0x0000:
+        return opcode == 0x00E0 || opcode == 0x00EE;
+    case 0x1000:
+    case 0x2000:
+    case 0x3000:
+    case 0x4000:
+    case 0x6000:
+    case 0x7000:
+    case 0xa000:
+        return true;
+    case 0x5000:
+        return !(opcode & 0x000f);
+    case 0x8000:
+        return (opcode & 0x000f) <= 0x7 || (opcode & 0x000f) == 0xe;
+    case 0xf000:
+        switch (opcode & 0x00ff) {
+        case 0x07:
+        case 0x15:
+        case 0x18:
+        case 0x1e:
+        case 0x33:
+        case 0x55:
+        case 0x65:
+            return true;
+        default:
+            return false;
+        }
+    default:
+        return false;
+    }
+}
+
+/// @brief Determines whether an instruction writes into memory (5XY2, FX33 and FX55)
+/// @param opcode The opcode of the instruction
+/// @return true if the instruction writes into memory
+static inline bool recompiler_writes_memory(uint16_t opcode) {
+    return (opcode & 0xf00f) == 0x5002 || (opcode & 0xf0ff) == 0xf033 || (opcode & 0xf0ff) == 0xf055;
+}
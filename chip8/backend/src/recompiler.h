@@ -0,0 +1,50 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file recompiler.h
+ * @brief Declarations regarding the ahead-of-time recompiler that translates a CHIP-8 program to C
+ * @details The reachable instructions are found by the analysis of the program (see program_analysis.h). Every
+ * reachable instruction becomes a label in a C function, jumps and calls become gotos. Instructions that depend on the
+ * state of the display or the keyboard, indirect jumps and instructions that were not found reachable are executed by
+ * the interpreter (see virtual_machine_compiled_program_t). A program that writes into its own translated code is
+ * interpreted from then on.
+ */
+
+#ifndef CHIP8_RECOMPILER_H_
+#define CHIP8_RECOMPILER_H_
+
+#include "program_analysis.h"
+
+// This file is included in the test-suite that is written in c++ using the google-test framework
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief Translates a CHIP-8 program to a C translation unit
+/// @details The translation unit embeds the program and defines a main function that executes it with the translated
+/// code. It is compiled with the include directories chip8/base/src and chip8/backend/src and linked against the
+/// backend and the io library
+/// @param analysis The analysis of the program that is translated
+/// @param quirks The quirk profile the program is translated for
+/// @param output The stream the translation unit is written to
+/// @return 0 if the program was translated, -1 if the program is empty
+int recompiler_translate(program_analysis_t const * analysis, virtual_machine_quirks quirks, FILE * output);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,58 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file triple_buffer.c
+ * @brief Definitions regarding the lock-free triple buffer used to hand frames to the thread that presents them
+ */
+
+#include "triple_buffer.h"
+
+/// Flag that is set in the middle index when the producer has published a frame the consumer has not seen yet
+#define TRIPLE_BUFFER_FRESH_FLAG (0x4)
+
+/// Mask that is used to extract the slot index from the middle index
+#define TRIPLE_BUFFER_INDEX_MASK (0x3)
+
+void triple_buffer_init(triple_buffer_t * buffer) {
+    buffer->backIndex = 0u;
+    SDL_AtomicSet(&buffer->middleIndex, 1);
+    buffer->frontIndex = 2u;
+}
+
+uint8_t triple_buffer_back_index(triple_buffer_t const * buffer) {
+    return buffer->backIndex;
+}
+
+uint8_t triple_buffer_publish(triple_buffer_t * buffer) {
+    // Makes sure all writes to the back slot are visible before the slot is handed over
+    SDL_MemoryBarrierRelease();
+    int previous = SDL_AtomicSet(&buffer->middleIndex, buffer->backIndex | TRIPLE_BUFFER_FRESH_FLAG);
+    buffer->backIndex = previous & TRIPLE_BUFFER_INDEX_MASK;
+    return buffer->backIndex;
+}
+
+bool triple_buffer_acquire(triple_buffer_t * buffer, uint8_t * index) {
+    if (!(SDL_AtomicGet(&buffer->middleIndex) & TRIPLE_BUFFER_FRESH_FLAG)) {
+        *index = buffer->frontIndex;
+        return false;
+    }
+    int previous = SDL_AtomicSet(&buffer->middleIndex, buffer->frontIndex);
+    // Makes sure the reads from the new front slot happen after the slot was handed over
+    SDL_MemoryBarrierAcquire();
+    buffer->frontIndex = previous & TRIPLE_BUFFER_INDEX_MASK;
+    *index = buffer->frontIndex;
+    return true;
+}
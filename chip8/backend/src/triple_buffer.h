@@ -0,0 +1,67 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file triple_buffer.h
+ * @brief Declarations regarding the lock-free triple buffer used to hand frames to the thread that presents them
+ * @details The triple buffer only manages the indices of three slots that are owned by the caller. The producer always
+ * owns the back slot and the consumer always owns the front slot, the third slot holds the latest published frame.
+ * Publishing and acquiring are a single atomic exchange, so neither side ever waits for the other.
+ */
+
+#ifndef CHIP8_TRIPLE_BUFFER_H_
+#define CHIP8_TRIPLE_BUFFER_H_
+
+#include "../../../external/SDL/include/SDL.h"
+#include "backend_pre_compiled_header.h"
+
+/// Size of a cache line - used to keep the producer and consumer owned indices apart
+#define TRIPLE_BUFFER_CACHE_LINE_SIZE (64)
+
+/// @brief Models a lock-free single-producer / single-consumer triple buffer
+typedef struct {
+    /// Index of the slot that is currently written by the producer
+    uint8_t backIndex;
+    /// Padding to avoid false sharing between the producer and the consumer
+    uint8_t producerPadding[TRIPLE_BUFFER_CACHE_LINE_SIZE - sizeof(uint8_t)];
+    /// Index of the slot that holds the latest published frame, combined with a flag that indicates a new frame
+    SDL_atomic_t middleIndex;
+    /// Padding to avoid false sharing between the producer and the consumer
+    uint8_t sharedPadding[TRIPLE_BUFFER_CACHE_LINE_SIZE - sizeof(SDL_atomic_t)];
+    /// Index of the slot that is currently read by the consumer
+    uint8_t frontIndex;
+} triple_buffer_t;
+
+/// @brief Initializes the triple buffer
+/// @param buffer The triple buffer that is initialized
+void triple_buffer_init(triple_buffer_t * buffer);
+
+/// @brief Gets the index of the slot that is currently owned by the producer
+/// @param buffer The triple buffer
+/// @return The index of the back slot (0-2)
+uint8_t triple_buffer_back_index(triple_buffer_t const * buffer);
+
+/// @brief Publishes the back slot and hands the producer a new back slot
+/// @param buffer The triple buffer where the back slot is published
+/// @return The index of the new back slot (0-2)
+uint8_t triple_buffer_publish(triple_buffer_t * buffer);
+
+/// @brief Acquires the latest published slot if a new one is available
+/// @param buffer The triple buffer where the latest slot is acquired from
+/// @param index Is set to the index of the front slot (0-2)
+/// @return true if a new frame was acquired, false if the front slot still holds the previous frame
+bool triple_buffer_acquire(triple_buffer_t * buffer, uint8_t * index);
+
+#endif
@@ -0,0 +1,243 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file video_recorder.c
+ * @brief Definitions regarding the capture of the frames to a video file
+ */
+
+#include "video_recorder.h"
+
+#include "display.h"
+
+static bool video_recorder_frames_equal(video_recorder_frame_t const *, graphics_system_t const *);
+static bool video_recorder_pop(video_recorder_queue_t *, video_recorder_frame_t **);
+static void video_recorder_push(video_recorder_queue_t *, video_recorder_frame_t *);
+static int video_recorder_write_frame(video_recorder_t *, video_recorder_frame_t const *);
+static int video_recorder_writer_thread(void *);
+
+int video_recorder_init(video_recorder_t * recorder, char const * path) {
+    size_t const pathLength = strlen(path);
+    if (pathLength > 4 && !strcmp(path + pathLength - 4, ".y4m")) {
+        recorder->format = VIDEO_RECORDER_FORMAT_Y4M;
+    } else if (pathLength > 4 && !strcmp(path + pathLength - 4, ".pbm")) {
+        recorder->format = VIDEO_RECORDER_FORMAT_PBM;
+    } else {
+        printf("Videos can only be recorded to .y4m or .pbm files\n");
+        return -1;
+    }
+    recorder->path = path;
+    recorder->file = NULL;
+    recorder->bitmapPath = NULL;
+    recorder->failed = false;
+    recorder->currentFrame = NULL;
+    recorder->frames = 0u;
+    recorder->droppedFrames = 0u;
+    SDL_AtomicSet(&recorder->recordedFrames.head, 0);
+    SDL_AtomicSet(&recorder->recordedFrames.tail, 0);
+    SDL_AtomicSet(&recorder->freeFrames.head, 0);
+    SDL_AtomicSet(&recorder->freeFrames.tail, 0);
+    for (uint8_t i = 0; i < VIDEO_RECORDER_POOL_SIZE; i++) {
+        // The planes are not initialized yet, so the first frame that is copied clears all of them
+        recorder->pool[i].copiedSize = sizeof(recorder->pool[i].graphicsSystem.planes);
+        video_recorder_push(&recorder->freeFrames, &recorder->pool[i]);
+    }
+    if (recorder->format == VIDEO_RECORDER_FORMAT_Y4M) {
+        // Full-range BT.601 with the weights scaled by 256
+        for (uint8_t color = 0; color < GRAPHICS_SYSTEM_COLOR_COUNT; color++) {
+            int const red = display_palette[color][0], green = display_palette[color][1];
+            int const blue = display_palette[color][2];
+            recorder->palette[color][0] = (uint8_t)((77 * red + 150 * green + 29 * blue + 128) >> 8);
+            recorder->palette[color][1] = (uint8_t)((-43 * red - 85 * green + 128 * blue + 32768) >> 8);
+            recorder->palette[color][2] = (uint8_t)((128 * red - 107 * green - 21 * blue + 32768) >> 8);
+        }
+        recorder->file = fopen(path, "wb");
+        if (!recorder->file) {
+            printf("Could not open file \"%s\"\n", path);
+            return -1;
+        }
+        fprintf(recorder->file, "YUV4MPEG2 W%i H%i F%u:1 Ip A1:1 C444 XCOLORRANGE=FULL\n",
+                GRAPHICS_SYSTEM_HIGH_RESOLUTION_WIDTH, GRAPHICS_SYSTEM_HIGH_RESOLUTION_HEIGHT, DISPLAY_FRAME_RATE);
+    } else {
+        // The number of the frame replaces the extension
+        recorder->bitmapPath = (char *)malloc(pathLength + 24u);
+        if (!recorder->bitmapPath) {
+            printf("Could not allocate memory for the path of the bitmaps\n");
+            return -1;
+        }
+    }
+    recorder->frameRecorded = SDL_CreateSemaphore(0);
+    recorder->writerThread =
+        recorder->frameRecorded ? SDL_CreateThread(video_recorder_writer_thread, "CHIP-8 Video", recorder) : NULL;
+    if (!recorder->writerThread) {
+        printf("Video writer thread could not be created! SDL Error: %s\n", SDL_GetError());
+        SDL_DestroySemaphore(recorder->frameRecorded);
+        if (recorder->file) {
+            fclose(recorder->file);
+        }
+        free(recorder->bitmapPath);
+        return -1;
+    }
+    return 0;
+}
+
+void video_recorder_record_frame(video_recorder_t * recorder, graphics_system_t const * graphicsSystem) {
+    video_recorder_frame_t * frame = recorder->currentFrame;
+    recorder->frames++;
+    if (frame && video_recorder_frames_equal(frame, graphicsSystem)) {
+        frame->repeats++;
+        return;
+    }
+    video_recorder_frame_t * nextFrame;
+    if (!video_recorder_pop(&recorder->freeFrames, &nextFrame)) {
+        // The writer thread is behind - the pool is only empty if the current frame is taken from it
+        frame->repeats++;
+        recorder->droppedFrames++;
+        return;
+    }
+    if (frame) {
+        video_recorder_push(&recorder->recordedFrames, frame);
+        SDL_SemPost(recorder->frameRecorded);
+    }
+    // Planes that were never used are always empty, so a classic program only copies the first plane
+    size_t const size = graphics_system_used_planes_size(graphicsSystem);
+    memcpy(nextFrame->graphicsSystem.planes, graphicsSystem->planes, size);
+    if (nextFrame->copiedSize > size) {
+        memset((uint8_t *)nextFrame->graphicsSystem.planes + size, 0, nextFrame->copiedSize - size);
+    }
+    nextFrame->copiedSize = size;
+    nextFrame->graphicsSystem.mode = graphicsSystem->mode;
+    nextFrame->graphicsSystem.selectedPlanes = graphicsSystem->selectedPlanes;
+    nextFrame->graphicsSystem.usedPlanes = graphicsSystem->usedPlanes;
+    nextFrame->number = recorder->frames - 1u;
+    nextFrame->repeats = 1u;
+    recorder->currentFrame = nextFrame;
+}
+
+int video_recorder_free(video_recorder_t * recorder) {
+    if (recorder->currentFrame) {
+        video_recorder_push(&recorder->recordedFrames, recorder->currentFrame);
+        SDL_SemPost(recorder->frameRecorded);
+        recorder->currentFrame = NULL;
+    }
+    // A signal without a frame stops the writer thread once it has written every frame
+    SDL_SemPost(recorder->frameRecorded);
+    SDL_WaitThread(recorder->writerThread, NULL);
+    SDL_DestroySemaphore(recorder->frameRecorded);
+    int result = recorder->failed ? -1 : 0;
+    if (recorder->file && fclose(recorder->file)) {
+        printf("Could not write to file \"%s\"\n", recorder->path);
+        result = -1;
+    }
+    free(recorder->bitmapPath);
+    if (recorder->droppedFrames) {
+        printf("%llu changed frames were recorded as repeats, because the video was written too slowly\n",
+               (unsigned long long)recorder->droppedFrames);
+    }
+    return result;
+}
+
+/// @brief Compares a frame of the pool to a framebuffer
+/// @param frame The frame of the pool
+/// @param graphicsSystem The framebuffer
+/// @return true if both show the same frame, false if not
+static bool video_recorder_frames_equal(video_recorder_frame_t const * frame,
+                                        graphics_system_t const * graphicsSystem) {
+    return frame->graphicsSystem.mode == graphicsSystem->mode &&
+           frame->graphicsSystem.usedPlanes == graphicsSystem->usedPlanes &&
+           !memcmp(frame->graphicsSystem.planes, graphicsSystem->planes,
+                   graphics_system_used_planes_size(graphicsSystem));
+}
+
+/// @brief Pops the oldest frame from a queue (consumer only)
+/// @param queue The queue where the frame is popped from
+/// @param frame Is set to the frame that was popped
+/// @return true if a frame was popped, false if the queue is empty
+static bool video_recorder_pop(video_recorder_queue_t * queue, video_recorder_frame_t ** frame) {
+    int tail = SDL_AtomicGet(&queue->tail);
+    if (tail == SDL_AtomicGet(&queue->head)) {
+        return false;
+    }
+    // Makes sure the frame is read after it was handed over
+    SDL_MemoryBarrierAcquire();
+    *frame = queue->frames[tail & (VIDEO_RECORDER_POOL_SIZE - 1)];
+    // Makes sure the frame was read before the slot is handed back to the producer
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&queue->tail, tail + 1);
+    return true;
+}
+
+/// @brief Pushes a frame into a queue (producer only) - a queue holds every frame of the pool, so it is never full
+/// @param queue The queue where the frame is pushed
+/// @param frame The frame that is pushed
+static void video_recorder_push(video_recorder_queue_t * queue, video_recorder_frame_t * frame) {
+    int head = SDL_AtomicGet(&queue->head);
+    queue->frames[head & (VIDEO_RECORDER_POOL_SIZE - 1)] = frame;
+    // Makes sure the frame is visible before it is handed over
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&queue->head, head + 1);
+}
+
+/// @brief Writes a frame of the pool to the video file (writer thread only)
+/// @param recorder The recorder that writes the frame
+/// @param frame The frame that is written
+/// @return 0 if everything went well, -1 if an error occured
+static int video_recorder_write_frame(video_recorder_t * recorder, video_recorder_frame_t const * frame) {
+    graphics_system_t const * graphicsSystem = &frame->graphicsSystem;
+    if (recorder->format == VIDEO_RECORDER_FORMAT_PBM) {
+        size_t const pathLength = strlen(recorder->path);
+        snprintf(recorder->bitmapPath, pathLength + 24u, "%.*s_%06llu.pbm", (int)(pathLength - 4u), recorder->path,
+                 (unsigned long long)frame->number);
+        return display_write_bitmap(graphicsSystem, recorder->bitmapPath);
+    }
+    // A low resolution pixel covers 2x2 pixels of the video
+    uint8_t const shift = graphicsSystem->mode == GRAPHICS_SYSTEM_MODE_LOW_RESOLUTION ? 1u : 0u;
+    for (uint8_t y = 0; y < GRAPHICS_SYSTEM_HIGH_RESOLUTION_HEIGHT; y++) {
+        for (uint8_t x = 0; x < GRAPHICS_SYSTEM_HIGH_RESOLUTION_WIDTH; x++) {
+            uint8_t const color = graphics_system_pixel(graphicsSystem, x >> shift, y >> shift);
+            for (uint8_t component = 0; component < 3; component++) {
+                recorder->yCbCrFrame[component][y][x] = recorder->palette[color][component];
+            }
+        }
+    }
+    for (uint32_t repeat = 0u; repeat < frame->repeats; repeat++) {
+        if (fputs("FRAME\n", recorder->file) == EOF ||
+            fwrite(recorder->yCbCrFrame, 1, sizeof(recorder->yCbCrFrame), recorder->file) <
+                sizeof(recorder->yCbCrFrame)) {
+            printf("Could not write to file \"%s\"\n", recorder->path);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/// @brief Entry point of the writer thread
+/// @details Writes the recorded frames until it is signaled without a recorded frame
+/// @param data The recorder (see video_recorder_t)
+/// @return Always 0
+static int video_recorder_writer_thread(void * data) {
+    video_recorder_t * recorder = (video_recorder_t *)data;
+    video_recorder_frame_t * frame;
+    for (;;) {
+        SDL_SemWait(recorder->frameRecorded);
+        if (!video_recorder_pop(&recorder->recordedFrames, &frame)) {
+            return 0;
+        }
+        if (!recorder->failed && video_recorder_write_frame(recorder, frame)) {
+            recorder->failed = true;
+        }
+        video_recorder_push(&recorder->freeFrames, frame);
+    }
+}
@@ -0,0 +1,140 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file video_recorder.h
+ * @brief Declarations regarding the capture of the frames to a video file
+ * @details The emulation thread copies every changed frame into a frame of a pool and hands a pointer to it to a
+ * writer thread through a lock-free single-producer / single-consumer queue. The writer thread converts the frame and
+ * writes it to disk, then hands the frame back through a second queue. A frame that is the same as the previous one
+ * only increments the repeat count of the previous frame, so a static screen costs a comparison per frame. If the
+ * writer falls behind and the pool is empty, the new frame is recorded as a repeat of the previous one instead of
+ * waiting, so the capture never stalls the emulation.
+ *
+ * A .y4m file is a YUV4MPEG2 stream of 128x64 frames at 60 frames per second in full-range YCbCr 4:4:4 - low resolution
+ * pixels are doubled and repeated frames are written repeatedly. A .pbm path is the pattern of a sequence of binary
+ * portable bitmaps: every distinct frame is written to <path without .pbm>_<number of the frame>.pbm, the gaps between
+ * the numbers are the repeats.
+ */
+
+#ifndef CHIP8_VIDEO_RECORDER_H_
+#define CHIP8_VIDEO_RECORDER_H_
+
+#include "../../../external/SDL/include/SDL.h"
+#include "backend_pre_compiled_header.h"
+
+// This file is included in the test-suite that is written in c++ using the google-test framework
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../../core/src/graphics_system.h"
+
+/// The amount of frames of the pool (has to be a power of two)
+#define VIDEO_RECORDER_POOL_SIZE       (64)
+
+/// Size of a cache line - used to keep the producer and consumer owned indices apart
+#define VIDEO_RECORDER_CACHE_LINE_SIZE (64)
+
+/// @brief The file formats of the video recorder
+typedef enum {
+    /// A YUV4MPEG2 stream (.y4m)
+    VIDEO_RECORDER_FORMAT_Y4M = 0,
+    /// A sequence of binary portable bitmaps (.pbm)
+    VIDEO_RECORDER_FORMAT_PBM = 1
+} video_recorder_format;
+
+/// @brief A frame of the pool
+typedef struct {
+    /// The frame
+    graphics_system_t graphicsSystem;
+    /// The size of the planes that were copied into the frame the last time
+    size_t copiedSize;
+    /// The number of the first emulated frame that showed the frame
+    uint64_t number;
+    /// The amount of emulated frames that showed the frame
+    uint32_t repeats;
+} video_recorder_frame_t;
+
+/// @brief Models a lock-free single-producer / single-consumer queue of frames of the pool
+typedef struct {
+    /// The frames of the queue
+    video_recorder_frame_t * frames[VIDEO_RECORDER_POOL_SIZE];
+    /// The amount of frames that were pushed (written by the producer)
+    SDL_atomic_t head;
+    /// Padding to avoid false sharing between the producer and the consumer
+    uint8_t headPadding[VIDEO_RECORDER_CACHE_LINE_SIZE - sizeof(SDL_atomic_t)];
+    /// The amount of frames that were popped (written by the consumer)
+    SDL_atomic_t tail;
+    /// Padding to avoid false sharing with the following fields
+    uint8_t tailPadding[VIDEO_RECORDER_CACHE_LINE_SIZE - sizeof(SDL_atomic_t)];
+} video_recorder_queue_t;
+
+/// @brief Models the capture of the frames to a video file
+typedef struct {
+    /// The frames that are written by the writer thread
+    video_recorder_queue_t recordedFrames;
+    /// The frames that can be reused by the emulation thread
+    video_recorder_queue_t freeFrames;
+    /// Signaled once per recorded frame, and once more to stop the writer thread
+    SDL_sem * frameRecorded;
+    /// The writer thread
+    SDL_Thread * writerThread;
+    /// The frame that is recorded until the next changed frame (NULL before the first frame)
+    video_recorder_frame_t * currentFrame;
+    /// The amount of emulated frames that were recorded
+    uint64_t frames;
+    /// The amount of changed frames that were recorded as repeats because the writer thread was behind
+    uint64_t droppedFrames;
+    /// The format of the file
+    video_recorder_format format;
+    /// The path of the file
+    char const * path;
+    /// The video file (Y4M only)
+    FILE * file;
+    /// The path of the current bitmap (PBM only)
+    char * bitmapPath;
+    /// Set by the writer thread if a frame could not be written - the remaining frames are discarded
+    bool failed;
+    /// The colors of the pixels in YCbCr (Y4M only)
+    uint8_t palette[GRAPHICS_SYSTEM_COLOR_COUNT][3];
+    /// The planes of a frame in YCbCr (Y4M only)
+    uint8_t yCbCrFrame[3][GRAPHICS_SYSTEM_HIGH_RESOLUTION_HEIGHT][GRAPHICS_SYSTEM_HIGH_RESOLUTION_WIDTH];
+    /// The frames of the pool
+    video_recorder_frame_t pool[VIDEO_RECORDER_POOL_SIZE];
+} video_recorder_t;
+
+/// @brief Creates the video file and starts the writer thread
+/// @param recorder The recorder that is initialized
+/// @param path The path of the video file (.y4m or .pbm) - has to stay valid until the recorder is freed
+/// @return 0 if everything went well, -1 if an error occured
+int video_recorder_init(video_recorder_t * recorder, char const * path);
+
+/// @brief Records a frame (emulation thread only)
+/// @param recorder The recorder where the frame is recorded
+/// @param graphicsSystem The frame that is recorded
+void video_recorder_record_frame(video_recorder_t * recorder, graphics_system_t const * graphicsSystem);
+
+/// @brief Writes the remaining frames, stops the writer thread and closes the video file
+/// @details Reports the changed frames that were recorded as repeats, because the writer thread fell behind
+/// @param recorder The recorder that is freed
+/// @return 0 if every frame was written, -1 if an error occured
+int video_recorder_free(video_recorder_t * recorder);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -20,688 +20,477 @@
 
 #include "virtual_machine.h"
 
-#if defined(PRINT_BYTE_CODE) || defined(TRACE_EXECUTION)
-#include "debug.h"
-#endif
 #include "../../base/src/chip8.h"
 #include "../../base/src/logger.h"
+#include "../../base/src/memory.h"
 #include "display.h"
-#include "keyboard_state.h"
+#include "keyboard.h"
 
-/// Defines a new 8-bit value based on the opcode that is currently executed
-#define DEFINE_8_BIT_VALUE  uint8_t value = vm->currentOpcode & 0x00ff;
+/// The minimum amount of instructions a key stays pressed, so that a quick tap is never lost
+#define CHIP8_MINIMUM_KEY_PRESS (CHIP8_INSTRUCTIONS_PER_FRAME)
 
-/// Defines a new 12-bit value based on the opcode that is currently executed
-#define DEFINE_12_BIT_VALUE uint16_t value = vm->currentOpcode & 0x0fff;
+/// The maximum amount of frames the emulation falls behind the host before it resynchronizes instead of catching up
+#define VIRTUAL_MACHINE_MAX_CATCH_UP_FRAMES (4u)
 
-/// Defines a new 4-bit value based on the opcode that is currently executed
-#define DEFINE_X            uint8_t x = (vm->currentOpcode & 0x0f00u) >> 8;
+/// @brief The arguments of the emulation thread
+typedef struct {
+    /// The virtual machine that is executed
+    virtual_machine_t * vm;
+    /// Options that configure the execution
+    virtual_machine_execution_options_t const * options;
+} virtual_machine_emulation_t;
 
-/// Defines a new 4-bit value based on the opcode that is currently executed
-#define DEFINE_Y            uint8_t y = (vm->currentOpcode & 0x00f0u) >> 4;
+/// @brief Relates the emulated instructions to the time of the host, so key events can be placed at instructions
+typedef struct {
+    /// Value of the performance counter at the start of the current frame
+    uint64_t frameStart;
+    /// The amount of instructions that were executed at the start of the current frame
+    uint64_t frameCycle;
+    /// The amount of ticks of the performance counter per frame
+    uint64_t ticksPerFrame;
+} virtual_machine_clock_t;
 
-/// The clock speed of the CHIP-8 CPU (600 Hz)
-#define CHIP8_CLOCK_SPEED   (600.0)
+static bool virtual_machine_apply_input(virtual_machine_t *, virtual_machine_execution_options_t const *);
+static void virtual_machine_emulate(virtual_machine_t *, virtual_machine_execution_options_t const *);
+static virtual_machine_stop_reason virtual_machine_emulate_frame(virtual_machine_t *,
+                                                                 virtual_machine_execution_options_t const *,
+                                                                 virtual_machine_clock_t const *);
+static int virtual_machine_emulation_thread(void *);
+static void virtual_machine_flush_input(virtual_machine_t *);
+static void virtual_machine_measure_key_read(void *, uint8_t);
+static void virtual_machine_queue_input(virtual_machine_t *, input_event_t const *);
+static void virtual_machine_run_ahead(virtual_machine_t *, virtual_machine_execution_options_t const *,
+                                      virtual_machine_clock_t const *, virtual_machine_state_t *);
+static void virtual_machine_schedule_input(virtual_machine_t *, virtual_machine_execution_options_t const *,
+                                           virtual_machine_clock_t const *);
+static void virtual_machine_serve_frame(virtual_machine_t *, virtual_machine_execution_options_t const *);
+static inline uint64_t virtual_machine_stop_cycle(virtual_machine_t const *,
+                                                  virtual_machine_execution_options_t const *);
+static void virtual_machine_take_screenshot(virtual_machine_t const *, char const *);
 
-/// The character sprites that are stored in memory (from 0x)
-#define CHARACTER_SPRITES                                                                                           \
-    ("\xF0\x90\x90\x90\xF0\x20\x60\x20\x20\x70\xF0\x10\xF0\x80\xF0\xF0\x10\xF0\x10\xF0\x90\x90\xF0\x10\x10\xF0\x80" \
-     "\xF0\x10\xF0\xF0\x80\xF0\x90\xF0\xF0\x10\x20\x40\x40\xF0\x90\xF0\x90\xF0\xF0\x90\xF0\x10\xF0\xF0\x90\xF0\x90" \
-     "\x90\xE0\x90\xE0\x90\xE0\xF0\x80\x80\x80\xF0\xE0\x90\x90\x90\xE0\xF0\x80\xF0\x80\xF0\xF0\x80\xF0\x80\x80")
-
-static int8_t virtual_machine_execute_next_opcode(virtual_machine_t *, keyBoardState_t);
-static inline void virtual_machine_place_character_sprites_in_memory(virtual_machine_t *);
+/// The names of the reasons the execution of a program ended
+static char const * const virtual_machine_stop_reason_names[] = {
+    "stopped",   "exited",   "unknown opcode", "replay ended", "instruction limit", "time limit",
+    "halt loop", "key wait", "static frame"};
 
 /// @brief Executes the program that is stored in memory
+/// @details Unless the display is offscreen the program is executed by a dedicated emulation thread, while the calling
+/// thread, which owns the window, polls the SDL events, hands the key events to the emulation thread and presents the
+/// published frames. The call returns once the execution has ended
 /// @param vm The chip8 vm where the program that is currently held in memory is executed
-void virtual_machine_execute(virtual_machine_t * vm) {
-    clock_t last_t, current_t = clock();
-    uint64_t numberofChip8Clocks = 0;
+/// @param options Options that configure the execution
+void virtual_machine_execute(virtual_machine_t * vm, virtual_machine_execution_options_t const * options) {
+    SDL_AtomicSet(&vm->running, 1);
+    if (vm->display.latency) {
+        // The latency of a key event ends once the program reads the key
+        vm->core.keyRead = virtual_machine_measure_key_read;
+        vm->core.keyReadContext = vm;
+    }
+    if (vm->display.flags & DISPLAY_FLAG_OFFSCREEN) {
+        // There are no events to poll
+        virtual_machine_emulate(vm, options);
+        return;
+    }
+    virtual_machine_emulation_t emulation = {vm, options};
+    SDL_Thread * emulationThread = SDL_CreateThread(virtual_machine_emulation_thread, "CHIP-8 Emulation", &emulation);
+    if (!emulationThread) {
+        printf("Emulation thread could not be created! SDL Error: %s\n", SDL_GetError());
+        return;
+    }
+    bool const replaying = options->inputLog && options->inputLog->replaying;
+    vm->overflowKeys = 0u;
+    vm->lostInputEvents = 0u;
     SDL_Event event;
-    keyBoardState_t keyBoardState = 0;
-    double secondsElapsed;
-    for (; vm->programCounter < ((0x1000 - PROGRAM_START_LOCATION) / 2); vm->programCounter++, numberofChip8Clocks++) {
-        last_t = current_t;
-        // Polling SDL events
-        while (SDL_PollEvent(&event)) {
+    while (SDL_AtomicGet(&vm->running)) {
+        virtual_machine_flush_input(vm);
+        // Without a new frame the loop waits for events, but only briefly, so the next frame is presented in time and
+        // the loop notices when the emulation thread has finished. With vsync the present waits for the vertical blank
+        if (display_present_frame(&vm->display) ? !SDL_PollEvent(&event) : !SDL_WaitEventTimeout(&event, 1)) {
+            continue;
+        }
+        do {
             switch (event.type) {
             case SDL_QUIT:
-                return;
-            case SDL_KEYDOWN:
-                keyboard_handle_key_down_event(event, &keyBoardState);
+                SDL_AtomicSet(&vm->running, 0);
                 break;
+            case SDL_KEYDOWN:
             case SDL_KEYUP:
-                keyboard_handle_key_up_event(event, &keyBoardState);
-                break;
+                {
+                    keyBoardState_t keyCode = keyboard_key_code(event.key.keysym.scancode);
+                    // Repeated key down events do not change the state of the keyboard
+                    if (keyCode && !event.key.repeat && !replaying) {
+                        input_event_t inputEvent = {SDL_GetPerformanceCounter(), keyCode, event.type == SDL_KEYDOWN};
+                        virtual_machine_queue_input(vm, &inputEvent);
+                    }
+                    break;
+                }
             default:
                 break;
             }
-        }
-#ifdef TRACE_EXECUTION
-        debug_trace_execution(*vm);
-#endif
-        vm->currentOpcode = (uint16_t)vm->memory[vm->programCounter * 2 + 1 + PROGRAM_START_LOCATION];
-        vm->currentOpcode += vm->memory[vm->programCounter * 2 + PROGRAM_START_LOCATION] << 8;
-        // Reached end of the program
-        if (!vm->currentOpcode) {
-            return;
-        }
-        // Executes next opcode
-        if (virtual_machine_execute_next_opcode(vm, keyBoardState)) {
-            return;
-        }
-        // 60 hz
-        if (!(numberofChip8Clocks % 10)) {
-            if (vm->delayTimer) {
-                vm->delayTimer--;
-            }
-            if (vm->soundTimer) {
-                putc('\a', stdout);
-                vm->soundTimer--;
-            }
-            display_render(vm->display);
-        }
-        // Wait for a 1/600 second minus the time elapsed
-        current_t = clock();
-        secondsElapsed = (double)(current_t - last_t);
-        if (1.0 / CHIP8_CLOCK_SPEED > secondsElapsed) {
-            // Lets pretend SDL_Delay does not exist
-#if defined(OS_WINDOWS)
-            // Milliseconds -> multiply with 1000
-            Sleep((1.0 / CHIP8_CLOCK_SPEED - secondsElapsed) * 1000.0);
-#elif defined(OS_UNIX_LIKE)
-            // Mircoseconds -> multiply with 1000000
-            usleep((1.0 / CHIP8_CLOCK_SPEED - secondsElapsed) * 10000000.0);
-#endif
-        }
+        } while (SDL_PollEvent(&event));
+    }
+    SDL_WaitThread(emulationThread, NULL);
+    if (vm->lostInputEvents) {
+        printf("%llu key events were lost, because the emulation did not keep up with the input\n",
+               (unsigned long long)vm->lostInputEvents);
     }
 }
 
 /// @brief Initializes the chip8 vm
 /// @param vm The chip8 virtual machine that is initialzed
-void virtual_machine_init(virtual_machine_t * vm) {
-    uint8_t * upperBound = (vm->V + 16u);
-    for (uint8_t * memoryPointer = vm->V; memoryPointer < upperBound; memoryPointer++) {
-        *memoryPointer = 0u;
-    }
-    // Initialize stackpointer
-    vm->stackPointer = vm->stack;
-    // Initialize program counter
-    vm->programCounter = 0u;
-    // Compute upper bound for memory loop
-    upperBound = (vm->memory + 4096u);
-    // Initialize memory
-    for (uint8_t * memoryPointer = vm->memory; memoryPointer < upperBound; memoryPointer++) {
-        *memoryPointer = 0u;
+/// @param mode The mode of the virtual machine
+/// @return 0 if everything went well, -1 if the memory could not be allocated
+int virtual_machine_init(virtual_machine_t * vm, virtual_machine_mode mode) {
+    input_queue_init(&vm->inputQueue);
+    vm->overflowKeys = 0u;
+    vm->overflowKeyStates = 0u;
+    vm->lostInputEvents = 0u;
+    vm->nextInputCycle = UINT64_MAX;
+    memset(vm->keyPressCycles, 0, sizeof(vm->keyPressCycles));
+    SDL_AtomicSet(&vm->running, 0);
+    vm->runningAhead = false;
+    vm->stopReason = VIRTUAL_MACHINE_STOP_NONE;
+    // The display presents the framebuffer of the core
+    vm->display.graphicsSystem = &vm->core.graphicsSystem;
+    if (virtual_machine_core_init(&vm->core, mode)) {
+        printf("Could not allocate memory for the virtual machine\n");
+        return -1;
     }
-    // Setting up Hex character sprites in memory
-    virtual_machine_place_character_sprites_in_memory(vm);
+    return 0;
 }
 
-/// @brief Writtes the specified opcode at the specified location into memory
-/// @param vm The chip8 where the opcode is written to memory
-/// @param memoryLocation The location where the opcode is written to (0-4096)
-/// @param opcode The opcode that is written into memory
-void virtual_machine_write_opcode_to_memory(virtual_machine_t * vm, uint16_t * memoryLocation, uint16_t opcode) {
-    if (*memoryLocation > 0x1000u || *memoryLocation < PROGRAM_START_LOCATION) {
-        return;
-    }
-#ifdef PRINT_BYTE_CODE
-    debug_print_bytecode(*memoryLocation, opcode);
-#endif
-    vm->memory[(*memoryLocation)++] = (opcode & 0xff00) >> 8;
-    vm->memory[(*memoryLocation)++] = opcode & 0x00ff;
+/// @brief Frees the memory of the chip8 vm
+/// @param vm The chip8 virtual machine whose memory is freed
+void virtual_machine_free(virtual_machine_t * vm) {
+    virtual_machine_core_free(&vm->core);
 }
 
-/// @brief Writtes the specified opcode at the specified location into memory
-/// @param vm The chip8 where the opcode is written to memory
-/// @param memoryLocation The location where the opcode is written to (0-4096)
-/// @param byte The byte that is written into memory
-void virtual_machine_write_byte_to_memory(virtual_machine_t * vm, uint16_t * memoryLocation, uint8_t byte) {
-    if (*memoryLocation > 0x1000u || *memoryLocation < PROGRAM_START_LOCATION) {
-        return;
+/// @brief Determines the name of a reason the execution of a program ended
+/// @param reason The reason the execution ended
+/// @return The name of the reason ("unknown" if the reason is out of range)
+char const * virtual_machine_stop_reason_name(virtual_machine_stop_reason reason) {
+    if ((size_t)reason >= sizeof(virtual_machine_stop_reason_names) / sizeof(*virtual_machine_stop_reason_names)) {
+        return "unknown";
     }
-    vm->memory[(*memoryLocation)++] = byte;
+    return virtual_machine_stop_reason_names[reason];
 }
 
-/// @brief Places sprites for characters in memory
-/// @param vm The virtual machine where the sprites are placed in memory
-static inline void virtual_machine_place_character_sprites_in_memory(virtual_machine_t * vm) {
-    memcpy(vm->memory + 0x50, CHARACTER_SPRITES, 80);
+/// @brief Applies the key event that is due
+/// @param vm The chip8 virtual machine where the key event is applied
+/// @param options Options that configure the execution
+/// @return true if a replayed session has ended, false if not
+static bool virtual_machine_apply_input(virtual_machine_t * vm, virtual_machine_execution_options_t const * options) {
+    if (options->inputLog && options->inputLog->replaying) {
+        return input_log_replay(options->inputLog, vm->core.cycles, &vm->core.keyBoardState);
+    }
+    keyboard_apply(&vm->core.keyBoardState, vm->nextInput.keyCode, vm->nextInput.pressed);
+    uint8_t const keyIndex = keyboard_key_index(vm->nextInput.keyCode);
+    if (vm->nextInput.pressed) {
+        vm->keyPressCycles[keyIndex] = vm->core.cycles;
+    }
+    if (vm->display.latency) {
+        input_latency_stamp(vm->display.latency, keyIndex, vm->nextInput.timestamp);
+    }
+    if (options->inputLog) {
+        input_log_record(options->inputLog, vm->core.cycles, vm->core.keyBoardState);
+    }
+    vm->nextInputCycle = UINT64_MAX;
+    return false;
 }
 
-/// Executes the next opcode in memory
-/// @param vm The chip8 virtual machine where the next opcode is executed
-/// @return 0 if the opcode was executed properly, -1 if not
-static int8_t virtual_machine_execute_next_opcode(virtual_machine_t * vm, uint16_t keyBoardState) {
-    switch (vm->currentOpcode & 0xf000) {
-    case 0x0000:
-        {
-            switch (vm->currentOpcode & 0x0fff) {
-            case 0x001: // 0x0001 - NOP
-                break;
-            case 0x002: // 0x0002 - EXT
-                exit(0);
-                break;
-            case 0x0E0: // 0x00E0 - Clear the screen
-                {
-                    for (uint8_t x = 0; x < GRAPHICS_SYSTEM_WIDTH; x++) {
-                        for (uint8_t y = 0; y < GRAPHICS_SYSTEM_HEIGHT; y++) {
-                            vm->display.graphicsSystem[x][y] = 0;
-                        }
-                    }
-                    break;
-                }
-            case 0x0E1: // 0x00E1 - Toggle the pixels on the screen
-                {
-                    for (uint8_t x = 0; x < GRAPHICS_SYSTEM_WIDTH; x++) {
-                        for (uint8_t y = 0; y < GRAPHICS_SYSTEM_HEIGHT; y++) {
-                            vm->display.graphicsSystem[x][y] = !vm->display.graphicsSystem[x][y];
-                        }
-                    }
-                    break;
-                }
-            case 0x0EE: // 0x00EE - return from subroutine
-                vm->programCounter = *--vm->stackPointer;
-                break;
-            default:
-                goto chip8_error;
-            }
-            break;
+/// @brief Executes the program until it has ended, the maximum amount of instructions or the time limit is reached, an
+/// offscreen program is idle or the execution is stopped
+/// @details The instructions are executed in batches of one frame. After each batch the finished frame is published to
+/// the thread that owns the window, so the emulation never waits for the presentation of a frame. If the emulation
+/// falls behind the host, the following frames are emulated right away to catch up, so the instructions and timers keep
+/// running at real time. An offscreen display is not paced, the program is executed as fast as possible. The frame
+/// boundaries are derived from the amount of executed instructions, so an execution that is stopped and resumed behaves
+/// exactly like one that was not interrupted. Key events are applied before the instruction that corresponds to the
+/// time they were received. The time limit and the idle detection are checked at the end of every frame. The reason the
+/// execution ended is stored in the virtual machine
+/// @param vm The chip8 vm where the program that is currently held in memory is executed
+/// @param options Options that configure the execution
+static void virtual_machine_emulate(virtual_machine_t * vm, virtual_machine_execution_options_t const * options) {
+    bool const offscreen = vm->display.flags & DISPLAY_FLAG_OFFSCREEN;
+    // Frames are only run ahead if they are presented
+    virtual_machine_state_t * savedState = NULL;
+    if (options->runAheadFrames && !offscreen) {
+        savedState = new (virtual_machine_state_t);
+        if (!savedState) {
+            printf("Could not allocate memory for the run-ahead state - frames are not run ahead\n");
         }
-    case 0x1000: // 0x1NNN - Jumps to address NNN
-        {
-            vm->programCounter = (((vm->currentOpcode & 0x0fff) - PROGRAM_START_LOCATION) / 2) - 1;
-            break;
+    }
+    // Only programs without a window are stopped when they are idle
+    idle_detector_t * idleDetector = NULL;
+    if (options->idleFrames && offscreen) {
+        idleDetector = new (idle_detector_t);
+        if (!idleDetector) {
+            printf("Could not allocate memory for the idle detection - idle programs are not stopped\n");
+        } else {
+            idle_detector_init(idleDetector, options->idleFrames, &vm->core.graphicsSystem);
         }
-    case 0x2000: // 0x2NNN - Calls subroutine at NNN
-        {
-            DEFINE_12_BIT_VALUE
-            *vm->stackPointer++ = vm->programCounter;
-            vm->programCounter = value;
-            break;
+    }
+    virtual_machine_clock_t clock;
+    clock.ticksPerFrame = SDL_GetPerformanceFrequency() / CHIP8_TIMER_FREQUENCY;
+    clock.frameStart = SDL_GetPerformanceCounter();
+    uint64_t nextFrame = clock.frameStart + clock.ticksPerFrame;
+    uint64_t const deadline =
+        options->timeLimit ? clock.frameStart + options->timeLimit * SDL_GetPerformanceFrequency() / 1000u : 0u;
+    vm->stopReason = VIRTUAL_MACHINE_STOP_NONE;
+    while (SDL_AtomicGet(&vm->running)) {
+        clock.frameCycle = vm->core.cycles;
+        if (vm->nextInputCycle == UINT64_MAX) {
+            virtual_machine_schedule_input(vm, options, &clock);
         }
-    case 0x3000: // 0x3XNN - Skips the next instruction if VX equals NN. Usually the next instruction is a jump to skip
-                 // a code block
-        {
-            DEFINE_8_BIT_VALUE
-            DEFINE_X
-            if (vm->V[x] == value) {
-                vm->programCounter++;
-            }
-            break;
+        vm->stopReason = virtual_machine_emulate_frame(vm, options, &clock);
+        if (options->videoRecorder) {
+            video_recorder_record_frame(options->videoRecorder, &vm->core.graphicsSystem);
         }
-    case 0x4000: // 0x4XNN - Skips the next instruction if VX does not equal NN. Usually the next instruction is a jump
-                 // to skip a code block
-        {
-            DEFINE_8_BIT_VALUE
-            DEFINE_X
-            if (vm->V[x] != value) {
-                vm->programCounter++;
-            }
-            break;
+        if (options->frameExport) {
+            frame_export_publish(options->frameExport, &vm->core.graphicsSystem);
         }
-    case 0x5000: // 0x5XY0 - Skips the next instruction if VX equals VY. (Usually the next instruction is a jump to skip
-                 // a code block)
-        {
-            if (vm->currentOpcode & 0x000f) {
-                goto chip8_error;
-            }
-            DEFINE_X
-            DEFINE_Y
-            if (vm->V[x] == vm->V[y]) {
-                vm->programCounter++;
+        if (options->frameServer) {
+            virtual_machine_serve_frame(vm, options);
+        }
+        if (!vm->stopReason && idleDetector) {
+            if (idle_detector_halted(&vm->core)) {
+                vm->stopReason = VIRTUAL_MACHINE_STOP_HALT_LOOP;
+            } else if (idle_detector_record_frame(idleDetector, &vm->core.graphicsSystem)) {
+                vm->stopReason = VIRTUAL_MACHINE_STOP_STATIC_FRAME;
             }
-            break;
         }
-    case 0x6000: // 0x6XNN - Sets VX to NN
-        {
-            DEFINE_8_BIT_VALUE
-            DEFINE_X
-            vm->V[x] = value;
-            break;
+        if (!vm->stopReason && deadline && SDL_GetPerformanceCounter() >= deadline) {
+            vm->stopReason = VIRTUAL_MACHINE_STOP_TIME_LIMIT;
         }
-    case 0x7000: // 0x7XNN - Adds NN to VX. (Carry flag is not changed)
-        {
-            DEFINE_8_BIT_VALUE
-            DEFINE_X
-            vm->V[x] += value;
+        if (vm->stopReason) {
+            display_publish_frame(&vm->display);
             break;
         }
-    case 0x8000:
-        switch (vm->currentOpcode & 0x000f) {
-        case 0x0: // 0x8XY0 - Sets VX to the value of VY
-            {
-                DEFINE_X
-                DEFINE_Y
-                vm->V[x] = vm->V[y];
-                break;
-            }
-        case 0x1: // 0x8XY1 - Sets VX to the value of VX or VY
-            {
-                DEFINE_X
-                DEFINE_Y
-                vm->V[x] |= vm->V[y];
-                break;
-            }
-        case 0x2: // 0x8XY2 - Sets VX to the value of VX and VY
-            {
-                DEFINE_X
-                DEFINE_Y
-                vm->V[x] &= vm->V[y];
-                break;
-            }
-        case 0x3: // 0x8XY3 - Sets VX to the value of VX xor VY
-            {
-                DEFINE_X
-                DEFINE_Y
-                vm->V[x] ^= vm->V[y];
-                break;
-            }
-        case 0x4: // 0x8XY4 - Adds VY to VX. VF is set to 1 when there's a carry, and to 0 when there is not.
-            {
-                DEFINE_X
-                DEFINE_Y
-                uint8_t result = vm->V[x] + vm->V[y];
-                if (result > (result - vm->V[x])) {
-                    vm->V[0xf] = 0x1u;
-                }
-                vm->V[x] = result;
-                break;
-            }
-        case 0x5: // 0x8XY5 - VY is subtracted from VX. VF is set to 0 when there's a borrow, and 1 when there is not.
-            {
-                DEFINE_X
-                DEFINE_Y
-                uint8_t result = vm->V[x] - vm->V[y];
-                if (result < (result - vm->V[x])) {
-                    vm->V[0xf] = 0x1u;
-                }
-                vm->V[x] = result;
-                break;
-            }
-        case 0x6: // 0x8XY6 - Stores the least significant bit of VX in VF and then shifts VX to the right by 1
-            {
-                DEFINE_X
-                vm->V[0xf] = vm->V[x] & 0x0001;
-                vm->V[x] >>= 1;
-                break;
-            }
-        case 0x7: // 0x8XY7 - Sets VX to VY minus VX. VF is set to 0 when there's a borrow, and 1 when there is not.
-            {
-                DEFINE_X
-                DEFINE_Y
-                uint8_t result = vm->V[y] - vm->V[x];
-                if (result > (result - vm->V[x])) {
-                    vm->V[0xf] = 0x1u;
-                }
-                vm->V[x] = result;
-                break;
-            }
-        case 0xe: // 0x8XYe - Stores the most significant bit of VX in VF and then shifts VX to the left by 1
-            {
-                DEFINE_X
-                vm->V[0xf] = vm->V[x] & 0x0001;
-                vm->V[x] <<= 1;
-                break;
-            }
-        default:
-            goto chip8_error;
+        if (offscreen) {
+            display_publish_frame(&vm->display);
+            continue;
         }
-        break;
-    case 0x9000: // 0x9XY0 - Skips the next instruction if VX does not equal VY. Usually the next instruction is a jump
-                 // to skip a code block
-        {
-            if (vm->currentOpcode & 0x000f) {
-                goto chip8_error;
-            }
-            DEFINE_X
-            DEFINE_Y
-            if (vm->V[x] == vm->V[y]) {
-                vm->programCounter++;
-            }
-            break;
+        if (savedState) {
+            virtual_machine_run_ahead(vm, options, &clock, savedState);
+        } else {
+            display_publish_frame(&vm->display);
         }
-    case 0xa000: // 0xANNN - Sets I to the address NNN.
-        {
-            vm->I = vm->currentOpcode & 0x0fff;
-            break;
+        // Wait until the next frame is due
+        uint64_t now = SDL_GetPerformanceCounter();
+        if (now < nextFrame) {
+            SDL_Delay((uint32_t)((nextFrame - now) * 1000u / SDL_GetPerformanceFrequency()));
+            clock.frameStart = nextFrame;
+            nextFrame += clock.ticksPerFrame;
+        } else if (now - nextFrame < VIRTUAL_MACHINE_MAX_CATCH_UP_FRAMES * clock.ticksPerFrame) {
+            // We are running behind - the next frame is emulated right away to catch up with the time of the host
+            clock.frameStart = nextFrame;
+            nextFrame += clock.ticksPerFrame;
+        } else {
+            // Too far behind to catch up - resynchronize instead
+            clock.frameStart = now;
+            nextFrame = now + clock.ticksPerFrame;
         }
-    case 0xb000: // 0xBNNN - Jumps to the address NNN plus V0
-        {
-            vm->programCounter = (vm->currentOpcode & 0x0fff + vm->V[0] / 2);
-            break;
+    }
+    free(savedState);
+    free(idleDetector);
+}
+
+/// @brief Executes the instructions of one frame and updates the timers at the end of the frame
+/// @details The core executes the instructions until the frame is complete. It returns earlier if a key event is due,
+/// the maximum amount of instructions is reached or a screenshot is taken, so all of them happen at the instruction
+/// they belong to. Key events are not applied while frames are run ahead, the keyboard keeps its current state
+/// @param vm The chip8 vm where the program that is currently held in memory is executed
+/// @param options Options that configure the execution
+/// @param clock Relates the instructions of the frame to the time of the host
+/// @return The reason the execution has ended during the frame (VIRTUAL_MACHINE_STOP_NONE if it continues)
+static virtual_machine_stop_reason virtual_machine_emulate_frame(virtual_machine_t * vm,
+                                                                 virtual_machine_execution_options_t const * options,
+                                                                 virtual_machine_clock_t const * clock) {
+    // An idle offscreen program that waits for a key is stopped, unless a replayed session or a viewer may still press
+    // one
+    bool const keyWaitEnds = options->idleFrames && (vm->display.flags & DISPLAY_FLAG_OFFSCREEN) &&
+                             !(options->inputLog && options->inputLog->replaying) && !options->frameServer;
+    for (;;) {
+        // Applies the key events that are due before the next instruction
+        while (!vm->runningAhead && vm->core.cycles >= vm->nextInputCycle) {
+            if (virtual_machine_apply_input(vm, options)) {
+                return VIRTUAL_MACHINE_STOP_REPLAY_ENDED;
+            }
+            virtual_machine_schedule_input(vm, options, clock);
         }
-    case 0xc000: // 0xCXNN - Sets VX to the result of a bitwise and operation on a random number (Typically: 0 to 255)
-                 // and NN.
-        {
-            DEFINE_8_BIT_VALUE
-            DEFINE_X
-            vm->V[x] = (rand() & 255) & value;
-            break;
+        // Reached the maximum amount of instructions
+        if (options->maximumCycles && vm->core.cycles >= options->maximumCycles) {
+            return VIRTUAL_MACHINE_STOP_CYCLE_LIMIT;
         }
-    case 0xd000: /* 0xDXYN - Draws a sprite at coordinate (VX, VY)
-                  * that has a width of 8 pixels and a height of N pixels.
-                  * Each row of 8 pixels is read as bit-coded starting from memory location I;
-                  * I value does not change after the execution of this instruction.
-                  * As described above, VF is set to 1 if any screen pixels are flipped from set to unset when the
-                  * sprite is drawn, and to 0 if that does not happen
-                  */
-        {
-            DEFINE_X
-            DEFINE_Y
-            uint8_t spriteHeight = vm->currentOpcode & 0x000f;
-            bool setVF = false;
-            // Stays zero if no screen pixels are flipped from set to unset
-            vm->V[0xf] = 0;
-            for (size_t height = 0; height < spriteHeight; height++) {
-                for (size_t width = 0; width < 8; width++) {
-                    if ((vm->memory[(vm->I + height) & 4095] >> (8 - width)) & 0x01) {
-                        if (!setVF && vm->display.graphicsSystem[width + vm->V[x] & (GRAPHICS_SYSTEM_WIDTH - 1)]
-                                                                [height + vm->V[y] & (GRAPHICS_SYSTEM_HEIGHT - 1)]) {
-                            vm->V[0xf] = 1;
-                            setVF = true;
-                        }
-                        vm->display.graphicsSystem[width + vm->V[x] & (GRAPHICS_SYSTEM_WIDTH - 1)]
-                                                  [height + vm->V[y] & (GRAPHICS_SYSTEM_HEIGHT - 1)] =
-                            !vm->display.graphicsSystem[width + vm->V[x] & (GRAPHICS_SYSTEM_WIDTH - 1)]
-                                                       [height + vm->V[y] & (GRAPHICS_SYSTEM_HEIGHT - 1)];
-                    }
-                }
-            }
-            break;
+        uint64_t const cycles = vm->core.cycles;
+        int8_t const result = virtual_machine_core_run(&vm->core, virtual_machine_stop_cycle(vm, options));
+        if (options->screenshotPath && !vm->runningAhead && vm->core.cycles != cycles &&
+            vm->core.cycles == options->screenshotCycle) {
+            virtual_machine_take_screenshot(vm, options->screenshotPath);
         }
-    case 0xe000:
-        {
-            switch (vm->currentOpcode & 0x00ff) {
-            case 0x9e: // 0xEX9E - Skips the next instruction if the key stored in VX is pressed. (Usually the next
-                       // instruction is a jump to skip a code block)
-                {
-                    DEFINE_X
-                    switch (vm->V[x]) {
-                    case 0x0:
-                        if (keyBoardState & CHIP8_KEY_CODE_0) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0x1:
-                        if (keyBoardState & CHIP8_KEY_CODE_1) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0x2:
-                        if (keyBoardState & CHIP8_KEY_CODE_2) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0x3:
-                        if (keyBoardState & CHIP8_KEY_CODE_3) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0x4:
-                        if (keyBoardState & CHIP8_KEY_CODE_4) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0x5:
-                        if (keyBoardState & CHIP8_KEY_CODE_5) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0x6:
-                        if (keyBoardState & CHIP8_KEY_CODE_6) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0x7:
-                        if (keyBoardState & CHIP8_KEY_CODE_7) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0x8:
-                        if (keyBoardState & CHIP8_KEY_CODE_8) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0x9:
-                        if (keyBoardState & CHIP8_KEY_CODE_9) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0xA:
-                        if (keyBoardState & CHIP8_KEY_CODE_A) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0xB:
-                        if (keyBoardState & CHIP8_KEY_CODE_B) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0xC:
-                        if (keyBoardState & CHIP8_KEY_CODE_C) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0xD:
-                        if (keyBoardState & CHIP8_KEY_CODE_D) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0xE:
-                        if (keyBoardState & CHIP8_KEY_CODE_E) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0xF:
-                        if (keyBoardState & CHIP8_KEY_CODE_F) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    default:
-                        break;
-                    }
-                    break;
-                }
-            case 0xa1: // 0xEXA1 - Skips the next instruction if the key stored in VX is not pressed. (Usually the next
-                       // instruction is a jump to skip a code block)
-                {
-                    DEFINE_X
-                    switch (vm->V[x]) {
-                    case 0x0:
-                        if (!(keyBoardState & CHIP8_KEY_CODE_0)) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0x1:
-                        if (!(keyBoardState & CHIP8_KEY_CODE_1)) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0x2:
-                        if (!(keyBoardState & CHIP8_KEY_CODE_2)) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0x3:
-                        if (!(keyBoardState & CHIP8_KEY_CODE_3)) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0x4:
-                        if (!(keyBoardState & CHIP8_KEY_CODE_4)) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0x5:
-                        if (!(keyBoardState & CHIP8_KEY_CODE_5)) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0x6:
-                        if (!(keyBoardState & CHIP8_KEY_CODE_6)) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0x7:
-                        if (!(keyBoardState & CHIP8_KEY_CODE_7)) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0x8:
-                        if (!(keyBoardState & CHIP8_KEY_CODE_8)) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0x9:
-                        if (!(keyBoardState & CHIP8_KEY_CODE_9)) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0xA:
-                        if (!(keyBoardState & CHIP8_KEY_CODE_A)) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0xB:
-                        if (!(keyBoardState & CHIP8_KEY_CODE_B)) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0xC:
-                        if (!(keyBoardState & CHIP8_KEY_CODE_C)) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0xD:
-                        if (!(keyBoardState & CHIP8_KEY_CODE_D)) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0xE:
-                        if (!(keyBoardState & CHIP8_KEY_CODE_E)) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    case 0xF:
-                        if (!(keyBoardState & CHIP8_KEY_CODE_F)) {
-                            vm->programCounter++;
-                        }
-                        break;
-                    default:
-                        break;
-                    }
-                    break;
-                }
-            default:
-                goto chip8_error;
-            }
-            break;
+        if (result == VIRTUAL_MACHINE_CORE_EXITED) {
+            return VIRTUAL_MACHINE_STOP_EXITED;
+        } else if (result == VIRTUAL_MACHINE_CORE_ERROR) {
+            return VIRTUAL_MACHINE_STOP_ERROR;
+        } else if (result == VIRTUAL_MACHINE_CORE_FRAME_COMPLETE) {
+            return VIRTUAL_MACHINE_STOP_NONE;
+        } else if (result == VIRTUAL_MACHINE_CORE_WAITING_FOR_KEY && keyWaitEnds) {
+            return VIRTUAL_MACHINE_STOP_KEY_WAIT;
         }
-    case 0xf000:
-        {
-            switch (vm->currentOpcode & 0x00ff) {
-            case 0x00: // 0xFX00 - Prints the character stored in the register VX
-                {
-                    DEFINE_X
-                    putchar(vm->V[x]);
-                    // We need to flush the buffer to make sure the character is printed
-                    fflush(stdout);
-                    break;
-                }
-            case 0x7: // 0xFX07 - Sets VX to the value of the delay timer.
-                {
-                    DEFINE_X
-                    vm->V[x] = vm->delayTimer;
-                    break;
-                }
-            case 0xa: // 0xFX0A - A key press is awaited, and then stored in VX. (Blocking Operation. All instruction
-                      // halted until next key event)
-                {
-                    DEFINE_X
-                    vm->V[x] = getchar();
-                    break;
-                }
-            case 0x15: // 0xFX15 - Sets the delay timer to VX
-                {
-                    DEFINE_X
-                    vm->delayTimer = vm->V[x];
-                    break;
-                }
-            case 0x18: // 0xFX18 - Sets the sound timer to VX.
-                {
-                    DEFINE_X
-                    vm->soundTimer = vm->V[x];
-                    break;
-                }
-            case 0x1e: // 0xFX1E - Adds VX to I. VF is not affected
-                {
-                    DEFINE_X
-                    vm->I += vm->V[x];
-                    break;
-                }
-            case 0x29:
-                // 0xFX29 - Sets I to the location of the sprite for the character in VX. Characters
-                // are represented by a 4x5 font The characters are stored at the address 0x0050 and are 20 bit large (4
-                // by 5 bits)
-                {
-                    DEFINE_X
-                    if (vm->V[x] <= '9' && vm->V[x] >= '0') {
-                        vm->I = 0x0050 + 0x5 * (vm->V[x] - '0');
-                    } else if (vm->V[x] <= 'F' && vm->V[x] >= 'A') {
-                        vm->I = 0x0050 + 0x5 * (vm->V[x] - 0x37);
-                    } else {
-                        goto chip8_error;
-                    }
-                    break;
-                }
-            case 0x33: /* 0xFX33 - Stores the binary-coded decimal representation of VX,
-                        * with the most significant of three digits at the address in I,
-                        * the middle digit at I plus 1, and the least significant digit at I plus 2.
-                        * (In other words, take the decimal representation of VX, place the hundreds digit in memory at
-                        * location in I, the tens digit at location I+1, and the ones digit at location I+2.)
-                        */
-                {
-                    DEFINE_X
-                    uint8_t value = vm->V[x];
-                    uint8_t base = 100u;
-                    for (uint8_t i = 0u; base; i++, value %= base, base /= 10) {
-                        vm->memory[(vm->I + i) & 4095] = value / base;
-                    }
-                    break;
-                }
-            case 0x55: /* 0xFX55 - Stores from V0 to VX (including VX) in memory, starting at address I.
-                        * The offset from I is increased by 1 for each value written, but I itself is left unmodified
-                        */
-                {
-                    DEFINE_X
-                    for (uint8_t i = 0u; i <= x; i++) {
-                        vm->memory[(vm->I + i) & 4095] = vm->V[i];
-                    }
-                    break;
-                }
-            case 0x65: /* 0xFX65 - Fills from V0 to VX (including VX) with values from memory, starting at address I.
-                        * The offset from I is increased by 1 for each value read, but I itself is left unmodified
-                        */
-                {
-                    DEFINE_X
-                    for (uint8_t i = 0u; i <= x; i++) {
-                        vm->V[i] = vm->memory[(vm->I + i) & 4095];
-                    }
-                    break;
-                }
-            default:
-                goto chip8_error;
-            }
+    }
+}
+
+/// @brief Publishes the frame that the program would show a few frames in the future with the current keyboard state
+/// @details Many programs react to a key one or more frames after it was pressed. Presenting a future frame hides
+/// this lag. The state of the virtual machine is saved before and restored after the frames that are run ahead, so
+/// the actual execution is not affected by them
+/// @param vm The chip8 vm where the program that is currently held in memory is executed
+/// @param options Options that configure the execution (see runAheadFrames)
+/// @param clock Relates the instructions of the frame to the time of the host
+/// @param savedState Memory where the state of the virtual machine is saved while frames are run ahead
+static void virtual_machine_run_ahead(virtual_machine_t * vm, virtual_machine_execution_options_t const * options,
+                                      virtual_machine_clock_t const * clock, virtual_machine_state_t * savedState) {
+    virtual_machine_core_save_state(&vm->core, savedState);
+    vm->runningAhead = true;
+    vm->core.silent = true;
+    for (uint8_t frame = 0u; frame < options->runAheadFrames; frame++) {
+        if (virtual_machine_emulate_frame(vm, options, clock)) {
+            // The future frame is shown as far as the program has run
             break;
         }
-    default:
-        goto chip8_error;
     }
+    display_publish_frame(&vm->display);
+    vm->runningAhead = false;
+    vm->core.silent = false;
+    virtual_machine_core_restore_state(&vm->core, savedState);
+}
+
+/// @brief Entry point of the emulation thread
+/// @param data The virtual machine and the options of the execution (see virtual_machine_emulation_t)
+/// @return Always 0
+static int virtual_machine_emulation_thread(void * data) {
+    virtual_machine_emulation_t * emulation = (virtual_machine_emulation_t *)data;
+    virtual_machine_emulate(emulation->vm, emulation->options);
+    // Tells the thread that polls the events that the execution has ended
+    SDL_AtomicSet(&emulation->vm->running, 0);
     return 0;
+}
+
+/// @brief Queues the key events that did not fit into the full input queue
+/// @details Every key with an overflowing event gets one event with its latest state, so the keyboard of the emulation
+/// ends up in the same state as the keyboard of the host
+/// @param vm The chip8 virtual machine whose key events are queued
+static void virtual_machine_flush_input(virtual_machine_t * vm) {
+    while (vm->overflowKeys) {
+        keyBoardState_t const keyCode = vm->overflowKeys & (keyBoardState_t)-vm->overflowKeys;
+        input_event_t const inputEvent = {SDL_GetPerformanceCounter(), keyCode, (vm->overflowKeyStates & keyCode) != 0};
+        if (!input_queue_push(&vm->inputQueue, &inputEvent)) {
+            return;
+        }
+        vm->overflowKeys &= (keyBoardState_t)~keyCode;
+    }
+}
+
+/// @brief Records the latency of a key event once the program reads the key (see virtual_machine_key_read_t)
+/// @param context The chip8 virtual machine that reads the key
+/// @param keyIndex The index of the key that is read - values outside of the keyboard are ignored
+static void virtual_machine_measure_key_read(void * context, uint8_t keyIndex) {
+    virtual_machine_t * vm = (virtual_machine_t *)context;
+    if (keyIndex < INPUT_LATENCY_KEY_COUNT && vm->display.latency->pendingKeyReads[keyIndex]) {
+        input_latency_record(vm->display.latency, &vm->display.latency->keyRead,
+                             vm->display.latency->pendingKeyReads[keyIndex], SDL_GetPerformanceCounter());
+        vm->display.latency->pendingKeyReads[keyIndex] = 0u;
+    }
+}
 
-chip8_error:
-    printf("Unknown opcode: 0x%4X", vm->currentOpcode);
-    return -1;
+/// @brief Hands a key event of the host to the emulation thread
+/// @details If the input queue is full, the event is collapsed into the latest state of its key, which is queued by
+/// virtual_machine_flush_input once the emulation has made room. Events that are queued later wait for the collapsed
+/// ones, so the events of a key are never reordered. An event that is replaced by a later event of the same key is lost
+/// @param vm The chip8 virtual machine where the key event is queued
+/// @param inputEvent The key event
+static void virtual_machine_queue_input(virtual_machine_t * vm, input_event_t const * inputEvent) {
+    if (!vm->overflowKeys && input_queue_push(&vm->inputQueue, inputEvent)) {
+        return;
+    }
+    if (vm->overflowKeys & inputEvent->keyCode) {
+        vm->lostInputEvents++;
+    }
+    vm->overflowKeys |= inputEvent->keyCode;
+    keyboard_apply(&vm->overflowKeyStates, inputEvent->keyCode, inputEvent->pressed);
+}
+
+/// @brief Determines the instruction before which the next key event is applied
+/// @details A key event that was received during a frame is applied during the following frame, at the same
+/// position within the frame. A quick tap therefore keeps the distance between the press and the release, but a key
+/// always stays pressed for at least one frame, so a program that polls the keyboard once per frame sees every tap
+/// @param vm The chip8 virtual machine where the next key event is scheduled
+/// @param options Options that configure the execution
+/// @param clock Relates the emulated instructions to the time of the host
+static void virtual_machine_schedule_input(virtual_machine_t * vm, virtual_machine_execution_options_t const * options,
+                                           virtual_machine_clock_t const * clock) {
+    if (options->inputLog && options->inputLog->replaying) {
+        vm->nextInputCycle = options->inputLog->nextCycle;
+        return;
+    }
+    if (!input_queue_pop(&vm->inputQueue, &vm->nextInput)) {
+        vm->nextInputCycle = UINT64_MAX;
+        return;
+    }
+    // Events that were received before the current frame have a negative offset
+    int64_t elapsed = (int64_t)(vm->nextInput.timestamp - clock->frameStart);
+    int64_t cycle = (int64_t)(clock->frameCycle + CHIP8_INSTRUCTIONS_PER_FRAME) +
+                    elapsed * (int64_t)CHIP8_INSTRUCTIONS_PER_FRAME / (int64_t)clock->ticksPerFrame;
+    if (!vm->nextInput.pressed) {
+        int64_t earliestRelease =
+            (int64_t)(vm->keyPressCycles[keyboard_key_index(vm->nextInput.keyCode)] + CHIP8_MINIMUM_KEY_PRESS);
+        cycle = cycle < earliestRelease ? earliestRelease : cycle;
+    }
+    vm->nextInputCycle = cycle < (int64_t)vm->core.cycles ? vm->core.cycles : (uint64_t)cycle;
+}
+
+/// @brief Streams the finished frame to the viewers of the frame server and applies their key events
+/// @details The key events of the viewers are applied at the end of the frame and recorded like the key events of the
+/// host. A replayed session ignores them
+/// @param vm The chip8 virtual machine whose frame is streamed
+/// @param options Options that configure the execution (see frameServer)
+static void virtual_machine_serve_frame(virtual_machine_t * vm, virtual_machine_execution_options_t const * options) {
+    frame_server_publish(options->frameServer, &vm->core.graphicsSystem);
+    keyBoardState_t keyBoardState = vm->core.keyBoardState;
+    frame_server_poll(options->frameServer, &keyBoardState);
+    if (keyBoardState == vm->core.keyBoardState || (options->inputLog && options->inputLog->replaying)) {
+        return;
+    }
+    vm->core.keyBoardState = keyBoardState;
+    if (options->inputLog) {
+        input_log_record(options->inputLog, vm->core.cycles, vm->core.keyBoardState);
+    }
+}
+
+/// @brief Stores the current frame of the virtual machine as a screenshot
+/// @param vm The virtual machine whose frame is stored
+/// @param path The path of the screenshot
+static void virtual_machine_take_screenshot(virtual_machine_t const * vm, char const * path) {
+    if (!display_write_screenshot(&vm->display, path)) {
+        printf("Screenshot of cycle %llu stored in %s (hash 0x%016llX)\n", (unsigned long long)vm->core.cycles, path,
+               (unsigned long long)display_hash(&vm->display));
+    }
+}
+
+/// @brief Determines the amount of instructions after which the core has to return within the current frame
+/// @param vm The chip8 virtual machine
+/// @param options Options that configure the execution
+/// @return The amount of instructions before which the next key event is applied, the execution is stopped or after
+/// which a screenshot is taken (UINT64_MAX if none of them happens)
+static inline uint64_t virtual_machine_stop_cycle(virtual_machine_t const * vm,
+                                                  virtual_machine_execution_options_t const * options) {
+    uint64_t stopCycle = vm->runningAhead ? UINT64_MAX : vm->nextInputCycle;
+    if (options->maximumCycles && options->maximumCycles < stopCycle) {
+        stopCycle = options->maximumCycles;
+    }
+    if (options->screenshotPath && !vm->runningAhead && options->screenshotCycle > vm->core.cycles &&
+        options->screenshotCycle < stopCycle) {
+        stopCycle = options->screenshotCycle;
+    }
+    return stopCycle;
 }
@@ -24,38 +24,115 @@
 #include "../../../external/SDL/include/SDL.h"
 #include "backend_pre_compiled_header.h"
 
+// This file is included in the test-suite that is written in c++ using the google-test framework
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../../core/src/virtual_machine_core.h"
 #include "display.h"
+#include "frame_export.h"
+#include "frame_server.h"
+#include "idle_detector.h"
+#include "input_log.h"
+#include "input_queue.h"
+#include "video_recorder.h"
+
+/// The maximum amount of frames that are run ahead of every presented frame
+#define VIRTUAL_MACHINE_MAX_RUN_AHEAD_FRAMES (8u)
+
+/// @brief The reasons the execution of a program ended
+typedef enum {
+    /// The execution was stopped by the user (or has not ended yet)
+    VIRTUAL_MACHINE_STOP_NONE = 0,
+    /// The program exited or reached the end of the program or the memory
+    VIRTUAL_MACHINE_STOP_EXITED = 1,
+    /// The program executed an unknown opcode
+    VIRTUAL_MACHINE_STOP_ERROR = 2,
+    /// The replayed session has ended
+    VIRTUAL_MACHINE_STOP_REPLAY_ENDED = 3,
+    /// The maximum amount of instructions was executed
+    VIRTUAL_MACHINE_STOP_CYCLE_LIMIT = 4,
+    /// The time limit of the execution was reached
+    VIRTUAL_MACHINE_STOP_TIME_LIMIT = 5,
+    /// The program is stuck in a jump to itself
+    VIRTUAL_MACHINE_STOP_HALT_LOOP = 6,
+    /// The program waits for a key, but no key will ever be pressed
+    VIRTUAL_MACHINE_STOP_KEY_WAIT = 7,
+    /// The framebuffer has not changed for the maximum amount of idle frames
+    VIRTUAL_MACHINE_STOP_STATIC_FRAME = 8
+} virtual_machine_stop_reason;
 
 /// @brief Models a chip8 emulator
+/// @details The emulated machine is held by the core, which is executed by the emulation thread. The emulator adds
+/// the display and the key events of the host that are received by the thread that polls the SDL events
 typedef struct {
-    /// The opcode that is currently executed
-    uint16_t currentOpcode;
-    /// 16-bit register used for storing an adress in memory
-    uint16_t I;
-    /// Programcounter of the virtual machine
-    uint16_t programCounter;
-    /// Delay timer of the virtual machine
-    uint8_t delayTimer;
-    /// Sound timer of the virtual machine
-    uint8_t soundTimer;
-    /// Stackpointer
-    uint16_t * stackPointer;
-    /// Display of the emulator
+    /// The registers, the memory, the framebuffer and the timers of the virtual machine
+    virtual_machine_core_t core;
+    /// Display of the emulator - presents the framebuffer of the core
     display_t display;
-    /// Stack of the chip8 (16bit unsigned integer values)
-    uint16_t stack[16];
-    /// Memory of the virtual machine (4096 bytes)
-    uint8_t memory[4096];
-    /// Registers of the virtual macine (16 8-bit registers)
-    uint8_t V[16];
+    /// Key events that are handed from the thread that polls the SDL events to the emulation thread
+    input_queue_t inputQueue;
+    /// The keys whose latest event did not fit into the full input queue - it is queued once there is room again
+    /// (owned by the thread that polls the SDL events)
+    keyBoardState_t overflowKeys;
+    /// Whether the keys in overflowKeys were pressed (bit set) or released by their latest event
+    keyBoardState_t overflowKeyStates;
+    /// The amount of key events that were replaced by a later event of the same key while the input queue was full
+    uint64_t lostInputEvents;
+    /// The key event that is applied next (only valid if nextInputCycle is not UINT64_MAX)
+    input_event_t nextInput;
+    /// The amount of executed instructions before which the next key event is applied (UINT64_MAX if there is none)
+    uint64_t nextInputCycle;
+    /// The amount of executed instructions when each key of the CHIP-8 keyboard was pressed the last time
+    uint64_t keyPressCycles[16];
+    /// Flag that indicates whether the program should keep running
+    SDL_atomic_t running;
+    /// Flag that indicates whether frames are run ahead - key events and screenshots are suppressed
+    bool runningAhead;
+    /// The reason the last execution ended
+    virtual_machine_stop_reason stopReason;
 } virtual_machine_t;
 
-void virtual_machine_execute(virtual_machine_t * vm);
+/// @brief Options that configure the execution of a program
+typedef struct {
+    /// The amount of instructions after which the execution is stopped (0 if there is no limit)
+    uint64_t maximumCycles;
+    /// The amount of instructions after which a screenshot is taken
+    uint64_t screenshotCycle;
+    /// Path of the screenshot (NULL if no screenshot is taken)
+    char const * screenshotPath;
+    /// Input log the keyboard input is recorded to or replayed from (NULL if the input is neither recorded nor
+    /// replayed)
+    input_log_t * inputLog;
+    /// The amount of frames that are run ahead of every presented frame to hide the input lag of a program (0 if no
+    /// frames are run ahead)
+    uint8_t runAheadFrames;
+    /// The amount of frames the framebuffer of an offscreen execution may stay unchanged before the program is
+    /// considered idle and stopped (0 if idle programs are not stopped). An idle offscreen execution is also stopped
+    /// as soon as the program jumps to itself or waits for a key that no replayed session will press
+    uint32_t idleFrames;
+    /// The amount of milliseconds after which the execution is stopped (0 if there is no limit)
+    uint32_t timeLimit;
+    /// Server that streams every frame to local viewers and receives their key events (NULL if the frames are not
+    /// streamed)
+    frame_server_t * frameServer;
+    /// Shared memory segment every frame is published into (NULL if the frames are not exported)
+    frame_export_t * frameExport;
+    /// Recorder every frame is captured to (NULL if no video is recorded)
+    video_recorder_t * videoRecorder;
+} virtual_machine_execution_options_t;
+
+void virtual_machine_execute(virtual_machine_t * vm, virtual_machine_execution_options_t const * options);
 
-void virtual_machine_init(virtual_machine_t * vm);
+int virtual_machine_init(virtual_machine_t * vm, virtual_machine_mode mode);
 
-void virtual_machine_write_opcode_to_memory(virtual_machine_t * vm, uint16_t * memoryLocation, uint16_t opcode);
+void virtual_machine_free(virtual_machine_t * vm);
 
-void virtual_machine_write_byte_to_memory(virtual_machine_t * vm, uint16_t * memoryLocation, uint8_t byte);
+char const * virtual_machine_stop_reason_name(virtual_machine_stop_reason reason);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif
@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include "../src/display.h"
+
+// The time between two frames at the frame rate of the emulation in microseconds
+static uint32_t const framePeriod = 1000000u / DISPLAY_FRAME_RATE;
+
+// Decides for the next frames whether their presentation is skipped and returns a string of the decisions, 'S' for a
+// skipped and 'P' for a presented frame
+static std::string SkipPattern(uint32_t renderCost, size_t frames) {
+    display_t display;
+    EXPECT_EQ(0, display_init(&display, DISPLAY_FLAG_OFFSCREEN));
+    display.renderCost = renderCost;
+    std::string pattern;
+    for (size_t i = 0; i < frames; i++) {
+        pattern += display_skip_frame(&display) ? 'S' : 'P';
+    }
+    EXPECT_EQ(std::count(pattern.begin(), pattern.end(), 'S'), (std::ptrdiff_t)display.skippedFrames);
+    display_quit(&display);
+    return pattern;
+}
+
+TEST(Display, PresentsEveryFrameIfRenderingIsFastEnough) {
+    ASSERT_EQ("PPPPPP", SkipPattern(0u, 6u));
+    ASSERT_EQ("PPPPPP", SkipPattern(framePeriod - 1u, 6u));
+}
+
+TEST(Display, PresentsEveryNthFrameIfRenderingTakesNFramePeriods) {
+    ASSERT_EQ("SPSPSP", SkipPattern(framePeriod, 6u));
+    ASSERT_EQ("SSPSSP", SkipPattern(2u * framePeriod + framePeriod / 2u, 6u));
+}
+
+TEST(Display, SkipsALimitedAmountOfConsecutiveFrames) {
+    std::string const pattern = SkipPattern(100u * framePeriod, 3u * (DISPLAY_MAX_FRAME_SKIP + 1u));
+    std::string const period = std::string(DISPLAY_MAX_FRAME_SKIP, 'S') + "P";
+    ASSERT_EQ(period + period + period, pattern);
+}
@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+
+#include "../src/frame_export.h"
+
+#if defined(OS_UNIX_LIKE)
+TEST(FrameExport, PublishesFramesToReaders) {
+    frame_export_t frameExport;
+    char const * name = "/chip8_frame_export_test";
+    ASSERT_EQ(0, frame_export_init(&frameExport, name));
+    // A reader maps the segment read-only
+    int file = shm_open(name, O_RDONLY, 0);
+    ASSERT_GE(file, 0);
+    void * mapping = mmap(NULL, sizeof(frame_export_segment_t), PROT_READ, MAP_SHARED, file, 0);
+    close(file);
+    ASSERT_NE(MAP_FAILED, mapping);
+    frame_export_segment_t const * segment = (frame_export_segment_t const *)mapping;
+    ASSERT_EQ(FRAME_EXPORT_MAGIC, segment->magic);
+    ASSERT_EQ(FRAME_EXPORT_VERSION, segment->version);
+
+    static graphics_system_t graphicsSystem;
+    graphics_system_init(&graphicsSystem);
+    uint8_t const sprite[] = {0xF0, 0x90, 0xF0};
+    graphics_system_draw_sprite(&graphicsSystem, 7, 9, sprite, sizeof(sprite), false, true);
+    frame_export_publish(&frameExport, &graphicsSystem);
+    graphics_system_set_mode(&graphicsSystem, GRAPHICS_SYSTEM_MODE_HIGH_RESOLUTION);
+    graphics_system_draw_sprite(&graphicsSystem, 100, 50, sprite, sizeof(sprite), false, true);
+    frame_export_publish(&frameExport, &graphicsSystem);
+
+    static graphics_system_t frame;
+    uint64_t frames = 0u;
+    ASSERT_TRUE(frame_export_read(segment, &frame, &frames));
+    ASSERT_EQ(2u, frames);
+    ASSERT_EQ(4, segment->sequence.value);
+    ASSERT_EQ(GRAPHICS_SYSTEM_MODE_HIGH_RESOLUTION, frame.mode);
+    ASSERT_EQ(graphicsSystem.usedPlanes, frame.usedPlanes);
+    ASSERT_EQ(graphics_system_hash(&graphicsSystem), graphics_system_hash(&frame));
+
+    munmap(mapping, sizeof(frame_export_segment_t));
+    frame_export_free(&frameExport);
+    ASSERT_GT(0, shm_open(name, O_RDONLY, 0));
+}
+
+TEST(FrameExport, RejectsNamesWithoutASlash) {
+    frame_export_t frameExport;
+    ASSERT_EQ(-1, frame_export_init(&frameExport, "chip8_frame_export_test"));
+}
+#endif
+
+TEST(FrameExport, ReadsNoFrameWhileAFrameIsWritten) {
+    static frame_export_segment_t segment;
+    static graphics_system_t frame;
+    uint64_t frames;
+    segment.sequence.value = 1;
+    ASSERT_FALSE(frame_export_read(&segment, &frame, &frames));
+    segment.sequence.value = 2;
+    ASSERT_TRUE(frame_export_read(&segment, &frame, &frames));
+}
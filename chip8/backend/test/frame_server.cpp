@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "../src/frame_server.h"
+
+// Returns a framebuffer with a sprite of the given rows drawn at the coordinates
+static graphics_system_t DrawFrame(uint8_t x, uint8_t y, std::vector<uint8_t> const & sprite) {
+    graphics_system_t graphicsSystem;
+    graphics_system_init(&graphicsSystem);
+    graphics_system_draw_sprite(&graphicsSystem, x, y, sprite.data(), (uint8_t)sprite.size(), false, true);
+    return graphicsSystem;
+}
+
+TEST(FrameServer, EncodesTheChangedBytes) {
+    static uint8_t previous[FRAME_SERVER_FRAME_SIZE];
+    static uint8_t frame[FRAME_SERVER_FRAME_SIZE];
+    static uint8_t payload[FRAME_SERVER_MAX_PAYLOAD_SIZE];
+    graphics_system_t first = DrawFrame(3, 5, {0xF0, 0x90, 0xF0});
+    graphics_system_t second = DrawFrame(40, 20, {0xFF});
+    frame_server_pack_frame(&first, previous);
+    frame_server_pack_frame(&second, frame);
+    uint16_t const size = frame_server_encode_delta(previous, frame, payload);
+    // Three rows are cleared and one is drawn, every other byte is unchanged
+    ASSERT_GT(size, 0u);
+    ASSERT_LT(size, 64u);
+    ASSERT_EQ(0, frame_server_decode_delta(payload, size, previous));
+    ASSERT_EQ(0, memcmp(previous, frame, FRAME_SERVER_FRAME_SIZE));
+    ASSERT_EQ(0u, frame_server_encode_delta(previous, frame, payload));
+}
+
+TEST(FrameServer, FitsTheLargestDeltaIntoThePayload) {
+    static uint8_t previous[FRAME_SERVER_FRAME_SIZE];
+    static uint8_t frame[FRAME_SERVER_FRAME_SIZE];
+    static uint8_t payload[FRAME_SERVER_MAX_PAYLOAD_SIZE];
+    for (uint16_t i = 0u; i < FRAME_SERVER_FRAME_SIZE; i += 2u) {
+        frame[i] = 0xA5u;
+    }
+    uint16_t const size = frame_server_encode_delta(previous, frame, payload);
+    ASSERT_LE(size, FRAME_SERVER_MAX_PAYLOAD_SIZE);
+    ASSERT_EQ(0, frame_server_decode_delta(payload, size, previous));
+    ASSERT_EQ(0, memcmp(previous, frame, FRAME_SERVER_FRAME_SIZE));
+}
+
+TEST(FrameServer, RejectsPayloadsThatExceedTheFrame) {
+    static uint8_t frame[FRAME_SERVER_FRAME_SIZE];
+    std::vector<uint8_t> payload(FRAME_SERVER_FRAME_SIZE / 128u, 0x7Fu);
+    payload.push_back(0x80u);
+    payload.push_back(0x01u);
+    ASSERT_EQ(-1, frame_server_decode_delta(payload.data(), (uint16_t)payload.size(), frame));
+}
+
+#if defined(OS_LINUX)
+TEST(FrameServer, StreamsFramesAndAppliesKeyEvents) {
+    static frame_server_t server;
+    char const * path = "chip8_frame_server_test.sock";
+    ASSERT_EQ(0, frame_server_init(&server, path));
+    int viewer = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+    ASSERT_EQ(0, connect(viewer, (struct sockaddr const *)&address, sizeof(address)));
+    keyBoardState_t keyBoardState = 0u;
+    frame_server_poll(&server, &keyBoardState);
+
+    graphics_system_t graphicsSystem = DrawFrame(10, 10, {0x81, 0x42});
+    frame_server_publish(&server, &graphicsSystem);
+    static uint8_t message[FRAME_SERVER_HEADER_SIZE + FRAME_SERVER_MAX_PAYLOAD_SIZE];
+    ssize_t received = recv(viewer, message, sizeof(message), 0);
+    ASSERT_GE(received, FRAME_SERVER_HEADER_SIZE);
+    ASSERT_EQ(1u, message[0]);
+    ASSERT_EQ(GRAPHICS_SYSTEM_MODE_LOW_RESOLUTION, message[4]);
+    ASSERT_EQ(1u, message[5]);
+    uint16_t const size = (uint16_t)(message[6] | message[7] << 8);
+    ASSERT_EQ(FRAME_SERVER_HEADER_SIZE + size, received);
+    static uint8_t frame[FRAME_SERVER_FRAME_SIZE];
+    static uint8_t expected[FRAME_SERVER_FRAME_SIZE];
+    ASSERT_EQ(0, frame_server_decode_delta(message + FRAME_SERVER_HEADER_SIZE, size, frame));
+    frame_server_pack_frame(&graphicsSystem, expected);
+    ASSERT_EQ(0, memcmp(expected, frame, FRAME_SERVER_FRAME_SIZE));
+
+    // An unchanged frame is not sent at all
+    frame_server_publish(&server, &graphicsSystem);
+    ASSERT_EQ(-1, recv(viewer, message, sizeof(message), MSG_DONTWAIT));
+
+    // A tap of key 5 is pressed during one poll and released during the next one
+    uint8_t const events[] = {0x85u, 0x05u};
+    ASSERT_EQ((ssize_t)sizeof(events), send(viewer, events, sizeof(events), 0));
+    frame_server_poll(&server, &keyBoardState);
+    ASSERT_EQ(CHIP8_KEY_CODE_5, keyBoardState);
+    frame_server_poll(&server, &keyBoardState);
+    ASSERT_EQ(0u, keyBoardState);
+
+    close(viewer);
+    frame_server_free(&server);
+}
+#endif
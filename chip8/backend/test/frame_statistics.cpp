@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "../src/frame_statistics.h"
+
+// The timestamps of the tests are in microseconds
+static uint64_t const CounterFrequency = 1000000u;
+
+// Records a present for every frame time, the first present of the statistics only starts the measurement
+static void RecordFrameTimes(frame_statistics_t * statistics, std::initializer_list<uint32_t> frameTimes) {
+    uint64_t timestamp = statistics->lastPresent;
+    if (!timestamp) {
+        timestamp = 1000u;
+        frame_statistics_record_present(statistics, timestamp, false);
+    }
+    for (uint32_t frameTime : frameTimes) {
+        timestamp += frameTime;
+        frame_statistics_record_present(statistics, timestamp, false);
+    }
+}
+
+static std::string Report(frame_statistics_t const * statistics) {
+    FILE * output = tmpfile();
+    EXPECT_NE(nullptr, output);
+    frame_statistics_report(statistics, statistics->presentedFrames, 0u, output);
+    std::string report;
+    rewind(output);
+    for (int character = fgetc(output); character != EOF; character = fgetc(output)) {
+        report += (char)character;
+    }
+    fclose(output);
+    return report;
+}
+
+TEST(FrameStatistics, ReportsTheNearestRankPercentiles) {
+    frame_statistics_t * statistics = new frame_statistics_t;
+    frame_statistics_init(statistics, 60u, CounterFrequency);
+    // Ten frame times in random order - the 5th and the 10th of the sorted frame times are the p50 and the p99
+    RecordFrameTimes(statistics, {9000u, 2000u, 10000u, 4000u, 1000u, 7000u, 3000u, 8000u, 5000u, 6000u});
+    std::string const report = Report(statistics);
+    EXPECT_NE(std::string::npos, report.find("Frame time p50:\t5.000 ms")) << report;
+    EXPECT_NE(std::string::npos, report.find("Frame time p99:\t10.000 ms")) << report;
+    EXPECT_NE(std::string::npos, report.find("Frame time max:\t10.000 ms")) << report;
+    delete statistics;
+}
+
+TEST(FrameStatistics, CountsFramesOfOneAndAHalfRefreshPeriodsAsMissedVsyncs) {
+    frame_statistics_t * statistics = new frame_statistics_t;
+    frame_statistics_init(statistics, 60u, CounterFrequency);
+    // The refresh period is 16666 microseconds, one and a half periods are 24999 microseconds
+    RecordFrameTimes(statistics, {16666u, 24998u});
+    EXPECT_EQ(0u, statistics->missedVsyncs);
+    RecordFrameTimes(statistics, {24999u, 50000u});
+    EXPECT_EQ(2u, statistics->missedVsyncs);
+    delete statistics;
+}
+
+TEST(FrameStatistics, AssumesTheDefaultRefreshRateIfItIsUnknown) {
+    frame_statistics_t * statistics = new frame_statistics_t;
+    frame_statistics_init(statistics, 0u, CounterFrequency);
+    EXPECT_EQ(FRAME_STATISTICS_DEFAULT_REFRESH_RATE, statistics->refreshRate);
+    EXPECT_EQ(1000000u / FRAME_STATISTICS_DEFAULT_REFRESH_RATE, statistics->expectedFrameTime);
+    RecordFrameTimes(statistics, {16666u, 33333u});
+    EXPECT_EQ(1u, statistics->missedVsyncs);
+    delete statistics;
+}
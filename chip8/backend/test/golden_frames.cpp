@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../../frontend/src/assembler.h"
+#include "../../io/src/file_utils.h"
+#include "../src/virtual_machine.h"
+
+// Every example program is executed headless for a fixed amount of instructions with a fixed keyboard state and seed.
+// The hash of the frame, the reason the execution stopped and the output of the program at every checkpoint are
+// compared against the golden values in golden_frames.txt, so programs that only print or exit are checked as well.
+// If the environment variable CHIP8_UPDATE_GOLDEN_FRAMES is set, the actual values are printed in the format of the
+// golden file instead of being compared.
+
+/// The seed of the random number generator that is used for all golden frames
+#define GOLDEN_FRAMES_SEED (0xC8C8C8C8u)
+
+struct Checkpoint {
+    /// The amount of instructions after which the execution is stopped at the latest
+    uint64_t maximumCycles;
+    /// The state of the keyboard while the instructions before the checkpoint are executed
+    uint16_t keyBoardState;
+    /// The amount of instructions that were executed when the frame is compared
+    uint64_t cycles;
+    /// The expected hash of the frame
+    uint64_t hash;
+    /// The name of the reason the execution stopped at the checkpoint
+    std::string stopReason;
+    /// The expected output of the program since the previous checkpoint
+    std::string output;
+};
+
+/// Escapes the backslashes, quotes and line breaks of an output, so it fits in a quoted string in the golden file
+static std::string EscapeOutput(std::string const & output) {
+    std::string escaped;
+    for (char c : output) {
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+/// Reverts EscapeOutput
+static std::string UnescapeOutput(std::string const & escaped) {
+    std::string output;
+    for (size_t i = 0; i < escaped.size(); i++) {
+        if (escaped[i] == '\\' && i + 1 < escaped.size()) {
+            output += escaped[++i] == 'n' ? '\n' : escaped[i];
+        } else {
+            output += escaped[i];
+        }
+    }
+    return output;
+}
+
+static std::vector<std::string> ExamplePrograms() {
+    std::vector<std::string> programs;
+    std::stringstream stream(CHIP8_EXAMPLE_PROGRAMS);
+    std::string program;
+    while (std::getline(stream, program, ',')) {
+        programs.push_back(program);
+    }
+    return programs;
+}
+
+static std::vector<Checkpoint> ReadCheckpoints(std::string const & program) {
+    std::vector<Checkpoint> checkpoints;
+    std::ifstream file(CHIP8_GOLDEN_FRAMES_FILE);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream entry(line);
+        std::string name;
+        Checkpoint checkpoint;
+        entry >> name >> std::dec >> checkpoint.maximumCycles >> std::hex >> checkpoint.keyBoardState >> std::dec >>
+            checkpoint.cycles >> std::hex >> checkpoint.hash >> std::quoted(checkpoint.stopReason);
+        // The output is the quoted rest of the line
+        std::string output;
+        std::getline(entry >> std::ws, output);
+        if (entry && name == program && output.size() >= 2u && output.front() == '"' && output.back() == '"') {
+            checkpoint.output = UnescapeOutput(output.substr(1u, output.size() - 2u));
+            checkpoints.push_back(checkpoint);
+        }
+    }
+    return checkpoints;
+}
+
+static std::string ProgramTestName(testing::TestParamInfo<std::string> const & info) {
+    std::string name = info.param;
+    for (char & c : name) {
+        if (!isalnum(static_cast<unsigned char>(c))) {
+            c = '_';
+        }
+    }
+    return name;
+}
+
+class GoldenFrames : public testing::TestWithParam<std::string> {
+  protected:
+    void SetUp() override {
+        ASSERT_EQ(0, virtual_machine_init(&vm, VIRTUAL_MACHINE_MODE_CHIP8));
+        ASSERT_EQ(0, virtual_machine_image_init(&image, VIRTUAL_MACHINE_MODE_CHIP8));
+        virtual_machine_core_seed(&vm.core, GOLDEN_FRAMES_SEED);
+        ASSERT_EQ(0, display_init(&vm.display, DISPLAY_FLAG_OFFSCREEN));
+        std::string path = std::string(CHIP8_EXAMPLES_DIRECTORY) + GetParam();
+        if (path.size() > 4 && path.compare(path.size() - 4, 4, ".cp8") == 0) {
+            assembler_t assembler;
+            char * source = file_utils_read_file(path.c_str());
+            // The assembler takes ownership of the source
+            ASSERT_EQ(0, assembler_initialize(&assembler, source));
+            ASSERT_EQ(0, assembler_process_file(&assembler, image.memory));
+        } else {
+            file_utils_read_file_to_memory(path.c_str(), image.memory, image.memoryMask + 1u);
+        }
+        virtual_machine_core_map_image(&vm.core, &image);
+    }
+
+    void TearDown() override {
+        display_quit(&vm.display);
+        virtual_machine_free(&vm);
+        virtual_machine_image_free(&image);
+    }
+
+    virtual_machine_t vm;
+    virtual_machine_image_t image;
+};
+
+TEST_P(GoldenFrames, MatchCheckpoints) {
+    std::vector<Checkpoint> checkpoints = ReadCheckpoints(GetParam());
+    bool const update = std::getenv("CHIP8_UPDATE_GOLDEN_FRAMES") != nullptr;
+    ASSERT_TRUE(update || !checkpoints.empty()) << "No golden frames recorded for " << GetParam();
+    virtual_machine_execution_options_t options = {0u, 0u, NULL, NULL, 0u};
+    for (Checkpoint const & checkpoint : checkpoints) {
+        vm.core.keyBoardState = checkpoint.keyBoardState;
+        options.maximumCycles = checkpoint.maximumCycles;
+        testing::internal::CaptureStdout();
+        virtual_machine_execute(&vm, &options);
+        std::string const output = testing::internal::GetCapturedStdout();
+        uint64_t hash = display_hash(&vm.display);
+        std::string const stopReason = virtual_machine_stop_reason_name(vm.stopReason);
+        if (update) {
+            printf("%s %llu 0x%04X %llu 0x%016llX \"%s\" \"%s\"\n", GetParam().c_str(),
+                   (unsigned long long)checkpoint.maximumCycles, checkpoint.keyBoardState,
+                   (unsigned long long)vm.core.cycles, (unsigned long long)hash, stopReason.c_str(),
+                   EscapeOutput(output).c_str());
+        } else {
+            EXPECT_EQ(checkpoint.hash, hash) << GetParam() << " differs after " << checkpoint.cycles
+                                             << " instructions (actual hash 0x" << std::hex << std::uppercase << hash
+                                             << ")";
+            EXPECT_EQ(checkpoint.cycles, vm.core.cycles) << GetParam() << " stopped at another instruction";
+            EXPECT_EQ(checkpoint.stopReason, stopReason)
+                << GetParam() << " at " << checkpoint.cycles << " instructions";
+            EXPECT_EQ(checkpoint.output, output) << GetParam() << " at " << checkpoint.cycles << " instructions";
+        }
+    }
+}
+
+TEST_P(GoldenFrames, RestoredStateContinuesIdentically) {
+    std::vector<Checkpoint> checkpoints = ReadCheckpoints(GetParam());
+    ASSERT_FALSE(checkpoints.empty()) << "No golden frames recorded for " << GetParam();
+    uint64_t const lastCycle = checkpoints.back().cycles;
+    virtual_machine_execution_options_t options = {lastCycle / 2u, 0u, NULL, NULL, 0u};
+    virtual_machine_execute(&vm, &options);
+    virtual_machine_state_t * state = new virtual_machine_state_t;
+    virtual_machine_core_save_state(&vm.core, state);
+    options.maximumCycles = lastCycle;
+    virtual_machine_execute(&vm, &options);
+    uint64_t const cycles = vm.core.cycles;
+    uint64_t const hash = display_hash(&vm.display);
+    virtual_machine_core_restore_state(&vm.core, state);
+    delete state;
+    virtual_machine_execute(&vm, &options);
+    EXPECT_EQ(cycles, vm.core.cycles);
+    EXPECT_EQ(hash, display_hash(&vm.display));
+}
+
+INSTANTIATE_TEST_SUITE_P(Examples, GoldenFrames, testing::ValuesIn(ExamplePrograms()), ProgramTestName);
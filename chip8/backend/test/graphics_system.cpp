@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <stdint.h>
+
+#include "../../core/src/graphics_system.h"
+
+TEST(GraphicsSystem, SpriteWrapsAroundInLowResolution) {
+    graphics_system_t graphicsSystem;
+    graphics_system_init(&graphicsSystem);
+    uint8_t const sprite[] = {0xFF};
+    ASSERT_FALSE(graphics_system_draw_sprite(&graphicsSystem, 60, 31, sprite, 1, false, false));
+    ASSERT_EQ(0xF00000000000000Fu, graphicsSystem.planes[0][31][0]);
+    ASSERT_EQ(0u, graphicsSystem.planes[0][31][1]);
+    ASSERT_TRUE(graphics_system_draw_sprite(&graphicsSystem, 124, 31, sprite, 1, false, false));
+    ASSERT_EQ(0u, graphicsSystem.planes[0][31][0]);
+}
+
+TEST(GraphicsSystem, WideSpriteCrossesWordsInHighResolution) {
+    graphics_system_t graphicsSystem;
+    graphics_system_init(&graphicsSystem);
+    graphics_system_set_mode(&graphicsSystem, GRAPHICS_SYSTEM_MODE_HIGH_RESOLUTION);
+    uint8_t const sprite[] = {0xAB, 0xCD, 0x12, 0x34};
+    ASSERT_FALSE(graphics_system_draw_sprite(&graphicsSystem, 56, 63, sprite, 2, true, false));
+    ASSERT_EQ(0xABu, graphicsSystem.planes[0][63][0]);
+    ASSERT_EQ(0xCDu << 24, graphicsSystem.planes[0][63][1] >> 32);
+    ASSERT_EQ(0x12u, graphicsSystem.planes[0][0][0]);
+    ASSERT_TRUE(graphics_system_pixel(&graphicsSystem, 63, 63));
+    ASSERT_TRUE(graphics_system_pixel(&graphicsSystem, 64, 63));
+    ASSERT_FALSE(graphics_system_draw_sprite(&graphicsSystem, 120, 0, sprite + 2, 1, true, false));
+    ASSERT_EQ(0x34u, graphicsSystem.planes[0][0][0] >> 56);
+    ASSERT_EQ(0x12u, graphicsSystem.planes[0][0][0] & 0xFF);
+    ASSERT_EQ(0x3400000000000012u, graphicsSystem.planes[0][0][1]);
+}
+
+TEST(GraphicsSystem, ClippedSpriteStopsAtTheEdges) {
+    graphics_system_t graphicsSystem;
+    graphics_system_init(&graphicsSystem);
+    uint8_t const sprite[] = {0xFF, 0xFF};
+    ASSERT_FALSE(graphics_system_draw_sprite(&graphicsSystem, 60, 31, sprite, 2, false, true));
+    ASSERT_EQ(0xFu, graphicsSystem.planes[0][31][0]);
+    ASSERT_EQ(0u, graphicsSystem.planes[0][0][0]);
+    graphics_system_set_mode(&graphicsSystem, GRAPHICS_SYSTEM_MODE_HIGH_RESOLUTION);
+    uint8_t const wideSprite[] = {0xAB, 0xCD, 0x12, 0x34};
+    ASSERT_FALSE(graphics_system_draw_sprite(&graphicsSystem, 120, 63, wideSprite, 2, true, true));
+    ASSERT_EQ(0u, graphicsSystem.planes[0][63][0]);
+    ASSERT_EQ(0xABu, graphicsSystem.planes[0][63][1]);
+    ASSERT_EQ(0u, graphicsSystem.planes[0][0][0]);
+    ASSERT_EQ(0u, graphicsSystem.planes[0][0][1]);
+}
+
+TEST(GraphicsSystem, ScrollsAcrossWords) {
+    graphics_system_t graphicsSystem;
+    graphics_system_init(&graphicsSystem);
+    graphics_system_set_mode(&graphicsSystem, GRAPHICS_SYSTEM_MODE_HIGH_RESOLUTION);
+    uint8_t const sprite[] = {0xFF};
+    graphics_system_draw_sprite(&graphicsSystem, 60, 0, sprite, 1, false, false);
+    graphics_system_scroll_right(&graphicsSystem);
+    ASSERT_EQ(0u, graphicsSystem.planes[0][0][0]);
+    ASSERT_EQ(0xFFu, graphicsSystem.planes[0][0][1] >> 56);
+    graphics_system_scroll_left(&graphicsSystem);
+    graphics_system_scroll_left(&graphicsSystem);
+    ASSERT_EQ(0xFFu, graphicsSystem.planes[0][0][0]);
+    ASSERT_EQ(0u, graphicsSystem.planes[0][0][1]);
+    graphics_system_scroll_down(&graphicsSystem, 15);
+    ASSERT_EQ(0u, graphicsSystem.planes[0][0][0]);
+    ASSERT_EQ(0xFFu, graphicsSystem.planes[0][15][0]);
+    graphics_system_scroll_down(&graphicsSystem, 64);
+    ASSERT_EQ(0u, graphicsSystem.planes[0][15][0]);
+}
+
+TEST(GraphicsSystem, ChangingTheModeClearsTheScreen) {
+    graphics_system_t graphicsSystem;
+    graphics_system_init(&graphicsSystem);
+    uint64_t const emptyLowResolution = graphics_system_hash(&graphicsSystem);
+    graphics_system_invert(&graphicsSystem);
+    ASSERT_EQ(UINT64_MAX, graphicsSystem.planes[0][31][0]);
+    ASSERT_EQ(0u, graphicsSystem.planes[0][31][1]);
+    ASSERT_EQ(0u, graphicsSystem.planes[0][32][0]);
+    graphics_system_set_mode(&graphicsSystem, GRAPHICS_SYSTEM_MODE_HIGH_RESOLUTION);
+    ASSERT_EQ(128, graphics_system_width(&graphicsSystem));
+    ASSERT_EQ(64, graphics_system_height(&graphicsSystem));
+    ASSERT_NE(emptyLowResolution, graphics_system_hash(&graphicsSystem));
+    graphics_system_set_mode(&graphicsSystem, GRAPHICS_SYSTEM_MODE_LOW_RESOLUTION);
+    ASSERT_EQ(emptyLowResolution, graphics_system_hash(&graphicsSystem));
+}
+
+TEST(GraphicsSystem, SpriteDataFollowsForEverySelectedPlane) {
+    graphics_system_t graphicsSystem;
+    graphics_system_init(&graphicsSystem);
+    graphics_system_select_planes(&graphicsSystem, 0b0011);
+    uint8_t const sprite[] = {0xF0, 0x0F, 0xFF, 0x00};
+    ASSERT_FALSE(graphics_system_draw_sprite(&graphicsSystem, 0, 0, sprite, 2, false, false));
+    ASSERT_EQ(0xF0u, graphicsSystem.planes[0][0][0] >> 56);
+    ASSERT_EQ(0xFFu, graphicsSystem.planes[1][0][0] >> 56);
+    ASSERT_EQ(3, graphics_system_pixel(&graphicsSystem, 0, 0));
+    ASSERT_EQ(2, graphics_system_pixel(&graphicsSystem, 4, 0));
+    ASSERT_EQ(1, graphics_system_pixel(&graphicsSystem, 4, 1));
+    graphics_system_select_planes(&graphicsSystem, 0b0010);
+    graphics_system_scroll_up(&graphicsSystem, 1);
+    ASSERT_EQ(0u, graphicsSystem.planes[1][0][0]);
+    ASSERT_EQ(0xF0u, graphicsSystem.planes[0][0][0] >> 56);
+    graphics_system_clear(&graphicsSystem);
+    ASSERT_EQ(1, graphics_system_pixel(&graphicsSystem, 0, 0));
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include "../../base/src/chip8.h"
+#include "../src/virtual_machine.h"
+
+// Executes a program offscreen with the idle detection and returns the reason the execution ended
+static virtual_machine_stop_reason ExecuteIdleProgram(std::initializer_list<uint16_t> program, uint32_t idleFrames,
+                                                      uint64_t * cycles = nullptr) {
+    virtual_machine_t vm;
+    EXPECT_EQ(0, virtual_machine_init(&vm, VIRTUAL_MACHINE_MODE_CHIP8));
+    EXPECT_EQ(0, display_init(&vm.display, DISPLAY_FLAG_OFFSCREEN));
+    uint16_t address = PROGRAM_START_LOCATION;
+    for (uint16_t opcode : program) {
+        virtual_machine_core_write_opcode_to_memory(&vm.core, &address, opcode);
+    }
+    virtual_machine_execution_options_t options = {1000000u, 0u, NULL, NULL, 0u, idleFrames, 0u};
+    virtual_machine_execute(&vm, &options);
+    if (cycles) {
+        *cycles = vm.core.cycles;
+    }
+    display_quit(&vm.display);
+    virtual_machine_free(&vm);
+    return vm.stopReason;
+}
+
+TEST(IdleDetector, StopsAJumpToItself) {
+    // Draws the first bytes of the program and jumps to itself
+    uint64_t cycles;
+    ASSERT_EQ(VIRTUAL_MACHINE_STOP_HALT_LOOP, ExecuteIdleProgram({0xA200, 0xD005, 0x1204}, 600u, &cycles));
+    ASSERT_EQ(CHIP8_INSTRUCTIONS_PER_FRAME, cycles);
+}
+
+TEST(IdleDetector, StopsAKeyWaitWithoutInput) {
+    ASSERT_EQ(VIRTUAL_MACHINE_STOP_KEY_WAIT, ExecuteIdleProgram({0x00E0, 0xF00A, 0x1200}, 600u));
+}
+
+TEST(IdleDetector, StopsAStaticFrame) {
+    // Draws the first bytes of the program and counts in V1 forever
+    uint64_t cycles;
+    ASSERT_EQ(VIRTUAL_MACHINE_STOP_STATIC_FRAME, ExecuteIdleProgram({0xA200, 0xD005, 0x7101, 0x1204}, 60u, &cycles));
+    ASSERT_EQ(61u * CHIP8_INSTRUCTIONS_PER_FRAME, cycles);
+}
+
+TEST(IdleDetector, KeepsAChangingFrameRunning) {
+    // Toggles the first bytes of the program five times per frame
+    ASSERT_EQ(VIRTUAL_MACHINE_STOP_CYCLE_LIMIT, ExecuteIdleProgram({0xA200, 0xD005, 0x1202}, 60u));
+}
+
+TEST(IdleDetector, StopsAtTheTimeLimit) {
+    virtual_machine_t vm;
+    ASSERT_EQ(0, virtual_machine_init(&vm, VIRTUAL_MACHINE_MODE_CHIP8));
+    ASSERT_EQ(0, display_init(&vm.display, DISPLAY_FLAG_OFFSCREEN));
+    uint16_t address = PROGRAM_START_LOCATION;
+    virtual_machine_core_write_opcode_to_memory(&vm.core, &address, 0x1200);
+    virtual_machine_execution_options_t options = {0u, 0u, NULL, NULL, 0u, 0u, 10u};
+    virtual_machine_execute(&vm, &options);
+    ASSERT_EQ(VIRTUAL_MACHINE_STOP_TIME_LIMIT, vm.stopReason);
+    display_quit(&vm.display);
+    virtual_machine_free(&vm);
+}
+
+TEST(IdleDetector, IsOnlyActiveIfRequested) {
+    ASSERT_EQ(VIRTUAL_MACHINE_STOP_CYCLE_LIMIT, ExecuteIdleProgram({0xA200, 0xD005, 0x1204}, 0u));
+}
+
+TEST(IdleDetector, NamesTheStopReasons) {
+    ASSERT_STREQ("static frame", virtual_machine_stop_reason_name(VIRTUAL_MACHINE_STOP_STATIC_FRAME));
+    ASSERT_STREQ("unknown",
+                 virtual_machine_stop_reason_name((virtual_machine_stop_reason)(VIRTUAL_MACHINE_STOP_STATIC_FRAME + 1)));
+    ASSERT_STREQ("unknown", virtual_machine_stop_reason_name((virtual_machine_stop_reason)-1));
+}
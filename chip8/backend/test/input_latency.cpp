@@ -0,0 +1,30 @@
+#include <gtest/gtest.h>
+
+#include "../src/input_latency.h"
+
+TEST(InputLatency, SortsLatenciesIntoPowerOfTwoBuckets) {
+    input_latency_t latency;
+    // One tick of the counter is one microsecond
+    input_latency_init(&latency, 1000000u);
+    input_latency_record(&latency, &latency.keyRead, 100u, 100u);
+    input_latency_record(&latency, &latency.keyRead, 100u, 101u);
+    input_latency_record(&latency, &latency.keyRead, 100u, 103u);
+    input_latency_record(&latency, &latency.keyRead, 0u, 16667u);
+    ASSERT_EQ(2u, latency.keyRead.buckets[0]);
+    ASSERT_EQ(1u, latency.keyRead.buckets[1]);
+    ASSERT_EQ(1u, latency.keyRead.buckets[14]);
+    ASSERT_EQ(4u, latency.keyRead.count);
+    ASSERT_EQ(16667u, latency.keyRead.maximum);
+    ASSERT_EQ(0u, latency.frameChange.count);
+}
+
+TEST(InputLatency, MeasuresFromTheFirstUnreadKeyEvent) {
+    input_latency_t latency;
+    input_latency_init(&latency, 1000000u);
+    input_latency_stamp(&latency, 0x5, 10u);
+    input_latency_stamp(&latency, 0x5, 20u);
+    input_latency_stamp(&latency, 0xA, 30u);
+    ASSERT_EQ(10u, latency.pendingKeyReads[0x5]);
+    ASSERT_EQ(30u, latency.pendingKeyReads[0xA]);
+    ASSERT_EQ(10u, latency.pendingFrameChange);
+}
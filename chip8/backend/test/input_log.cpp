@@ -0,0 +1,41 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+
+#include "../src/input_log.h"
+
+TEST(InputLog, ReplaysTheRecordedSession) {
+    std::string path = testing::TempDir() + "input_log_test.c8i";
+    input_log_t inputLog;
+    ASSERT_EQ(0, input_log_open_recording(&inputLog, path.c_str(), 0xC8C8C8C8u));
+    input_log_record(&inputLog, 0, 0x0000);
+    input_log_record(&inputLog, 10, CHIP8_KEY_CODE_0);
+    input_log_record(&inputLog, 20, CHIP8_KEY_CODE_0);
+    input_log_record(&inputLog, 30, CHIP8_KEY_CODE_0 | CHIP8_KEY_CODE_F);
+    input_log_record(&inputLog, 1000, 0x0000);
+    input_log_close(&inputLog, 2000);
+
+    // Magic and version, the seed and the four records - the cycles and changes are stored as varints
+    FILE * file = fopen(path.c_str(), "rb");
+    ASSERT_NE(nullptr, file);
+    fseek(file, 0L, SEEK_END);
+    EXPECT_EQ(4 + 5 + 2 + 4 + 5 + 3, ftell(file));
+    fclose(file);
+
+    uint32_t seed = 0;
+    keyBoardState_t keyBoardState = 0;
+    ASSERT_EQ(0, input_log_open_replay(&inputLog, path.c_str(), &seed));
+    ASSERT_EQ(0xC8C8C8C8u, seed);
+    ASSERT_FALSE(input_log_replay(&inputLog, 0, &keyBoardState));
+    ASSERT_EQ(0x0000, keyBoardState);
+    ASSERT_FALSE(input_log_replay(&inputLog, 10, &keyBoardState));
+    ASSERT_EQ(CHIP8_KEY_CODE_0, keyBoardState);
+    ASSERT_FALSE(input_log_replay(&inputLog, 29, &keyBoardState));
+    ASSERT_EQ(CHIP8_KEY_CODE_0, keyBoardState);
+    ASSERT_FALSE(input_log_replay(&inputLog, 1000, &keyBoardState));
+    ASSERT_EQ(0x0000, keyBoardState);
+    ASSERT_TRUE(input_log_replay(&inputLog, 2000, &keyBoardState));
+    input_log_close(&inputLog, 2000);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "../src/input_queue.h"
+
+TEST(InputQueue, RejectsEventsWhenFull) {
+    input_queue_t queue;
+    input_queue_init(&queue);
+    input_event_t event = {0u, CHIP8_KEY_CODE_1, true};
+    for (uint64_t i = 0; i < INPUT_QUEUE_CAPACITY; i++) {
+        event.timestamp = i;
+        ASSERT_TRUE(input_queue_push(&queue, &event));
+    }
+    ASSERT_FALSE(input_queue_push(&queue, &event));
+    ASSERT_TRUE(input_queue_pop(&queue, &event));
+    ASSERT_EQ(0u, event.timestamp);
+    ASSERT_TRUE(input_queue_push(&queue, &event));
+}
+
+TEST(InputQueue, KeepsTheOrderAcrossThreads) {
+    static input_queue_t queue;
+    input_queue_init(&queue);
+    uint64_t const eventCount = 100000u;
+    std::thread producer([eventCount]() {
+        for (uint64_t i = 0; i < eventCount; i++) {
+            input_event_t event = {i, CHIP8_KEY_CODE_F, (i & 1u) == 0};
+            while (!input_queue_push(&queue, &event)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    input_event_t event;
+    for (uint64_t i = 0; i < eventCount; i++) {
+        while (!input_queue_pop(&queue, &event)) {
+            std::this_thread::yield();
+        }
+        ASSERT_EQ(i, event.timestamp);
+        ASSERT_EQ((i & 1u) == 0, event.pressed);
+    }
+    producer.join();
+    ASSERT_FALSE(input_queue_pop(&queue, &event));
+}
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include "../src/program_analysis.h"
+
+// The analysis is too large for the stack of a test
+static program_analysis_t analysis;
+
+static void Analyze(std::initializer_list<uint8_t> program) {
+    static uint8_t memory[PROGRAM_ANALYSIS_MAX_INSTRUCTIONS * 2];
+    std::copy(program.begin(), program.end(), memory);
+    program_analysis_analyze(&analysis, memory, (uint16_t)program.size());
+}
+
+TEST(ProgramAnalysis, FindsBasicBlocksLoopsAndData) {
+    // V0 = 0, loop: V0 += 1, skips the jump back if V0 equals 0x10, exits. Two bytes of data follow
+    Analyze({0x60, 0x00, 0x70, 0x01, 0x30, 0x10, 0x12, 0x02, 0x00, 0xFD, 0xAB, 0xCD});
+    ASSERT_EQ(4u, analysis.blockCount);
+    ASSERT_EQ(1u, analysis.blocks[1].start);
+    ASSERT_EQ(2u, analysis.blocks[1].length);
+    ASSERT_TRUE(analysis.blocks[1].loopHeader);
+    ASSERT_EQ(1u, analysis.loopCount);
+    ASSERT_EQ(2u, analysis.blocks[1].successors[0]);
+    ASSERT_EQ(3u, analysis.blocks[1].successors[1]);
+    ASSERT_EQ(1u, analysis.blocks[2].successors[0]);
+    ASSERT_FALSE(analysis.reachable[5]);
+    ASSERT_EQ(2u, analysis.dataBytes);
+}
+
+TEST(ProgramAnalysis, DetectsSelfModifyingWrites) {
+    // I = 0x204, stores the BCD of V0 over the jump at 0x204
+    Analyze({0xA2, 0x04, 0xF0, 0x33, 0x12, 0x04});
+    ASSERT_EQ(1u, analysis.selfModifyingWrites);
+    ASSERT_EQ(0u, analysis.unknownWrites);
+}
+
+TEST(ProgramAnalysis, DetectsWritesToUnknownAddresses) {
+    // I += V0 before the store, so the address is not known
+    Analyze({0xA3, 0x00, 0xF0, 0x1E, 0xF1, 0x55, 0x12, 0x06});
+    ASSERT_EQ(0u, analysis.selfModifyingWrites);
+    ASSERT_EQ(1u, analysis.unknownWrites);
+}
+
+TEST(ProgramAnalysis, DetectsIndirectJumps) {
+    Analyze({0xB0, 0x10});
+    ASSERT_EQ(1u, analysis.indirectJumps);
+    ASSERT_EQ(1u, analysis.blockCount);
+    ASSERT_EQ(0u, analysis.quirkDependencies);
+}
+
+TEST(ProgramAnalysis, SuggestsSuperChipForJumpsWithVX) {
+    Analyze({0xB3, 0x10});
+    ASSERT_EQ(PROGRAM_ANALYSIS_QUIRK_JUMP, analysis.quirkDependencies);
+    ASSERT_EQ(VIRTUAL_MACHINE_QUIRKS_SCHIP, program_analysis_suggest_quirks(&analysis));
+}
+
+TEST(ProgramAnalysis, SuggestsVipForShiftsOfVY) {
+    Analyze({0x81, 0x26, 0x12, 0x02});
+    ASSERT_EQ(PROGRAM_ANALYSIS_QUIRK_SHIFT, analysis.quirkDependencies);
+    ASSERT_EQ(VIRTUAL_MACHINE_QUIRKS_VIP, program_analysis_suggest_quirks(&analysis));
+}
+
+TEST(ProgramAnalysis, SuggestsVipForIAfterStores) {
+    // Stores V0 and V1, then draws with I
+    Analyze({0xA3, 0x00, 0xF1, 0x55, 0xD0, 0x05, 0x12, 0x06});
+    ASSERT_EQ(PROGRAM_ANALYSIS_QUIRK_LOAD_STORE, analysis.quirkDependencies);
+    ASSERT_EQ(VIRTUAL_MACHINE_QUIRKS_VIP, program_analysis_suggest_quirks(&analysis));
+}
+
+TEST(ProgramAnalysis, DetectsVFAfterLogic) {
+    // V1 |= V2, skips if VF equals 0
+    Analyze({0x81, 0x21, 0x3F, 0x00, 0x12, 0x04, 0x12, 0x06});
+    ASSERT_EQ(PROGRAM_ANALYSIS_QUIRK_LOGIC, analysis.quirkDependencies);
+}
+
+TEST(ProgramAnalysis, SuggestsTheProfileOfTheExtensions) {
+    Analyze({0x00, 0xFF, 0x81, 0x26, 0x00, 0xFD});
+    ASSERT_EQ(PROGRAM_ANALYSIS_EXTENSION_SCHIP, analysis.extensions);
+    ASSERT_EQ(VIRTUAL_MACHINE_QUIRKS_SCHIP, program_analysis_suggest_quirks(&analysis));
+    Analyze({0xF2, 0x01, 0x12, 0x02});
+    ASSERT_EQ(PROGRAM_ANALYSIS_EXTENSION_XO_CHIP, analysis.extensions);
+    ASSERT_EQ(VIRTUAL_MACHINE_QUIRKS_XO_CHIP, program_analysis_suggest_quirks(&analysis));
+}
+
+TEST(ProgramAnalysis, SuggestsSuperChipWithoutEvidence) {
+    Analyze({0x60, 0x01, 0x12, 0x02});
+    ASSERT_EQ(VIRTUAL_MACHINE_QUIRKS_SCHIP, program_analysis_suggest_quirks(&analysis));
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include "../../base/src/chip8.h"
+#include "../src/virtual_machine.h"
+
+// Executes a short program with every quirk profile:
+// V1 = 0x05, V2 = 0x81, V1 = V2 >> 1 (or V1 >> 1), I = 0x300, stores V0 and V1 at I
+static uint16_t const QuirkProgram[] = {0x6105, 0x6281, 0x8126, 0xA300, 0xF155};
+
+class QuirkProfiles : public testing::Test {
+  protected:
+    void SetUp() override {
+        ASSERT_EQ(0, virtual_machine_init(&vm, VIRTUAL_MACHINE_MODE_CHIP8));
+        ASSERT_EQ(0, display_init(&vm.display, DISPLAY_FLAG_OFFSCREEN));
+        uint16_t address = PROGRAM_START_LOCATION;
+        for (uint16_t opcode : QuirkProgram) {
+            virtual_machine_core_write_opcode_to_memory(&vm.core, &address, opcode);
+        }
+    }
+
+    void TearDown() override {
+        display_quit(&vm.display);
+        virtual_machine_free(&vm);
+    }
+
+    void Execute(virtual_machine_quirks quirks) {
+        vm.core.quirks = quirks;
+        virtual_machine_execution_options_t options = {0u, 0u, NULL, NULL, 0u};
+        virtual_machine_execute(&vm, &options);
+    }
+
+    virtual_machine_t vm;
+};
+
+TEST_F(QuirkProfiles, VipShiftsVYAndIncrementsI) {
+    Execute(VIRTUAL_MACHINE_QUIRKS_VIP);
+    ASSERT_EQ(0x40u, vm.core.V[1]);
+    ASSERT_EQ(1u, vm.core.V[0xf]);
+    ASSERT_EQ(0x302u, vm.core.I);
+    ASSERT_EQ(0x40u, virtual_machine_core_read(&vm.core, 0x301));
+}
+
+TEST_F(QuirkProfiles, SuperChipShiftsVXAndKeepsI) {
+    Execute(VIRTUAL_MACHINE_QUIRKS_SCHIP);
+    ASSERT_EQ(0x02u, vm.core.V[1]);
+    ASSERT_EQ(1u, vm.core.V[0xf]);
+    ASSERT_EQ(0x300u, vm.core.I);
+    ASSERT_EQ(0x02u, virtual_machine_core_read(&vm.core, 0x301));
+}
+
+TEST_F(QuirkProfiles, ChipEightModeDefaultsToTheSuperChipProfile) {
+    // The CHIP-8 mode also executes SUPER-CHIP programs - COSMAC VIP programs select their profile explicitly
+    ASSERT_EQ(VIRTUAL_MACHINE_QUIRKS_SCHIP, vm.core.quirks);
+    virtual_machine_execution_options_t options = {0u, 0u, NULL, NULL, 0u};
+    virtual_machine_execute(&vm, &options);
+    ASSERT_EQ(0x02u, vm.core.V[1]);
+    ASSERT_EQ(0x300u, vm.core.I);
+}
+
+TEST(QuirkProfilesDefault, XoChipModeDefaultsToTheXoChipProfile) {
+    virtual_machine_core_t core;
+    ASSERT_EQ(0, virtual_machine_core_init(&core, VIRTUAL_MACHINE_MODE_XO_CHIP));
+    ASSERT_EQ(VIRTUAL_MACHINE_QUIRKS_XO_CHIP, core.quirks);
+    virtual_machine_core_free(&core);
+}
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "../../base/src/chip8.h"
+#include "../../frontend/src/assembler.h"
+#include "../../io/src/file_utils.h"
+#include "../src/recompiler.h"
+
+// The main function of the translation of Breakout that is linked into the tests (see CMakeLists.txt)
+extern "C" int recompiled_breakout_main(int argc, char * argv[]);
+
+// V0 = 0x05, calls 0x206, loops at 0x204. The subroutine draws a sprite and returns, 0x20A is never reached
+static uint8_t const RecompilerProgram[] = {0x60, 0x05, 0x22, 0x06, 0x12, 0x04, 0xD0, 0x01, 0x00, 0xEE, 0x61, 0x23};
+
+static std::string Translate(uint8_t const * program, uint16_t programSize) {
+    static program_analysis_t analysis;
+    program_analysis_analyze(&analysis, program, programSize);
+    FILE * output = tmpfile();
+    EXPECT_NE(nullptr, output);
+    EXPECT_EQ(0, recompiler_translate(&analysis, VIRTUAL_MACHINE_QUIRKS_SCHIP, output));
+    std::string translation;
+    rewind(output);
+    for (int character = fgetc(output); character != EOF; character = fgetc(output)) {
+        translation += (char)character;
+    }
+    fclose(output);
+    return translation;
+}
+
+TEST(Recompiler, TranslatesJumpsAndCallsToGotos) {
+    std::string translation = Translate(RecompilerProgram, sizeof(RecompilerProgram));
+    ASSERT_NE(std::string::npos,
+              translation.find("*vm->stackPointer++ = 0x0001u;\n    vm->cycles++;\n    goto L_0003;"));
+    ASSERT_NE(std::string::npos, translation.find("vm->cycles++;\n    goto L_0002;"));
+    ASSERT_NE(std::string::npos, translation.find("goto dispatch;"));
+}
+
+TEST(Recompiler, InterpretsDrawing) {
+    std::string translation = Translate(RecompilerProgram, sizeof(RecompilerProgram));
+    ASSERT_NE(std::string::npos,
+              translation.find("vm->programCounter = 0x0003u;\n    return VIRTUAL_MACHINE_COMPILED_INTERPRET;"));
+}
+
+TEST(Recompiler, SkipsUnreachableInstructions) {
+    std::string translation = Translate(RecompilerProgram, sizeof(RecompilerProgram));
+    ASSERT_NE(std::string::npos, translation.find("L_0004:"));
+    ASSERT_EQ(std::string::npos, translation.find("L_0005:"));
+}
+
+TEST(Recompiler, RejectsEmptyPrograms) {
+    static program_analysis_t analysis;
+    program_analysis_analyze(&analysis, RecompilerProgram, 0u);
+    ASSERT_EQ(-1, recompiler_translate(&analysis, VIRTUAL_MACHINE_QUIRKS_SCHIP, stdout));
+}
+
+TEST(Recompiler, InterpreterReturnsBehindTheCall) {
+    // Calls 0x206 (V0 = 0x05), sets V1 = 0x07 after the return and exits
+    uint16_t const program[] = {0x2206, 0x6107, 0x0002, 0x6005, 0x00EE};
+    virtual_machine_t vm;
+    ASSERT_EQ(0, virtual_machine_init(&vm, VIRTUAL_MACHINE_MODE_CHIP8));
+    ASSERT_EQ(0, display_init(&vm.display, DISPLAY_FLAG_OFFSCREEN));
+    uint16_t address = PROGRAM_START_LOCATION;
+    for (uint16_t opcode : program) {
+        virtual_machine_core_write_opcode_to_memory(&vm.core, &address, opcode);
+    }
+    virtual_machine_execution_options_t options = {0u, 0u, NULL, NULL, 0u};
+    virtual_machine_execute(&vm, &options);
+    ASSERT_EQ(0x05u, vm.core.V[0]);
+    ASSERT_EQ(0x07u, vm.core.V[1]);
+    display_quit(&vm.display);
+    virtual_machine_free(&vm);
+}
+
+// Executes Breakout headless, either translated by the recompiler or by the interpreter, and returns the amount of
+// executed instructions and the hash of the framebuffer in the format of the translated program
+static std::string ExecuteBreakout(bool recompiled, uint64_t maximumCycles) {
+    if (recompiled) {
+        std::vector<std::string> arguments = {"recompiled_breakout", "--headless"};
+        if (maximumCycles) {
+            arguments.push_back("--cycles");
+            arguments.push_back(std::to_string(maximumCycles));
+        }
+        std::vector<char *> argv;
+        for (std::string & argument : arguments) {
+            argv.push_back(&argument[0]);
+        }
+        testing::internal::CaptureStdout();
+        EXPECT_EQ(0, recompiled_breakout_main((int)argv.size(), argv.data()));
+        return testing::internal::GetCapturedStdout();
+    }
+    virtual_machine_t vm;
+    virtual_machine_image_t image;
+    EXPECT_EQ(0, virtual_machine_init(&vm, VIRTUAL_MACHINE_MODE_CHIP8));
+    EXPECT_EQ(0, virtual_machine_image_init(&image, VIRTUAL_MACHINE_MODE_CHIP8));
+    assembler_t assembler;
+    // The assembler takes ownership of the source
+    EXPECT_EQ(0, assembler_initialize(&assembler, file_utils_read_file(CHIP8_EXAMPLES_DIRECTORY "Breakout.cp8")));
+    EXPECT_EQ(0, assembler_process_file(&assembler, image.memory));
+    virtual_machine_core_map_image(&vm.core, &image);
+    virtual_machine_core_seed(&vm.core, 0u);
+    EXPECT_EQ(0, display_init(&vm.display, DISPLAY_FLAG_OFFSCREEN));
+    virtual_machine_execution_options_t options = {maximumCycles, 0u, NULL, NULL, 0u};
+    virtual_machine_execute(&vm, &options);
+    char result[80];
+    snprintf(result, sizeof(result), "Executed %llu instructions, framebuffer hash 0x%016llX\n",
+             (unsigned long long)vm.core.cycles, (unsigned long long)display_hash(&vm.display));
+    display_quit(&vm.display);
+    virtual_machine_free(&vm);
+    virtual_machine_image_free(&image);
+    return result;
+}
+
+TEST(Recompiler, TranslatedProgramExecutesLikeTheInterpreter) {
+    for (uint64_t maximumCycles : {1u, 500u, 4321u, 10000u}) {
+        EXPECT_EQ(ExecuteBreakout(false, maximumCycles), ExecuteBreakout(true, maximumCycles))
+            << "after " << maximumCycles << " instructions";
+    }
+    // Without a limit Breakout ends once the ball was missed, because nobody moves the paddle
+    std::string const interpreted = ExecuteBreakout(false, 0u);
+    EXPECT_EQ("Executed 10937 instructions, framebuffer hash 0xF63E7290929E6B0D\n", interpreted);
+    EXPECT_EQ(interpreted, ExecuteBreakout(true, 0u));
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "../src/display.h"
+#include "../src/video_recorder.h"
+
+// Size of a frame of the video including the frame header
+static size_t const Y4MFrameSize =
+    6u + 3u * GRAPHICS_SYSTEM_HIGH_RESOLUTION_WIDTH * GRAPHICS_SYSTEM_HIGH_RESOLUTION_HEIGHT;
+
+static std::string ReadFile(char const * path) {
+    std::string content;
+    FILE * file = fopen(path, "rb");
+    EXPECT_NE(nullptr, file);
+    for (int character = fgetc(file); character != EOF; character = fgetc(file)) {
+        content += (char)character;
+    }
+    fclose(file);
+    return content;
+}
+
+TEST(VideoRecorder, WritesRepeatedFramesToY4M) {
+    static video_recorder_t recorder;
+    static graphics_system_t graphicsSystem;
+    char const * path = "chip8_video_recorder_test.y4m";
+    ASSERT_EQ(0, video_recorder_init(&recorder, path));
+    graphics_system_init(&graphicsSystem);
+    video_recorder_record_frame(&recorder, &graphicsSystem);
+    video_recorder_record_frame(&recorder, &graphicsSystem);
+    uint8_t const sprite[] = {0x80};
+    graphics_system_draw_sprite(&graphicsSystem, 1, 2, sprite, sizeof(sprite), false, true);
+    for (int frame = 0; frame < 3; frame++) {
+        video_recorder_record_frame(&recorder, &graphicsSystem);
+    }
+    ASSERT_EQ(5u, recorder.frames);
+    ASSERT_EQ(0, video_recorder_free(&recorder));
+
+    std::string video = ReadFile(path);
+    std::string const header = "YUV4MPEG2 W128 H64 F60:1 Ip A1:1 C444 XCOLORRANGE=FULL\n";
+    ASSERT_EQ(header, video.substr(0, header.size()));
+    ASSERT_EQ(header.size() + 5u * Y4MFrameSize, video.size());
+    // The pixel (1, 2) covers the pixels (2 - 3, 4 - 5) of the video and is black from the third frame on
+    size_t const luma = header.size() + 6u + 4u * GRAPHICS_SYSTEM_HIGH_RESOLUTION_WIDTH + 2u;
+    ASSERT_EQ((char)0xFF, video[luma + Y4MFrameSize]);
+    ASSERT_EQ((char)0x00, video[luma + 2u * Y4MFrameSize]);
+    ASSERT_EQ((char)0x00, video[luma + 4u * Y4MFrameSize + GRAPHICS_SYSTEM_HIGH_RESOLUTION_WIDTH + 1u]);
+    remove(path);
+}
+
+TEST(VideoRecorder, WritesDistinctFramesToBitmaps) {
+    static video_recorder_t recorder;
+    static graphics_system_t graphicsSystem;
+    ASSERT_EQ(0, video_recorder_init(&recorder, "chip8_video_recorder_test.pbm"));
+    graphics_system_init(&graphicsSystem);
+    video_recorder_record_frame(&recorder, &graphicsSystem);
+    uint8_t const sprite[] = {0xFF};
+    graphics_system_draw_sprite(&graphicsSystem, 0, 0, sprite, sizeof(sprite), false, true);
+    for (int frame = 0; frame < 4; frame++) {
+        video_recorder_record_frame(&recorder, &graphicsSystem);
+    }
+    ASSERT_EQ(0, video_recorder_free(&recorder));
+
+    ASSERT_EQ("P4\n64 32\n", ReadFile("chip8_video_recorder_test_000000.pbm").substr(0, 9));
+    std::string bitmap = ReadFile("chip8_video_recorder_test_000001.pbm");
+    ASSERT_EQ((char)0xFF, bitmap[9]);
+    ASSERT_EQ(nullptr, fopen("chip8_video_recorder_test_000002.pbm", "rb"));
+    remove("chip8_video_recorder_test_000000.pbm");
+    remove("chip8_video_recorder_test_000001.pbm");
+}
+
+TEST(VideoRecorder, ReportsDroppedFramesWhenItStops) {
+    static video_recorder_t recorder;
+    char const * path = "chip8_video_recorder_dropped_test.y4m";
+    ASSERT_EQ(0, video_recorder_init(&recorder, path));
+    // The writer thread keeps up with a test, so the frames are dropped by hand
+    recorder.droppedFrames = 3u;
+    testing::internal::CaptureStdout();
+    ASSERT_EQ(0, video_recorder_free(&recorder));
+    ASSERT_EQ("3 changed frames were recorded as repeats, because the video was written too slowly\n",
+              testing::internal::GetCapturedStdout());
+    remove(path);
+}
+
+TEST(VideoRecorder, RejectsUnknownFormats) {
+    static video_recorder_t recorder;
+    ASSERT_EQ(-1, video_recorder_init(&recorder, "chip8_video_recorder_test.mp4"));
+}
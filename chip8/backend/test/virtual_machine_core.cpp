@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+
+#include "../../base/src/chip8.h"
+#include "../../core/src/virtual_machine_core.h"
+
+// V0 = 0x01, then V0 += 0x01 in an endless loop
+static uint16_t const CountingProgram[] = {0x6001, 0x7001, 0x1202};
+
+class VirtualMachineCore : public testing::Test {
+  protected:
+    void SetUp() override {
+        ASSERT_EQ(0, virtual_machine_core_init(&vm, VIRTUAL_MACHINE_MODE_CHIP8));
+        uint16_t address = PROGRAM_START_LOCATION;
+        for (uint16_t opcode : CountingProgram) {
+            virtual_machine_core_write_opcode_to_memory(&vm, &address, opcode);
+        }
+    }
+
+    void TearDown() override {
+        virtual_machine_core_free(&vm);
+    }
+
+    virtual_machine_core_t vm;
+};
+
+TEST(VirtualMachineCoreLayout, HotFieldsShareTheFirstCacheLine) {
+    ASSERT_LE(offsetof(virtual_machine_core_t, quirks) + sizeof(virtual_machine_quirks),
+              VIRTUAL_MACHINE_CORE_CACHE_LINE_SIZE);
+}
+
+TEST_F(VirtualMachineCore, RunsAFrameWithoutAFrontend) {
+    ASSERT_EQ(VIRTUAL_MACHINE_CORE_FRAME_COMPLETE, virtual_machine_core_run(&vm, UINT64_MAX));
+    ASSERT_EQ(CHIP8_INSTRUCTIONS_PER_FRAME, vm.cycles);
+    ASSERT_EQ(1u, vm.frames);
+    ASSERT_EQ(0x06u, vm.V[0]);
+}
+
+TEST_F(VirtualMachineCore, StopsAtTheStopCycleAndResumesMidFrame) {
+    ASSERT_EQ(VIRTUAL_MACHINE_CORE_STOPPED, virtual_machine_core_run(&vm, 3u));
+    ASSERT_EQ(3u, vm.cycles);
+    ASSERT_EQ(0u, vm.frames);
+    ASSERT_EQ(VIRTUAL_MACHINE_CORE_FRAME_COMPLETE, virtual_machine_core_run(&vm, UINT64_MAX));
+    ASSERT_EQ(CHIP8_INSTRUCTIONS_PER_FRAME, vm.cycles);
+    ASSERT_EQ(1u, vm.frames);
+}
+
+TEST_F(VirtualMachineCore, EndsAtTheEndOfTheProgram) {
+    uint16_t address = PROGRAM_START_LOCATION + 4u;
+    // Replaces the jump with the exit of the SUPER-CHIP
+    virtual_machine_core_write_opcode_to_memory(&vm, &address, 0x00FD);
+    ASSERT_EQ(VIRTUAL_MACHINE_CORE_EXITED, virtual_machine_core_run(&vm, UINT64_MAX));
+    ASSERT_EQ(2u, vm.cycles);
+}
+
+TEST_F(VirtualMachineCore, ReportsAnUnknownOpcodeInsteadOfTerminating) {
+    uint16_t address = PROGRAM_START_LOCATION + 4u;
+    virtual_machine_core_write_opcode_to_memory(&vm, &address, 0xE0FF);
+    vm.silent = true;
+    ASSERT_EQ(VIRTUAL_MACHINE_CORE_ERROR, virtual_machine_core_run(&vm, UINT64_MAX));
+    ASSERT_EQ(2u, vm.cycles);
+}
+
+TEST_F(VirtualMachineCore, ReturnsWhileWaitingForAKey) {
+    uint16_t address = PROGRAM_START_LOCATION + 4u;
+    // V1 = key
+    virtual_machine_core_write_opcode_to_memory(&vm, &address, 0xF10A);
+    ASSERT_EQ(VIRTUAL_MACHINE_CORE_WAITING_FOR_KEY, virtual_machine_core_run(&vm, UINT64_MAX));
+    ASSERT_EQ(VIRTUAL_MACHINE_CORE_WAITING_FOR_KEY, virtual_machine_core_run(&vm, UINT64_MAX));
+    vm.keyBoardState = CHIP8_KEY_CODE_7;
+    virtual_machine_core_run(&vm, vm.cycles + 1u);
+    ASSERT_EQ(0x07u, vm.V[1]);
+}
+
+TEST_F(VirtualMachineCore, TimersCountDownOncePerFrameUntilZero) {
+    uint16_t address = PROGRAM_START_LOCATION;
+    // V0 = 3, DT = V0, ST = V0, then V1 = DT in an endless loop
+    for (uint16_t opcode : {0x6003, 0xF015, 0xF018, 0xF107, 0x1206}) {
+        virtual_machine_core_write_opcode_to_memory(&vm, &address, opcode);
+    }
+    // The value the program read last in each frame
+    uint8_t const delayTimerValues[] = {3u, 2u, 1u, 0u, 0u, 0u};
+    for (uint8_t frame = 0; frame < sizeof(delayTimerValues); frame++) {
+        ASSERT_EQ(VIRTUAL_MACHINE_CORE_FRAME_COMPLETE, virtual_machine_core_run(&vm, UINT64_MAX));
+        ASSERT_EQ(delayTimerValues[frame], vm.V[1]) << "frame " << (int)frame;
+        // The timers tick at the end of the frame
+        uint8_t const remaining = frame < 3u ? (uint8_t)(2u - frame) : 0u;
+        ASSERT_EQ(remaining, virtual_machine_core_timer_value(&vm, &vm.delayTimer)) << "frame " << (int)frame;
+        ASSERT_EQ(remaining, virtual_machine_core_timer_value(&vm, &vm.soundTimer)) << "frame " << (int)frame;
+    }
+}
+
+TEST_F(VirtualMachineCore, ATimerSetMidFrameTicksAtTheEndOfTheFrame) {
+    uint16_t address = PROGRAM_START_LOCATION;
+    // V0 = 5, V1 += 1 four times, DT = V0, then V2 = DT in an endless loop
+    for (uint16_t opcode : {0x6005, 0x7101, 0x7101, 0x7101, 0x7101, 0xF015, 0xF207, 0x120C}) {
+        virtual_machine_core_write_opcode_to_memory(&vm, &address, opcode);
+    }
+    ASSERT_EQ(VIRTUAL_MACHINE_CORE_STOPPED, virtual_machine_core_run(&vm, 7u));
+    ASSERT_EQ(0u, vm.frames);
+    ASSERT_EQ(5u, vm.V[2]);
+    // Stopping and resuming within the frame does not change the timer
+    ASSERT_EQ(VIRTUAL_MACHINE_CORE_STOPPED, virtual_machine_core_run(&vm, 8u));
+    ASSERT_EQ(5u, virtual_machine_core_timer_value(&vm, &vm.delayTimer));
+    ASSERT_EQ(VIRTUAL_MACHINE_CORE_FRAME_COMPLETE, virtual_machine_core_run(&vm, UINT64_MAX));
+    ASSERT_EQ(5u, vm.V[2]);
+    ASSERT_EQ(4u, virtual_machine_core_timer_value(&vm, &vm.delayTimer));
+    ASSERT_EQ(VIRTUAL_MACHINE_CORE_FRAME_COMPLETE, virtual_machine_core_run(&vm, UINT64_MAX));
+    ASSERT_EQ(4u, vm.V[2]);
+}
+
+TEST_F(VirtualMachineCore, VipTimingExecutesTheInstructionsThatFitIntoTheCyclesOfAFrame) {
+    vm.timing = VIRTUAL_MACHINE_TIMING_COSMAC_VIP;
+    // 6XNN costs 6, 7XNN 10 and 1NNN 12 machine cycles and 2568 cycles of a frame are left for the interpreter. The
+    // first frame ends after 6 + 116 * (10 + 12) + 10 = 2568 cycles
+    ASSERT_EQ(VIRTUAL_MACHINE_CORE_FRAME_COMPLETE, virtual_machine_core_run(&vm, UINT64_MAX));
+    ASSERT_EQ(234u, vm.cycles);
+    ASSERT_EQ(0u, vm.frameCycles);
+    // The second frame starts with the jump and ends after 116 * (12 + 10) + 12 + 10 = 2574 cycles, the 6 cycles beyond
+    // the frame are taken from the next one
+    ASSERT_EQ(VIRTUAL_MACHINE_CORE_FRAME_COMPLETE, virtual_machine_core_run(&vm, UINT64_MAX));
+    ASSERT_EQ(468u, vm.cycles);
+    ASSERT_EQ(6u, vm.frameCycles);
+    ASSERT_EQ(2u, vm.frames);
+}
+
+TEST_F(VirtualMachineCore, DrawingEndsTheFrameWithVipTimingOnly) {
+    uint16_t address = PROGRAM_START_LOCATION;
+    // I = 0x200, then draw a row of the program at V0, V1 in an endless loop
+    for (uint16_t opcode : {0xA200, 0xD011, 0x1202}) {
+        virtual_machine_core_write_opcode_to_memory(&vm, &address, opcode);
+    }
+    virtual_machine_state_t * state = new virtual_machine_state_t;
+    virtual_machine_core_save_state(&vm, state);
+    ASSERT_EQ(VIRTUAL_MACHINE_CORE_FRAME_COMPLETE, virtual_machine_core_run(&vm, UINT64_MAX));
+    ASSERT_EQ(CHIP8_INSTRUCTIONS_PER_FRAME, vm.cycles);
+    virtual_machine_core_restore_state(&vm, state);
+    delete state;
+    vm.timing = VIRTUAL_MACHINE_TIMING_COSMAC_VIP;
+    // The draw waits for the vertical blank, because the frame already spent cycles on the load
+    ASSERT_EQ(VIRTUAL_MACHINE_CORE_FRAME_COMPLETE, virtual_machine_core_run(&vm, UINT64_MAX));
+    ASSERT_EQ(1u, vm.cycles);
+    // The next frame starts with the draw and ends at the next one after the jump
+    ASSERT_EQ(VIRTUAL_MACHINE_CORE_FRAME_COMPLETE, virtual_machine_core_run(&vm, UINT64_MAX));
+    ASSERT_EQ(3u, vm.cycles);
+    ASSERT_EQ(2u, vm.frames);
+}
+
+TEST_F(VirtualMachineCore, ResetRestoresTheWrittenPagesFromTheTemplate) {
+    uint16_t address = PROGRAM_START_LOCATION + 4u;
+    // I = 0x300, store V0 at 0x300, jump back to the increment
+    virtual_machine_core_write_opcode_to_memory(&vm, &address, 0xA300);
+    virtual_machine_core_write_opcode_to_memory(&vm, &address, 0xF055);
+    virtual_machine_core_write_opcode_to_memory(&vm, &address, 0x1202);
+    virtual_machine_state_t * state = new virtual_machine_state_t;
+    virtual_machine_core_capture_template(&vm, state);
+    ASSERT_EQ(VIRTUAL_MACHINE_CORE_FRAME_COMPLETE, virtual_machine_core_run(&vm, UINT64_MAX));
+    ASSERT_NE(0u, virtual_machine_core_read(&vm, 0x300));
+    ASSERT_EQ(1u << 3, vm.dirtyPages[0]);
+    virtual_machine_core_reset(&vm, state);
+    ASSERT_EQ(0u, virtual_machine_core_read(&vm, 0x300));
+    ASSERT_EQ(0u, vm.cycles);
+    ASSERT_EQ(0u, vm.V[0]);
+    ASSERT_EQ(0u, vm.dirtyPages[0]);
+    // The program is executed exactly like after it was loaded
+    ASSERT_EQ(VIRTUAL_MACHINE_CORE_FRAME_COMPLETE, virtual_machine_core_run(&vm, UINT64_MAX));
+    ASSERT_EQ(CHIP8_INSTRUCTIONS_PER_FRAME, vm.cycles);
+    delete state;
+}
+
+TEST(VirtualMachineCoreImage, SharesThePagesUntilTheyAreWritten) {
+    virtual_machine_image_t image;
+    ASSERT_EQ(0, virtual_machine_image_init(&image, VIRTUAL_MACHINE_MODE_CHIP8));
+    // V0 = 0x2A, I = 0x300, store V0 at 0x300, exit
+    uint8_t const program[] = {0x60, 0x2A, 0xA3, 0x00, 0xF0, 0x55, 0x00, 0xFD};
+    std::copy(std::begin(program), std::end(program), image.memory + PROGRAM_START_LOCATION);
+    virtual_machine_core_t first, second;
+    ASSERT_EQ(0, virtual_machine_core_init(&first, VIRTUAL_MACHINE_MODE_CHIP8));
+    ASSERT_EQ(0, virtual_machine_core_init(&second, VIRTUAL_MACHINE_MODE_CHIP8));
+    virtual_machine_core_map_image(&first, &image);
+    virtual_machine_core_map_image(&second, &image);
+    // The character sprites and the program are shared
+    ASSERT_EQ(first.pages[0], second.pages[0]);
+    ASSERT_EQ(first.pages[2], second.pages[2]);
+    virtual_machine_state_t * state = new virtual_machine_state_t;
+    virtual_machine_core_capture_template(&first, state);
+    ASSERT_EQ(VIRTUAL_MACHINE_CORE_EXITED, virtual_machine_core_run(&first, UINT64_MAX));
+    ASSERT_EQ(0x2Au, virtual_machine_core_read(&first, 0x300));
+    ASSERT_EQ(0u, virtual_machine_core_read(&second, 0x300));
+    ASSERT_EQ(0u, image.memory[0x300]);
+    ASSERT_EQ(1u << 3, first.privatePages[0]);
+    // The written page is shared again after a reset
+    virtual_machine_core_reset(&first, state);
+    ASSERT_EQ(0u, first.privatePages[0]);
+    ASSERT_EQ(first.pages[3], second.pages[3]);
+    delete state;
+    virtual_machine_core_free(&first);
+    virtual_machine_core_free(&second);
+    virtual_machine_image_free(&image);
+}
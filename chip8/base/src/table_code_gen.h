@@ -99,11 +99,12 @@
         }                                                                                                        \
         for (size_t i = 0; i < table->allocated; i++) {                                                          \
             if (!table->entries[i] || table->entries[i] == (TYPE##_table_entry_t *)(0xFFFFFFFFFFFFFFFFUL)) {     \
-                break;                                                                                           \
+                continue;                                                                                        \
             }                                                                                                    \
             if (table->entries[i]->key) {                                                                        \
                 free((char *)table->entries[i]->key);                                                            \
             }                                                                                                    \
+            free(table->entries[i]);                                                                             \
         }                                                                                                        \
         free(table->entries);                                                                                    \
         table->allocated = table->used = 0;                                                                      \
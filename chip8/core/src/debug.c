@@ -24,7 +24,7 @@ void debug_print_bytecode(uint16_t memoryLocation, uint16_t opcode) {
     printf("0x%04X: [0x%04X]\n", memoryLocation, opcode);
 }
 
-void debug_trace_execution(virtual_machine_t vm) {
+void debug_trace_execution(virtual_machine_core_t vm) {
     printf("Data registers: [");
     for (uint8_t i = 0; i < 16; i++) {
         printf("0x%02X, ", vm.V[i]);
@@ -40,6 +40,6 @@ void debug_trace_execution(virtual_machine_t vm) {
         printf("0x%04X, ", *stackPointer);
     }
     printf("]\n");
-    printf("Delay timer: 0x%02X\n", vm.delayTimer);
-    printf("Sound timer: 0x%02X\n", vm.soundTimer);
+    printf("Delay timer: 0x%02X\n", virtual_machine_core_timer_value(&vm, &vm.delayTimer));
+    printf("Sound timer: 0x%02X\n", virtual_machine_core_timer_value(&vm, &vm.soundTimer));
 }
@@ -21,9 +21,9 @@
 #ifndef CHIP8_DEBUG_H_
 #define CHIP8_DEBUG_H_
 
-#include "backend_pre_compiled_header.h"
+#include "core_pre_compiled_header.h"
 
-#include "virtual_machine.h"
+#include "virtual_machine_core.h"
 
 /// @brief Prints the opcode stored at the specified memorylocation
 /// @param memoryLocation The memory location of the opcode
@@ -32,6 +32,6 @@ void debug_print_bytecode(uint16_t memoryLocation, uint16_t opcode);
 
 /// @brief Traces the exection of a chip8 program
 /// @param chip8 The virtual machine where the execution is traced
-void debug_trace_execution(virtual_machine_t vm);
+void debug_trace_execution(virtual_machine_core_t vm);
 
 #endif
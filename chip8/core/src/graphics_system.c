@@ -0,0 +1,196 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file graphics_system.c
+ * @brief Definitions regarding the graphics system of the emulator
+ */
+
+#include "graphics_system.h"
+
+/// Iterates over the planes that are currently selected
+#define FOR_EACH_SELECTED_PLANE(graphicsSystem, plane)                  \
+    for (uint8_t plane = 0; plane < GRAPHICS_SYSTEM_PLANE_COUNT; plane++) \
+        if ((graphicsSystem)->selectedPlanes & (1u << plane))
+
+static inline uint64_t graphics_system_rotate_right(uint64_t, uint8_t);
+
+void graphics_system_init(graphics_system_t * graphicsSystem) {
+    graphicsSystem->mode = GRAPHICS_SYSTEM_MODE_LOW_RESOLUTION;
+    graphicsSystem->selectedPlanes = 0b0001;
+    graphicsSystem->usedPlanes = 0b0001;
+    memset(graphicsSystem->planes, 0, sizeof(graphicsSystem->planes));
+}
+
+void graphics_system_clear(graphics_system_t * graphicsSystem) {
+    FOR_EACH_SELECTED_PLANE(graphicsSystem, plane) {
+        memset(graphicsSystem->planes[plane], 0, sizeof(graphicsSystem->planes[plane]));
+    }
+}
+
+void graphics_system_invert(graphics_system_t * graphicsSystem) {
+    uint8_t const height = graphics_system_height(graphicsSystem);
+    uint8_t const words = graphicsSystem->mode == GRAPHICS_SYSTEM_MODE_LOW_RESOLUTION ? 1 : GRAPHICS_SYSTEM_ROW_WORDS;
+    FOR_EACH_SELECTED_PLANE(graphicsSystem, plane) {
+        for (uint8_t y = 0; y < height; y++) {
+            for (uint8_t word = 0; word < words; word++) {
+                graphicsSystem->planes[plane][y][word] = ~graphicsSystem->planes[plane][y][word];
+            }
+        }
+    }
+}
+
+void graphics_system_select_planes(graphics_system_t * graphicsSystem, uint8_t planes) {
+    graphicsSystem->selectedPlanes = planes & (GRAPHICS_SYSTEM_COLOR_COUNT - 1);
+    graphicsSystem->usedPlanes |= graphicsSystem->selectedPlanes;
+}
+
+void graphics_system_set_mode(graphics_system_t * graphicsSystem, graphics_system_mode mode) {
+    graphicsSystem->mode = mode;
+    memset(graphicsSystem->planes, 0, sizeof(graphicsSystem->planes));
+}
+
+bool graphics_system_draw_sprite(graphics_system_t * graphicsSystem, uint8_t x, uint8_t y, uint8_t const * sprite,
+                                 uint8_t height, bool wide, bool clip) {
+    uint8_t const width = graphics_system_width(graphicsSystem);
+    uint8_t const rows = graphics_system_height(graphicsSystem);
+    uint64_t collision = 0;
+    x &= width - 1;
+    y &= rows - 1;
+    // Clipped rows below the screen are not drawn, but the sprite of the next plane still follows all rows
+    uint8_t const visibleRows = clip && y + height > rows ? rows - y : height;
+    FOR_EACH_SELECTED_PLANE(graphicsSystem, plane) {
+        for (uint8_t row = 0; row < visibleRows; row++) {
+            // The sprite row is left-aligned in the word, so that the rotation moves it to the x coordinate
+            uint64_t spriteRow = (uint64_t)sprite[row << wide] << 56;
+            if (wide) {
+                spriteRow |= (uint64_t)sprite[(row << 1) + 1] << 48;
+            }
+            uint64_t * line = graphicsSystem->planes[plane][(y + row) & (rows - 1)];
+            if (graphicsSystem->mode == GRAPHICS_SYSTEM_MODE_LOW_RESOLUTION) {
+                uint64_t const mask = clip ? spriteRow >> x : graphics_system_rotate_right(spriteRow, x);
+                collision |= line[0] & mask;
+                line[0] ^= mask;
+                continue;
+            }
+            // Rotates (or shifts, if the sprite is clipped) the 128-bit row (spriteRow, 0) to the right by x
+            uint64_t high = spriteRow;
+            uint64_t low = 0;
+            if (x & 64) {
+                low = high;
+                high = 0;
+            }
+            uint8_t const shift = x & 63;
+            if (shift) {
+                uint64_t const rotatedHigh = clip ? high >> shift : (high >> shift) | (low << (64 - shift));
+                low = (low >> shift) | (high << (64 - shift));
+                high = rotatedHigh;
+            }
+            collision |= (line[0] & high) | (line[1] & low);
+            line[0] ^= high;
+            line[1] ^= low;
+        }
+        // The sprite of the next selected plane follows directly
+        sprite += height << wide;
+    }
+    return collision != 0;
+}
+
+void graphics_system_scroll_down(graphics_system_t * graphicsSystem, uint8_t amount) {
+    uint8_t const height = graphics_system_height(graphicsSystem);
+    if (amount > height) {
+        amount = height;
+    }
+    FOR_EACH_SELECTED_PLANE(graphicsSystem, plane) {
+        uint64_t(*rows)[GRAPHICS_SYSTEM_ROW_WORDS] = graphicsSystem->planes[plane];
+        memmove(rows[amount], rows[0], (height - amount) * sizeof(rows[0]));
+        memset(rows[0], 0, amount * sizeof(rows[0]));
+    }
+}
+
+void graphics_system_scroll_up(graphics_system_t * graphicsSystem, uint8_t amount) {
+    uint8_t const height = graphics_system_height(graphicsSystem);
+    if (amount > height) {
+        amount = height;
+    }
+    FOR_EACH_SELECTED_PLANE(graphicsSystem, plane) {
+        uint64_t(*rows)[GRAPHICS_SYSTEM_ROW_WORDS] = graphicsSystem->planes[plane];
+        memmove(rows[0], rows[amount], (height - amount) * sizeof(rows[0]));
+        memset(rows[height - amount], 0, amount * sizeof(rows[0]));
+    }
+}
+
+void graphics_system_scroll_left(graphics_system_t * graphicsSystem) {
+    uint8_t const height = graphics_system_height(graphicsSystem);
+    FOR_EACH_SELECTED_PLANE(graphicsSystem, plane) {
+        uint64_t(*rows)[GRAPHICS_SYSTEM_ROW_WORDS] = graphicsSystem->planes[plane];
+        if (graphicsSystem->mode == GRAPHICS_SYSTEM_MODE_LOW_RESOLUTION) {
+            for (uint8_t y = 0; y < height; y++) {
+                rows[y][0] <<= 4;
+            }
+            continue;
+        }
+        for (uint8_t y = 0; y < height; y++) {
+            rows[y][0] = (rows[y][0] << 4) | (rows[y][1] >> 60);
+            rows[y][1] <<= 4;
+        }
+    }
+}
+
+void graphics_system_scroll_right(graphics_system_t * graphicsSystem) {
+    uint8_t const height = graphics_system_height(graphicsSystem);
+    FOR_EACH_SELECTED_PLANE(graphicsSystem, plane) {
+        uint64_t(*rows)[GRAPHICS_SYSTEM_ROW_WORDS] = graphicsSystem->planes[plane];
+        if (graphicsSystem->mode == GRAPHICS_SYSTEM_MODE_LOW_RESOLUTION) {
+            for (uint8_t y = 0; y < height; y++) {
+                rows[y][0] >>= 4;
+            }
+            continue;
+        }
+        for (uint8_t y = 0; y < height; y++) {
+            rows[y][1] = (rows[y][1] >> 4) | (rows[y][0] << 60);
+            rows[y][0] >>= 4;
+        }
+    }
+}
+
+uint64_t graphics_system_hash(graphics_system_t const * graphicsSystem) {
+    uint64_t hash = 0xcbf29ce484222325u;
+    hash = (hash ^ graphicsSystem->mode) * 0x100000001b3u;
+    uint8_t const height = graphics_system_height(graphicsSystem);
+    // Planes that were never used are always empty, so the hash of a classic program only depends on the first plane
+    for (uint8_t plane = 0; plane < GRAPHICS_SYSTEM_PLANE_COUNT; plane++) {
+        if (!(graphicsSystem->usedPlanes & (1u << plane))) {
+            continue;
+        }
+        for (uint8_t y = 0; y < height; y++) {
+            for (uint8_t word = 0; word < GRAPHICS_SYSTEM_ROW_WORDS; word++) {
+                for (uint8_t byte = 0; byte < 8; byte++) {
+                    hash = (hash ^ (uint8_t)(graphicsSystem->planes[plane][y][word] >> (56 - 8 * byte))) *
+                           0x100000001b3u;
+                }
+            }
+        }
+    }
+    return hash;
+}
+
+/// @brief Rotates a word to the right - wraps pixels that leave the right edge of a low resolution row around
+/// @param word The word that is rotated
+/// @param amount The amount of bits the word is rotated (0 - 63)
+/// @return The rotated word
+static inline uint64_t graphics_system_rotate_right(uint64_t word, uint8_t amount) {
+    return amount ? (word >> amount) | (word << (64 - amount)) : word;
+}
@@ -0,0 +1,179 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file graphics_system.h
+ * @brief Declarations regarding the graphics system of the emulator
+ * @details Every row of a plane is stored as 128 bits (two 64-bit words), the most significant bit of the first word
+ * is the leftmost pixel. In low resolution mode only the first word of the first 32 rows is used, so a sprite row is
+ * drawn with a single rotate and xor and a scroll is a word shift or a memmove of whole rows. The XO-CHIP adds
+ * further planes, the color of a pixel is made up of the bits of all planes at its position.
+ */
+
+#ifndef CHIP8_GRAPHICS_SYSTEM_H_
+#define CHIP8_GRAPHICS_SYSTEM_H_
+
+#include "core_pre_compiled_header.h"
+
+// This file is included in the test-suite that is written in c++ using the google-test framework
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The graphics system has a width of 64 pixels in low resolution mode
+#define GRAPHICS_SYSTEM_LOW_RESOLUTION_WIDTH   (64)
+
+/// The graphics system has a height of 32 pixels in low resolution mode
+#define GRAPHICS_SYSTEM_LOW_RESOLUTION_HEIGHT  (32)
+
+/// The graphics system has a width of 128 pixels in high resolution mode (SUPER-CHIP)
+#define GRAPHICS_SYSTEM_HIGH_RESOLUTION_WIDTH  (128)
+
+/// The graphics system has a height of 64 pixels in high resolution mode (SUPER-CHIP)
+#define GRAPHICS_SYSTEM_HIGH_RESOLUTION_HEIGHT (64)
+
+/// The amount of 64-bit words that are used to store a row of the graphics system
+#define GRAPHICS_SYSTEM_ROW_WORDS              (GRAPHICS_SYSTEM_HIGH_RESOLUTION_WIDTH / 64)
+
+/// The amount of planes of the graphics system (XO-CHIP) - 2^4 colors can be displayed
+#define GRAPHICS_SYSTEM_PLANE_COUNT            (4)
+
+/// The amount of colors that can be displayed
+#define GRAPHICS_SYSTEM_COLOR_COUNT            (1 << GRAPHICS_SYSTEM_PLANE_COUNT)
+
+/// @brief The resolution modes of the graphics system
+typedef enum {
+    /// 64x32 pixels - the resolution of the original CHIP-8
+    GRAPHICS_SYSTEM_MODE_LOW_RESOLUTION = 0,
+    /// 128x64 pixels - introduced by the SUPER-CHIP
+    GRAPHICS_SYSTEM_MODE_HIGH_RESOLUTION = 1
+} graphics_system_mode;
+
+/// @brief Models the graphics system of the CHIP-8
+typedef struct {
+    /// The rows of every plane - pixels outside of the current resolution are always cleared
+    uint64_t planes[GRAPHICS_SYSTEM_PLANE_COUNT][GRAPHICS_SYSTEM_HIGH_RESOLUTION_HEIGHT][GRAPHICS_SYSTEM_ROW_WORDS];
+    /// The current resolution mode
+    graphics_system_mode mode;
+    /// Bitmask of the planes that are affected by drawing, clearing and scrolling
+    uint8_t selectedPlanes;
+    /// Bitmask of the planes that were selected since the graphics system was initialized
+    uint8_t usedPlanes;
+} graphics_system_t;
+
+/// @brief Determines the width of the graphics system in the current resolution mode
+/// @param graphicsSystem The graphics system
+/// @return The width in pixels
+static inline uint8_t graphics_system_width(graphics_system_t const * graphicsSystem) {
+    return GRAPHICS_SYSTEM_LOW_RESOLUTION_WIDTH << graphicsSystem->mode;
+}
+
+/// @brief Determines the height of the graphics system in the current resolution mode
+/// @param graphicsSystem The graphics system
+/// @return The height in pixels
+static inline uint8_t graphics_system_height(graphics_system_t const * graphicsSystem) {
+    return GRAPHICS_SYSTEM_LOW_RESOLUTION_HEIGHT << graphicsSystem->mode;
+}
+
+/// @brief Determines the color of a pixel
+/// @param graphicsSystem The graphics system
+/// @param x The x coordinate of the pixel
+/// @param y The y coordinate of the pixel
+/// @return The color of the pixel - bit n is set if the pixel is set in plane n (0 if the pixel is not set at all)
+static inline uint8_t graphics_system_pixel(graphics_system_t const * graphicsSystem, uint8_t x, uint8_t y) {
+    uint8_t color = 0;
+    for (uint8_t plane = 0; plane < GRAPHICS_SYSTEM_PLANE_COUNT; plane++) {
+        color |= ((graphicsSystem->planes[plane][y][x >> 6] >> (63 - (x & 63))) & 1u) << plane;
+    }
+    return color;
+}
+
+/// @brief Determines the size of the planes up to the highest plane that was used
+/// @details Planes that were never used are always empty, so copying this part of the planes copies the whole frame
+/// @param graphicsSystem The graphics system
+/// @return The size of the planes in bytes (the size of the first plane for a classic program)
+static inline size_t graphics_system_used_planes_size(graphics_system_t const * graphicsSystem) {
+    size_t planeCount = 0u;
+    while (graphicsSystem->usedPlanes >> planeCount) {
+        planeCount++;
+    }
+    return planeCount * sizeof(graphicsSystem->planes[0]);
+}
+
+/// @brief Initializes the graphics system in low resolution mode with the first plane selected
+/// @param graphicsSystem The graphics system that is initialized
+void graphics_system_init(graphics_system_t * graphicsSystem);
+
+/// @brief Clears all pixels of the selected planes
+/// @param graphicsSystem The graphics system that is cleared
+void graphics_system_clear(graphics_system_t * graphicsSystem);
+
+/// @brief Toggles all pixels of the selected planes
+/// @param graphicsSystem The graphics system that is inverted
+void graphics_system_invert(graphics_system_t * graphicsSystem);
+
+/// @brief Selects the planes that are affected by drawing, clearing and scrolling (XO-CHIP)
+/// @param graphicsSystem The graphics system where the planes are selected
+/// @param planes Bitmask of the planes that are selected
+void graphics_system_select_planes(graphics_system_t * graphicsSystem, uint8_t planes);
+
+/// @brief Switches the resolution mode and clears all planes
+/// @param graphicsSystem The graphics system where the resolution mode is changed
+/// @param mode The new resolution mode
+void graphics_system_set_mode(graphics_system_t * graphicsSystem, graphics_system_mode mode);
+
+/// @brief Draws a sprite by xoring it onto the selected planes
+/// @details The coordinates always wrap around the edges of the screen. The pixels of a sprite that leave the screen
+/// are either clipped or wrapped around as well
+/// @param graphicsSystem The graphics system where the sprite is drawn
+/// @param x The x coordinate of the sprite
+/// @param y The y coordinate of the sprite
+/// @param sprite The rows of the sprite (one byte per row, or two bytes per row for a wide sprite) - if multiple planes
+/// are selected the rows of every selected plane follow each other, starting with the lowest plane
+/// @param height The amount of rows of the sprite
+/// @param wide Whether the sprite is 16 pixels wide (SUPER-CHIP DXY0) instead of 8
+/// @param clip Whether the pixels that leave the screen are clipped instead of wrapped around
+/// @return true if a set pixel was cleared, false if not
+bool graphics_system_draw_sprite(graphics_system_t * graphicsSystem, uint8_t x, uint8_t y, uint8_t const * sprite,
+                                 uint8_t height, bool wide, bool clip);
+
+/// @brief Scrolls the selected planes down
+/// @param graphicsSystem The graphics system that is scrolled
+/// @param amount The amount of rows the planes are scrolled
+void graphics_system_scroll_down(graphics_system_t * graphicsSystem, uint8_t amount);
+
+/// @brief Scrolls the selected planes up (XO-CHIP)
+/// @param graphicsSystem The graphics system that is scrolled
+/// @param amount The amount of rows the planes are scrolled
+void graphics_system_scroll_up(graphics_system_t * graphicsSystem, uint8_t amount);
+
+/// @brief Scrolls the selected planes 4 pixels to the left
+/// @param graphicsSystem The graphics system that is scrolled
+void graphics_system_scroll_left(graphics_system_t * graphicsSystem);
+
+/// @brief Scrolls the selected planes 4 pixels to the right
+/// @param graphicsSystem The graphics system that is scrolled
+void graphics_system_scroll_right(graphics_system_t * graphicsSystem);
+
+/// @brief Computes a hash of the graphics system
+/// @param graphicsSystem The graphics system that is hashed
+/// @return The 64-bit FNV-1a hash of the mode and the visible rows of every plane that was used
+uint64_t graphics_system_hash(graphics_system_t const * graphicsSystem);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -21,8 +21,7 @@
 #ifndef CHIP8_KEY_BOARD_STATE_H_
 #define CHIP8_KEY_BOARD_STATE_H_
 
-#include "../../../external/SDL/include/SDL.h"
-#include "backend_pre_compiled_header.h"
+#include "core_pre_compiled_header.h"
 
 typedef uint16_t keyBoardState_t;
 
@@ -46,14 +45,24 @@ typedef enum {
     CHIP8_KEY_CODE_F = 0b1000000000000000
 } key_code;
 
-/// @brief Handles a key down event
-/// @param event The event to handle
+/// @brief Applies a key press or release to the state of the keyboard
 /// @param state The state of the keyboard
-void keyboard_handle_key_down_event(SDL_Event event, keyBoardState_t * state);
+/// @param keyCode The key code of the key that was pressed or released
+/// @param pressed Whether the key was pressed or released
+static inline void keyboard_apply(keyBoardState_t * state, keyBoardState_t keyCode, bool pressed) {
+    // Setting and clearing the bit keeps the state consistent if an event is repeated
+    *state = pressed ? (*state | keyCode) : (*state & ~keyCode);
+}
 
-/// @brief Handles a key up event
-/// @param event The event to handle
-/// @param state The state of the keyboard
-void keyboard_handle_key_up_event(SDL_Event event, keyBoardState_t * state);
+/// @brief Determines the index of a key of the CHIP-8 keyboard
+/// @param keyCode The key code of the key
+/// @return The index of the key (0 - 15)
+static inline uint8_t keyboard_key_index(keyBoardState_t keyCode) {
+    uint8_t index = 0u;
+    while (keyCode >>= 1) {
+        index++;
+    }
+    return index;
+}
 
-#endif
\ No newline at end of file
+#endif
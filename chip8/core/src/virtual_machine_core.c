@@ -0,0 +1,686 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file virtual_machine_core.c
+ * @brief Definitions regarding the core of the virtual machine
+ */
+
+#include "virtual_machine_core.h"
+
+#if defined(PRINT_BYTE_CODE) || defined(TRACE_EXECUTION)
+#include "debug.h"
+#endif
+#include "../../base/src/chip8.h"
+
+/// Defines a new 8-bit value based on the opcode that is currently executed
+#define DEFINE_8_BIT_VALUE           uint8_t value = vm->currentOpcode & 0x00ff;
+
+/// Defines a new 12-bit value based on the opcode that is currently executed
+#define DEFINE_12_BIT_VALUE          uint16_t value = vm->currentOpcode & 0x0fff;
+
+/// Defines a new 4-bit value based on the opcode that is currently executed
+#define DEFINE_X                     uint8_t x = (vm->currentOpcode & 0x0f00u) >> 8;
+
+/// Defines a new 4-bit value based on the opcode that is currently executed
+#define DEFINE_Y                     uint8_t y = (vm->currentOpcode & 0x00f0u) >> 4;
+
+/// The machine cycles of the COSMAC VIP per frame (1.76 MHz with 8 clock cycles per machine cycle at 60 Hz)
+#define COSMAC_VIP_CYCLES_PER_FRAME  (3668u)
+
+/// The machine cycles per frame that are left for the interpreter - the display DMA and the interrupt routine take
+/// about 1100 cycles of every frame
+#define COSMAC_VIP_FRAME_BUDGET      (COSMAC_VIP_CYCLES_PER_FRAME - 1100u)
+
+/// The seed of the pseudo random number generator that is used if no other seed is specified
+#define CHIP8_DEFAULT_SEED           (0x2545F491u)
+
+/// The character sprites that are stored in memory (from 0x)
+#define CHARACTER_SPRITES                                                                                           \
+    ("\xF0\x90\x90\x90\xF0\x20\x60\x20\x20\x70\xF0\x10\xF0\x80\xF0\xF0\x10\xF0\x10\xF0\x90\x90\xF0\x10\x10\xF0\x80" \
+     "\xF0\x10\xF0\xF0\x80\xF0\x90\xF0\xF0\x10\x20\x40\x40\xF0\x90\xF0\x90\xF0\xF0\x90\xF0\x10\xF0\xF0\x90\xF0\x90" \
+     "\x90\xE0\x90\xE0\x90\xE0\xF0\x80\x80\x80\xF0\xE0\x90\x90\x90\xE0\xF0\x80\xF0\x80\xF0\xF0\x80\xF0\x80\x80")
+
+/// The address where the character sprites are stored in memory
+#define CHARACTER_SPRITES_LOCATION          (0x0050)
+
+/// The large character sprites of the SUPER-CHIP that are stored in memory (8x10 pixels)
+#define LARGE_CHARACTER_SPRITES                                                                                     \
+    ("\xFF\xFF\xC3\xC3\xC3\xC3\xC3\xC3\xFF\xFF\x18\x78\x78\x18\x18\x18\x18\x18\xFF\xFF\xFF\xFF\x03\x03\xFF\xFF\xC0" \
+     "\xC0\xFF\xFF\xFF\xFF\x03\x03\xFF\xFF\x03\x03\xFF\xFF\xC3\xC3\xC3\xC3\xFF\xFF\x03\x03\x03\x03\xFF\xFF\xC0\xC0" \
+     "\xFF\xFF\x03\x03\xFF\xFF\xFF\xFF\xC0\xC0\xFF\xFF\xC3\xC3\xFF\xFF\xFF\xFF\x03\x03\x06\x0C\x18\x18\x18\x18\xFF" \
+     "\xFF\xC3\xC3\xFF\xFF\xC3\xC3\xFF\xFF\xFF\xFF\xC3\xC3\xFF\xFF\x03\x03\xFF\xFF\x7E\xFF\xC3\xC3\xC3\xFF\xFF\xC3" \
+     "\xC3\xC3\xFC\xFC\xC3\xC3\xFC\xFC\xC3\xC3\xFC\xFC\x3C\xFF\xC3\xC0\xC0\xC0\xC0\xC3\xFF\x3C\xFC\xFE\xC3\xC3\xC3" \
+     "\xC3\xC3\xC3\xFE\xFC\xFF\xFF\xC0\xC0\xFF\xFF\xC0\xC0\xFF\xFF\xFF\xFF\xC0\xC0\xFF\xFF\xC0\xC0\xC0\xC0")
+
+/// The address where the large character sprites are stored in memory (directly after the character sprites)
+#define LARGE_CHARACTER_SPRITES_LOCATION    (0x00A0)
+
+/// The page every page of the memory is shared with until it is written - only read by the virtual machines
+static uint8_t virtual_machine_zero_page[VIRTUAL_MACHINE_PAGE_SIZE];
+
+/// @brief The results of the execution of an opcode by the interpreter
+typedef enum {
+    /// The opcode was executed
+    VIRTUAL_MACHINE_OPCODE_EXECUTED = 0,
+    /// The program exited
+    VIRTUAL_MACHINE_OPCODE_EXITED = 1,
+    /// FX0A waits for a key press - the program counter was rewound, so the instruction is executed again
+    VIRTUAL_MACHINE_OPCODE_WAITING_FOR_KEY = 2,
+    /// The opcode is unknown
+    VIRTUAL_MACHINE_OPCODE_UNKNOWN = -1,
+    /// 2NNN was executed with a full stack or 00EE with an empty one
+    VIRTUAL_MACHINE_OPCODE_INVALID_STACK = -2
+} virtual_machine_opcode_result;
+
+/// @brief Executes the opcode that is currently held by the virtual machine (see virtual_machine_interpreter.inc)
+typedef int8_t (*virtual_machine_interpreter_t)(virtual_machine_core_t *, keyBoardState_t);
+
+static inline uint64_t virtual_machine_compiled_stop_cycle(virtual_machine_core_t const *, uint64_t);
+static void virtual_machine_end_frame(virtual_machine_core_t *);
+static int8_t virtual_machine_execute_next_opcode_vip(virtual_machine_core_t *, keyBoardState_t);
+static int8_t virtual_machine_execute_next_opcode_schip(virtual_machine_core_t *, keyBoardState_t);
+static int8_t virtual_machine_execute_next_opcode_xo_chip(virtual_machine_core_t *, keyBoardState_t);
+static inline void virtual_machine_key_read(virtual_machine_core_t *, uint8_t);
+static inline int8_t virtual_machine_character_index(uint8_t);
+static inline uint8_t virtual_machine_random_byte(virtual_machine_core_t *);
+static inline bool virtual_machine_frame_complete(virtual_machine_core_t const *);
+static inline void virtual_machine_set_timer(virtual_machine_core_t const *, virtual_machine_timer_t *, uint8_t);
+static inline void virtual_machine_skip_next_instruction(virtual_machine_core_t *);
+static inline uint64_t virtual_machine_tick(virtual_machine_core_t const *);
+static inline uint8_t virtual_machine_timer_value_at(virtual_machine_timer_t const *, uint64_t);
+static inline void virtual_machine_restore_registers(virtual_machine_core_t *, virtual_machine_state_t const *);
+static inline uint8_t virtual_machine_lowest_bit(uint64_t);
+static void virtual_machine_restore_page(virtual_machine_core_t *, uint16_t, uint8_t const *);
+static void virtual_machine_release_private_pages(virtual_machine_core_t *);
+static inline uint8_t * virtual_machine_shared_page(uint8_t *);
+static void virtual_machine_mark_all_pages_dirty(virtual_machine_core_t *);
+
+/// The interpreters that are specialized for the quirk profiles, indexed by virtual_machine_quirks
+static virtual_machine_interpreter_t const virtual_machine_interpreters[VIRTUAL_MACHINE_QUIRKS_COUNT] = {
+    virtual_machine_execute_next_opcode_vip, virtual_machine_execute_next_opcode_schip,
+    virtual_machine_execute_next_opcode_xo_chip};
+
+/// @brief Initializes the core of the chip8 vm
+/// @details The memory is sized based on the mode, so classic programs keep a compact memory footprint
+/// @param vm The core of the chip8 virtual machine that is initialzed
+/// @param mode The mode of the virtual machine
+/// @return 0 if everything went well, -1 if the memory could not be allocated
+int virtual_machine_core_init(virtual_machine_core_t * vm, virtual_machine_mode mode) {
+    memset(vm->V, 0, sizeof(vm->V));
+    // Initialize stackpointer
+    vm->stackPointer = vm->stack;
+    // Initialize program counter
+    vm->programCounter = 0u;
+    vm->cycles = 0u;
+    vm->frames = 0u;
+    vm->frameCycles = 0u;
+    vm->timing = VIRTUAL_MACHINE_TIMING_FIXED;
+    vm->compiledProgram = NULL;
+    // Initialize the remaining registers, so the execution of a program is reproducible
+    vm->currentOpcode = 0u;
+    vm->I = 0u;
+    vm->delayTimer = (virtual_machine_timer_t){0u, 0u};
+    vm->soundTimer = (virtual_machine_timer_t){0u, 0u};
+    vm->keyBoardState = 0u;
+    memset(vm->userFlags, 0, sizeof(vm->userFlags));
+    memset(vm->audioPattern, 0, sizeof(vm->audioPattern));
+    vm->pitch = 64u;
+    vm->silent = false;
+    vm->keyRead = NULL;
+    vm->keyReadContext = NULL;
+    graphics_system_init(&vm->graphicsSystem);
+    virtual_machine_core_seed(vm, CHIP8_DEFAULT_SEED);
+    // Initialize memory
+    vm->mode = mode;
+    // Programs that are not written for a specific interpreter are executed with the quirks of the mode. The CHIP-8
+    // mode also executes SUPER-CHIP programs and used their behavior before there were quirk profiles, so it keeps
+    // the SUPER-CHIP profile - programs for the COSMAC VIP select it explicitly (or let the analysis suggest it)
+    vm->quirks = mode == VIRTUAL_MACHINE_MODE_XO_CHIP ? VIRTUAL_MACHINE_QUIRKS_XO_CHIP : VIRTUAL_MACHINE_QUIRKS_SCHIP;
+    size_t memorySize = mode == VIRTUAL_MACHINE_MODE_XO_CHIP ? VIRTUAL_MACHINE_XO_CHIP_MEMORY_SIZE
+                                                             : VIRTUAL_MACHINE_MEMORY_SIZE;
+    vm->memoryMask = (uint16_t)(memorySize - 1);
+    vm->pages = (uint8_t **)malloc(memorySize / VIRTUAL_MACHINE_PAGE_SIZE * sizeof(uint8_t *));
+    if (!vm->pages) {
+        // The caller reports the error - silent is only set after the initialization
+        return -1;
+    }
+    // Every page is shared with the zero page until it is written
+    for (uint16_t page = 0u; page < memorySize / VIRTUAL_MACHINE_PAGE_SIZE; page++) {
+        vm->pages[page] = virtual_machine_zero_page;
+    }
+    memset(vm->privatePages, 0, sizeof(vm->privatePages));
+    vm->image = NULL;
+    // Setting up Hex character sprites in memory
+    for (uint16_t i = 0u; i < sizeof(CHARACTER_SPRITES) - 1u; i++) {
+        virtual_machine_core_write(vm, CHARACTER_SPRITES_LOCATION + i, (uint8_t)CHARACTER_SPRITES[i]);
+    }
+    for (uint16_t i = 0u; i < sizeof(LARGE_CHARACTER_SPRITES) - 1u; i++) {
+        virtual_machine_core_write(vm, LARGE_CHARACTER_SPRITES_LOCATION + i, (uint8_t)LARGE_CHARACTER_SPRITES[i]);
+    }
+    memset(vm->dirtyPages, 0, sizeof(vm->dirtyPages));
+    return 0;
+}
+
+/// @brief Frees the memory of the chip8 vm
+/// @param vm The chip8 virtual machine whose memory is freed
+void virtual_machine_core_free(virtual_machine_core_t * vm) {
+    virtual_machine_release_private_pages(vm);
+    free(vm->pages);
+    vm->pages = NULL;
+}
+
+/// @brief Seeds the pseudo random number generator of the virtual machine
+/// @details The generator does not depend on the C library, so a seed produces the same numbers on every platform
+/// @param vm The chip8 virtual machine whose random number generator is seeded
+/// @param seed The seed - zero is replaced by the default seed, because xorshift would only produce zeros
+void virtual_machine_core_seed(virtual_machine_core_t * vm, uint32_t seed) {
+    vm->randomState = seed ? seed : CHIP8_DEFAULT_SEED;
+}
+
+/// @brief Determines the cost of an instruction on the COSMAC VIP
+/// @details The costs are approximations of the machine cycles the interpreter of the COSMAC VIP needs to fetch,
+/// decode and execute an instruction. Instructions of the SUPER-CHIP and XO-CHIP are charged like a register load.
+/// The cost is used by the COSMAC VIP timing and can be used to weight the instructions of a profile
+/// @param opcode The opcode of the instruction
+/// @return The amount of machine cycles of the instruction (without the wait of DXYN for the vertical blank)
+uint16_t virtual_machine_core_cycle_cost(uint16_t opcode) {
+    // The costs of the instructions that do not depend on the operands, indexed by the first nibble of the opcode
+    static uint16_t const costs[16] = {12u, 12u, 26u, 10u, 10u, 14u, 6u, 10u, 44u, 14u, 12u, 22u, 36u, 0u, 14u, 10u};
+    uint8_t const x = (opcode & 0x0f00u) >> 8;
+    switch (opcode & 0xf000) {
+    case 0x0000:
+        if (opcode == 0x00E0) {
+            return 24u;
+        }
+        return opcode == 0x00EE ? 10u : costs[0];
+    case 0xd000:
+        // Every row is shifted into place and combined with the display - DXY0 draws 16 rows of 16 pixels
+        return 68u + 32u * ((opcode & 0x000f) ? (opcode & 0x000f) : 32u);
+    case 0xf000:
+        switch (opcode & 0x00ff) {
+        case 0x1e:
+            return 18u;
+        case 0x29:
+            return 20u;
+        case 0x33:
+            return 204u;
+        case 0x55:
+        case 0x65:
+            return 28u + 14u * (x + 1u);
+        default:
+            return costs[0xf];
+        }
+    default:
+        return costs[(opcode & 0xf000) >> 12];
+    }
+}
+
+/// @brief Determines the current value of a timer of the virtual machine
+/// @param vm The chip8 virtual machine the timer belongs to
+/// @param timer The delay or the sound timer of the virtual machine
+/// @return The value of the timer at the instruction that is currently executed
+uint8_t virtual_machine_core_timer_value(virtual_machine_core_t const * vm, virtual_machine_timer_t const * timer) {
+    return virtual_machine_timer_value_at(timer, virtual_machine_tick(vm));
+}
+
+/// @brief Saves the state of the virtual machine
+/// @details Only the used part of the memory is copied, so saving the state of a CHIP-8 program copies about 8 KB
+/// @param vm The chip8 virtual machine whose state is saved
+/// @param state The snapshot where the state is written to
+void virtual_machine_core_save_state(virtual_machine_core_t const * vm, virtual_machine_state_t * state) {
+    state->currentOpcode = vm->currentOpcode;
+    state->I = vm->I;
+    state->programCounter = vm->programCounter;
+    state->delayTimer = vm->delayTimer;
+    state->soundTimer = vm->soundTimer;
+    state->stackDepth = (uint8_t)(vm->stackPointer - vm->stack);
+    memcpy(state->stack, vm->stack, sizeof(vm->stack));
+    memcpy(state->V, vm->V, sizeof(vm->V));
+    memcpy(state->userFlags, vm->userFlags, sizeof(vm->userFlags));
+    state->cycles = vm->cycles;
+    state->frames = vm->frames;
+    state->frameCycles = vm->frameCycles;
+    state->keyBoardState = vm->keyBoardState;
+    state->randomState = vm->randomState;
+    memcpy(state->audioPattern, vm->audioPattern, sizeof(vm->audioPattern));
+    state->pitch = vm->pitch;
+    state->graphicsSystem = vm->graphicsSystem;
+    for (uint16_t page = 0u; page < (vm->memoryMask + 1u) / VIRTUAL_MACHINE_PAGE_SIZE; page++) {
+        memcpy(state->memory + page * VIRTUAL_MACHINE_PAGE_SIZE, vm->pages[page], VIRTUAL_MACHINE_PAGE_SIZE);
+    }
+}
+
+/// @brief Restores a state of the virtual machine that was saved by virtual_machine_save_state
+/// @param vm The chip8 virtual machine whose state was saved before (the mode must not have changed)
+/// @param state The snapshot that is restored
+void virtual_machine_core_restore_state(virtual_machine_core_t * vm, virtual_machine_state_t const * state) {
+    virtual_machine_restore_registers(vm, state);
+    for (uint16_t page = 0u; page < (vm->memoryMask + 1u) / VIRTUAL_MACHINE_PAGE_SIZE; page++) {
+        virtual_machine_restore_page(vm, page, state->memory + page * VIRTUAL_MACHINE_PAGE_SIZE);
+    }
+    // The memory may differ from a template in every page now
+    virtual_machine_mark_all_pages_dirty(vm);
+}
+
+/// @brief Saves the state of a virtual machine whose program was loaded as the template it is reset to
+/// @param vm The chip8 virtual machine whose program was loaded
+/// @param state The snapshot where the template is written to
+void virtual_machine_core_capture_template(virtual_machine_core_t * vm, virtual_machine_state_t * state) {
+    virtual_machine_core_save_state(vm, state);
+    memset(vm->dirtyPages, 0, sizeof(vm->dirtyPages));
+}
+
+/// @brief Resets the virtual machine to a template that was captured by virtual_machine_core_capture_template
+/// @details Only the pages of the memory that were written since the last reset are copied from the template, so a
+/// program does not have to be loaded again and a reset costs little more than copying the registers
+/// @param vm The chip8 virtual machine the template was captured from
+/// @param state The template
+void virtual_machine_core_reset(virtual_machine_core_t * vm, virtual_machine_state_t const * state) {
+    virtual_machine_restore_registers(vm, state);
+    uint16_t const pageCount = (vm->memoryMask + 1u) / VIRTUAL_MACHINE_PAGE_SIZE;
+    for (uint16_t word = 0u; word < (pageCount + 63u) / 64u; word++) {
+        for (uint64_t pages = vm->dirtyPages[word]; pages; pages &= pages - 1u) {
+            uint16_t const page = word * 64u + virtual_machine_lowest_bit(pages);
+            virtual_machine_restore_page(vm, page, state->memory + page * VIRTUAL_MACHINE_PAGE_SIZE);
+        }
+        vm->dirtyPages[word] = 0u;
+    }
+}
+
+/// @brief Copies a shared page of the memory, so the virtual machine can write it
+/// @param vm The chip8 virtual machine
+/// @param page The index of the page that is copied
+/// @return 0 if the page was copied, -1 if the copy could not be allocated
+int virtual_machine_core_copy_page(virtual_machine_core_t * vm, uint16_t page) {
+    uint8_t * copy = (uint8_t *)malloc(VIRTUAL_MACHINE_PAGE_SIZE);
+    if (!copy) {
+        if (!vm->silent) {
+            printf("Could not allocate a page of the memory of the virtual machine\n");
+        }
+        return -1;
+    }
+    memcpy(copy, vm->pages[page], VIRTUAL_MACHINE_PAGE_SIZE);
+    vm->pages[page] = copy;
+    vm->privatePages[page >> 6] |= 1ull << (page & 63u);
+    return 0;
+}
+
+/// @brief Initializes an image that a program can be loaded into
+/// @param image The image that is initialized - contains the character sprites afterwards
+/// @param mode The mode of the virtual machines the image is mapped by
+/// @return 0 if everything went well, -1 if the memory could not be allocated
+int virtual_machine_image_init(virtual_machine_image_t * image, virtual_machine_mode mode) {
+    size_t memorySize = mode == VIRTUAL_MACHINE_MODE_XO_CHIP ? VIRTUAL_MACHINE_XO_CHIP_MEMORY_SIZE
+                                                             : VIRTUAL_MACHINE_MEMORY_SIZE;
+    image->memoryMask = (uint16_t)(memorySize - 1);
+    image->memory = (uint8_t *)calloc(memorySize, sizeof(uint8_t));
+    if (!image->memory) {
+        // The caller reports the error, the image does not know whether it may write to the output
+        return -1;
+    }
+    memcpy(image->memory + CHARACTER_SPRITES_LOCATION, CHARACTER_SPRITES, sizeof(CHARACTER_SPRITES) - 1u);
+    memcpy(image->memory + LARGE_CHARACTER_SPRITES_LOCATION, LARGE_CHARACTER_SPRITES,
+           sizeof(LARGE_CHARACTER_SPRITES) - 1u);
+    return 0;
+}
+
+/// @brief Frees the memory of an image - no virtual machine may map the image anymore
+/// @param image The image whose memory is freed
+void virtual_machine_image_free(virtual_machine_image_t * image) {
+    free(image->memory);
+    image->memory = NULL;
+}
+
+/// @brief Maps the pages of an image into the memory of the virtual machine
+/// @details The pages are shared until they are written, pages that only contain zeros are shared with the zero page
+/// @param vm The chip8 virtual machine - the mode must match the mode of the image
+/// @param image The image that is mapped
+void virtual_machine_core_map_image(virtual_machine_core_t * vm, virtual_machine_image_t const * image) {
+    virtual_machine_release_private_pages(vm);
+    vm->image = image;
+    for (uint16_t page = 0u; page < (vm->memoryMask + 1u) / VIRTUAL_MACHINE_PAGE_SIZE; page++) {
+        vm->pages[page] = virtual_machine_shared_page(image->memory + page * VIRTUAL_MACHINE_PAGE_SIZE);
+    }
+    // The memory may differ from a template in every page now
+    virtual_machine_mark_all_pages_dirty(vm);
+}
+
+/// @brief Writtes the specified opcode at the specified location into memory
+/// @param vm The chip8 where the opcode is written to memory
+/// @param memoryLocation The location where the opcode is written to (0x200 up to the end of the memory)
+/// @param opcode The opcode that is written into memory
+void virtual_machine_core_write_opcode_to_memory(virtual_machine_core_t * vm, uint16_t * memoryLocation,
+                                                 uint16_t opcode) {
+    if (*memoryLocation >= vm->memoryMask || *memoryLocation < PROGRAM_START_LOCATION) {
+        return;
+    }
+#ifdef PRINT_BYTE_CODE
+    debug_print_bytecode(*memoryLocation, opcode);
+#endif
+    virtual_machine_core_write(vm, (*memoryLocation)++, (opcode & 0xff00) >> 8);
+    virtual_machine_core_write(vm, (*memoryLocation)++, opcode & 0x00ff);
+}
+
+/// @brief Writtes the specified opcode at the specified location into memory
+/// @param vm The chip8 where the opcode is written to memory
+/// @param memoryLocation The location where the opcode is written to (0x200 up to the end of the memory)
+/// @param byte The byte that is written into memory
+void virtual_machine_core_write_byte_to_memory(virtual_machine_core_t * vm, uint16_t * memoryLocation, uint8_t byte) {
+    if (*memoryLocation > vm->memoryMask || *memoryLocation < PROGRAM_START_LOCATION) {
+        return;
+    }
+    virtual_machine_core_write(vm, (*memoryLocation)++, byte);
+}
+
+/// @brief Determines the index of the character that is stored in a register
+/// @param value The value of the register - either a hexadecimal digit (0x0 - 0xF) or its ASCII representation
+/// @return The index of the character (0 - 15), -1 if the value does not represent a character
+static inline int8_t virtual_machine_character_index(uint8_t value) {
+    if (value <= 0xF) {
+        return value;
+    } else if (value <= '9' && value >= '0') {
+        return value - '0';
+    } else if (value <= 'F' && value >= 'A') {
+        return value - 'A' + 10;
+    }
+    return -1;
+}
+
+/// @brief Generates the next pseudo random byte (xorshift32)
+/// @param vm The virtual machine whose random number generator is used
+/// @return The next random byte
+static inline uint8_t virtual_machine_random_byte(virtual_machine_core_t * vm) {
+    vm->randomState ^= vm->randomState << 13;
+    vm->randomState ^= vm->randomState >> 17;
+    vm->randomState ^= vm->randomState << 5;
+    return (uint8_t)(vm->randomState >> 24);
+}
+
+/// @brief Executes instructions until the current frame is complete or the amount of executed instructions reaches
+/// stopCycle
+/// @details The frame boundaries are derived from the amount of executed instructions (or the machine cycles with the
+/// timing of the COSMAC VIP), so an execution that is stopped and resumed behaves exactly like one that was not
+/// interrupted. The caller uses stopCycle to apply key events or take screenshots at a specific instruction
+/// @param vm The core of the chip8 vm where the program that is currently held in memory is executed
+/// @param stopCycle The amount of executed instructions at which the execution stops (UINT64_MAX if it only stops at
+/// the end of the frame)
+/// @return The reason the execution returned (see virtual_machine_core_result)
+int8_t virtual_machine_core_run(virtual_machine_core_t * vm, uint64_t stopCycle) {
+    // The quirks are resolved once per call - the interpreter of the profile checks none of them
+    virtual_machine_interpreter_t const execute_next_opcode = virtual_machine_interpreters[vm->quirks];
+    for (;;) {
+        if (vm->cycles >= stopCycle) {
+            return VIRTUAL_MACHINE_CORE_STOPPED;
+        }
+        // Reached end of the memory
+        if (vm->programCounter >= ((vm->memoryMask + 1u - PROGRAM_START_LOCATION) / 2)) {
+            return VIRTUAL_MACHINE_CORE_EXITED;
+        }
+        if (vm->compiledProgram && vm->timing == VIRTUAL_MACHINE_TIMING_FIXED &&
+            vm->compiledProgram(vm, virtual_machine_compiled_stop_cycle(vm, stopCycle)) ==
+                VIRTUAL_MACHINE_COMPILED_YIELDED) {
+            if (virtual_machine_frame_complete(vm)) {
+                break;
+            }
+            continue;
+        }
+        // The instruction that was not translated is executed by the interpreter
+#ifdef TRACE_EXECUTION
+        debug_trace_execution(*vm);
+#endif
+        // Both bytes of an instruction are on the same page, because instructions start at even addresses
+        uint16_t const address = vm->programCounter * 2 + PROGRAM_START_LOCATION;
+        uint8_t const * instruction =
+            vm->pages[address / VIRTUAL_MACHINE_PAGE_SIZE] + address % VIRTUAL_MACHINE_PAGE_SIZE;
+        vm->currentOpcode = (uint16_t)(instruction[0] << 8 | instruction[1]);
+        // Reached end of the program
+        if (!vm->currentOpcode) {
+            return VIRTUAL_MACHINE_CORE_EXITED;
+        }
+        if (vm->timing == VIRTUAL_MACHINE_TIMING_COSMAC_VIP) {
+            // DXYN waits for the vertical blank, so the sprite is drawn at the start of the next frame
+            if ((vm->currentOpcode & 0xf000) == 0xd000 && vm->frameCycles) {
+                break;
+            }
+            vm->frameCycles += virtual_machine_core_cycle_cost(vm->currentOpcode);
+        }
+        // Executes next opcode
+        int8_t const result = execute_next_opcode(vm, vm->keyBoardState);
+        if (result == VIRTUAL_MACHINE_OPCODE_EXITED) {
+            return VIRTUAL_MACHINE_CORE_EXITED;
+        } else if (result == VIRTUAL_MACHINE_OPCODE_UNKNOWN || result == VIRTUAL_MACHINE_OPCODE_INVALID_STACK) {
+            return VIRTUAL_MACHINE_CORE_ERROR;
+        }
+        vm->programCounter++;
+        vm->cycles++;
+        if (virtual_machine_frame_complete(vm)) {
+            break;
+        }
+        if (result == VIRTUAL_MACHINE_OPCODE_WAITING_FOR_KEY) {
+            return VIRTUAL_MACHINE_CORE_WAITING_FOR_KEY;
+        }
+    }
+    virtual_machine_end_frame(vm);
+    return VIRTUAL_MACHINE_CORE_FRAME_COMPLETE;
+}
+
+/// @brief Determines the amount of instructions after which a translated program has to stop
+/// @details The translated program returns before the frame ends or the caller has to regain control, so both happen
+/// at the same instruction as in the interpreter
+/// @param vm The core of the chip8 virtual machine
+/// @param stopCycle The amount of executed instructions at which the caller regains control
+/// @return The amount of instructions at which the translated program stops
+static inline uint64_t virtual_machine_compiled_stop_cycle(virtual_machine_core_t const * vm, uint64_t stopCycle) {
+    uint64_t const frameEnd = (vm->cycles / CHIP8_INSTRUCTIONS_PER_FRAME + 1u) * CHIP8_INSTRUCTIONS_PER_FRAME;
+    return frameEnd < stopCycle ? frameEnd : stopCycle;
+}
+
+/// @brief Ends the current frame - the timers tick once per frame
+/// @param vm The core of the chip8 virtual machine
+static void virtual_machine_end_frame(virtual_machine_core_t * vm) {
+    // The timers count down on their own - the sound is played for every frame the sound timer was active in
+    if (!vm->silent && virtual_machine_timer_value_at(&vm->soundTimer, vm->frames)) {
+        putc('\a', stdout);
+    }
+    vm->frames++;
+    // The cycles an instruction took beyond the end of the frame are taken from the next frame
+    vm->frameCycles = vm->frameCycles > COSMAC_VIP_FRAME_BUDGET ? vm->frameCycles - COSMAC_VIP_FRAME_BUDGET : 0u;
+}
+
+/// @brief Notifies the embedding program that the program reads a key
+/// @param vm The core of the chip8 virtual machine that reads the key
+/// @param keyIndex The index of the key that is read
+static inline void virtual_machine_key_read(virtual_machine_core_t * vm, uint8_t keyIndex) {
+    if (vm->keyRead) {
+        vm->keyRead(vm->keyReadContext, keyIndex);
+    }
+}
+
+/// @brief Determines the current tick of the timers
+/// @details The timers tick at the end of every frame, so the tick is the index of the frame that is executed
+/// @param vm The chip8 virtual machine
+/// @return The amount of ticks since the start of the execution
+static inline uint64_t virtual_machine_tick(virtual_machine_core_t const * vm) {
+    return vm->frames;
+}
+
+/// @brief Determines whether the current frame is complete
+/// @param vm The chip8 virtual machine
+/// @return true if the instructions of the current frame were executed, false if not
+static inline bool virtual_machine_frame_complete(virtual_machine_core_t const * vm) {
+    if (vm->timing == VIRTUAL_MACHINE_TIMING_COSMAC_VIP) {
+        return vm->frameCycles >= COSMAC_VIP_FRAME_BUDGET;
+    }
+    // The frame boundaries are derived from the executed instructions, so a stopped execution resumes mid-frame
+    return !(vm->cycles % CHIP8_INSTRUCTIONS_PER_FRAME);
+}
+
+/// @brief Determines the value of a timer at a tick
+/// @param timer The timer
+/// @param tick The tick (not before the tick the timer was set at)
+/// @return The value of the timer, which is decremented at every tick until it reaches zero
+static inline uint8_t virtual_machine_timer_value_at(virtual_machine_timer_t const * timer, uint64_t tick) {
+    uint64_t elapsedTicks = tick - timer->tick;
+    return elapsedTicks < timer->value ? (uint8_t)(timer->value - elapsedTicks) : 0u;
+}
+
+/// @brief Sets a timer of the virtual machine
+/// @param vm The chip8 virtual machine the timer belongs to
+/// @param timer The delay or the sound timer of the virtual machine
+/// @param value The value the timer starts counting down from
+static inline void virtual_machine_set_timer(virtual_machine_core_t const * vm, virtual_machine_timer_t * timer,
+                                             uint8_t value) {
+    timer->value = value;
+    timer->tick = virtual_machine_tick(vm);
+}
+
+/// @brief Skips the next instruction
+/// @details The long load of the XO-CHIP (F000 NNNN) occupies two instructions and is skipped as a whole
+/// @param vm The chip8 virtual machine where the next instruction is skipped
+static inline void virtual_machine_skip_next_instruction(virtual_machine_core_t * vm) {
+    vm->programCounter++;
+    uint16_t address = vm->programCounter * 2 + PROGRAM_START_LOCATION;
+    if (vm->mode == VIRTUAL_MACHINE_MODE_XO_CHIP && virtual_machine_core_read(vm, address) == 0xF0 &&
+        !virtual_machine_core_read(vm, address + 1)) {
+        vm->programCounter++;
+    }
+}
+
+// COSMAC VIP - the original behavior of the CHIP-8 interpreter
+#define VIRTUAL_MACHINE_INTERPRETER                   virtual_machine_execute_next_opcode_vip
+#define VIRTUAL_MACHINE_QUIRK_SHIFT_USES_VY           (true)
+#define VIRTUAL_MACHINE_QUIRK_LOAD_STORE_INCREMENTS_I (true)
+#define VIRTUAL_MACHINE_QUIRK_JUMP_USES_VX            (false)
+#define VIRTUAL_MACHINE_QUIRK_LOGIC_RESETS_VF         (true)
+#define VIRTUAL_MACHINE_QUIRK_SPRITES_CLIP            (true)
+#include "virtual_machine_interpreter.inc"
+
+// SUPER-CHIP 1.1 on the HP 48
+#define VIRTUAL_MACHINE_INTERPRETER                   virtual_machine_execute_next_opcode_schip
+#define VIRTUAL_MACHINE_QUIRK_SHIFT_USES_VY           (false)
+#define VIRTUAL_MACHINE_QUIRK_LOAD_STORE_INCREMENTS_I (false)
+#define VIRTUAL_MACHINE_QUIRK_JUMP_USES_VX            (true)
+#define VIRTUAL_MACHINE_QUIRK_LOGIC_RESETS_VF         (false)
+#define VIRTUAL_MACHINE_QUIRK_SPRITES_CLIP            (true)
+#include "virtual_machine_interpreter.inc"
+
+// XO-CHIP as implemented by Octo
+#define VIRTUAL_MACHINE_INTERPRETER                   virtual_machine_execute_next_opcode_xo_chip
+#define VIRTUAL_MACHINE_QUIRK_SHIFT_USES_VY           (true)
+#define VIRTUAL_MACHINE_QUIRK_LOAD_STORE_INCREMENTS_I (true)
+#define VIRTUAL_MACHINE_QUIRK_JUMP_USES_VX            (false)
+#define VIRTUAL_MACHINE_QUIRK_LOGIC_RESETS_VF         (false)
+#define VIRTUAL_MACHINE_QUIRK_SPRITES_CLIP            (false)
+#include "virtual_machine_interpreter.inc"
+
+/// @brief Restores everything but the memory from a snapshot of the virtual machine
+/// @param vm The chip8 virtual machine whose state was saved before
+/// @param state The snapshot that is restored
+static inline void virtual_machine_restore_registers(virtual_machine_core_t * vm,
+                                                     virtual_machine_state_t const * state) {
+    vm->currentOpcode = state->currentOpcode;
+    vm->I = state->I;
+    vm->programCounter = state->programCounter;
+    vm->delayTimer = state->delayTimer;
+    vm->soundTimer = state->soundTimer;
+    vm->stackPointer = vm->stack + state->stackDepth;
+    memcpy(vm->stack, state->stack, sizeof(vm->stack));
+    memcpy(vm->V, state->V, sizeof(vm->V));
+    memcpy(vm->userFlags, state->userFlags, sizeof(vm->userFlags));
+    vm->cycles = state->cycles;
+    vm->frames = state->frames;
+    vm->frameCycles = state->frameCycles;
+    vm->keyBoardState = state->keyBoardState;
+    vm->randomState = state->randomState;
+    memcpy(vm->audioPattern, state->audioPattern, sizeof(vm->audioPattern));
+    vm->pitch = state->pitch;
+    vm->graphicsSystem = state->graphicsSystem;
+}
+
+/// @brief Determines the index of the lowest bit that is set
+/// @param value The value - at least one bit must be set
+/// @return The index of the lowest bit that is set (0 - 63)
+static inline uint8_t virtual_machine_lowest_bit(uint64_t value) {
+    uint8_t index = 0u;
+    while (!(value & 1u)) {
+        value >>= 1;
+        index++;
+    }
+    return index;
+}
+
+/// @brief Restores a page of the memory
+/// @details Pages that are restored to the content of the image or to zeros are shared again instead of being copied
+/// @param vm The chip8 virtual machine
+/// @param page The index of the page that is restored
+/// @param data The content of the page
+static void virtual_machine_restore_page(virtual_machine_core_t * vm, uint16_t page, uint8_t const * data) {
+    if (!memcmp(vm->pages[page], data, VIRTUAL_MACHINE_PAGE_SIZE)) {
+        return;
+    }
+    uint64_t const bit = 1ull << (page & 63u);
+    uint8_t * shared = vm->image ? virtual_machine_shared_page(vm->image->memory + page * VIRTUAL_MACHINE_PAGE_SIZE)
+                                 : virtual_machine_zero_page;
+    if (!memcmp(shared, data, VIRTUAL_MACHINE_PAGE_SIZE)) {
+        if (vm->privatePages[page >> 6] & bit) {
+            free(vm->pages[page]);
+            vm->privatePages[page >> 6] &= ~bit;
+        }
+        vm->pages[page] = shared;
+        return;
+    }
+    if (!(vm->privatePages[page >> 6] & bit) && virtual_machine_core_copy_page(vm, page)) {
+        return;
+    }
+    memcpy(vm->pages[page], data, VIRTUAL_MACHINE_PAGE_SIZE);
+}
+
+/// @brief Frees the pages that were copied by the virtual machine
+/// @param vm The chip8 virtual machine - the pages are shared with the zero page afterwards
+static void virtual_machine_release_private_pages(virtual_machine_core_t * vm) {
+    for (uint16_t word = 0u; word < VIRTUAL_MACHINE_PAGE_COUNT / 64; word++) {
+        for (uint64_t pages = vm->privatePages[word]; pages; pages &= pages - 1u) {
+            uint16_t const page = word * 64u + virtual_machine_lowest_bit(pages);
+            free(vm->pages[page]);
+            vm->pages[page] = virtual_machine_zero_page;
+        }
+        vm->privatePages[word] = 0u;
+    }
+}
+
+/// @brief Determines the page that is shared instead of a page of an image
+/// @param imagePage The page of the image
+/// @return The zero page if the page of the image only contains zeros, otherwise the page of the image
+static inline uint8_t * virtual_machine_shared_page(uint8_t * imagePage) {
+    return memcmp(imagePage, virtual_machine_zero_page, VIRTUAL_MACHINE_PAGE_SIZE) ? imagePage
+                                                                                   : virtual_machine_zero_page;
+}
+
+/// @brief Marks every page of the memory as dirty
+/// @details Only the pages that exist in the mode of the virtual machine are marked, because a reset restores every
+/// page that is marked
+/// @param vm The chip8 virtual machine
+static void virtual_machine_mark_all_pages_dirty(virtual_machine_core_t * vm) {
+    uint16_t const pageCount = (vm->memoryMask + 1u) / VIRTUAL_MACHINE_PAGE_SIZE;
+    for (uint16_t word = 0u; word < VIRTUAL_MACHINE_PAGE_COUNT / 64; word++) {
+        uint16_t const firstPage = word * 64u;
+        if (pageCount >= firstPage + 64u) {
+            vm->dirtyPages[word] = UINT64_MAX;
+        } else {
+            vm->dirtyPages[word] = pageCount > firstPage ? (1ull << (pageCount - firstPage)) - 1u : 0u;
+        }
+    }
+}
@@ -0,0 +1,322 @@
+/****************************************************************************
+ * Copyright (C) 2023 by Frederik Tobner                                    *
+ *                                                                          *
+ * This file is part of CHIP-8.                                             *
+ *                                                                          *
+ * Permission to use, copy, modify, and distribute this software and its    *
+ * documentation under the terms of the GNU General Public License is       *
+ * hereby granted.                                                          *
+ * No representations are made about the suitability of this software for   *
+ * any purpose.                                                             *
+ * It is provided "as is" without express or implied warranty.              *
+ * See the <https://www.gnu.org/licenses/gpl-3.0.html/>GNU General Public   *
+ * License for more details.                                                *
+ ****************************************************************************/
+
+/**
+ * @file virtual_machine_core.h
+ * @brief Declarations regarding the core of the virtual machine
+ * @details The core holds the registers, the memory, the framebuffer and the timers of the virtual machine and
+ * executes its instructions. It has no dependency on SDL - the presentation of the frames and the key events of the
+ * host are left to the program that embeds it (see virtual_machine.h)
+ */
+
+#ifndef CHIP8_VIRTUAL_MACHINE_CORE_H_
+#define CHIP8_VIRTUAL_MACHINE_CORE_H_
+
+#include "core_pre_compiled_header.h"
+
+// This file is included in the test-suite that is written in c++ using the google-test framework
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "graphics_system.h"
+#include "keyboard_state.h"
+
+/// The size of the memory of the CHIP-8 and SUPER-CHIP (4 KB)
+#define VIRTUAL_MACHINE_MEMORY_SIZE          (0x1000u)
+
+/// The size of the memory of the XO-CHIP (64 KB)
+#define VIRTUAL_MACHINE_XO_CHIP_MEMORY_SIZE  (0x10000u)
+
+/// The size of the audio pattern buffer of the XO-CHIP (128 1-bit samples)
+#define VIRTUAL_MACHINE_AUDIO_PATTERN_SIZE   (16)
+
+/// The size of a page of the memory - pages are shared between virtual machines and tracked for resets
+#define VIRTUAL_MACHINE_PAGE_SIZE            (0x100u)
+
+/// The amount of pages of the largest memory (XO-CHIP)
+#define VIRTUAL_MACHINE_PAGE_COUNT           (VIRTUAL_MACHINE_XO_CHIP_MEMORY_SIZE / VIRTUAL_MACHINE_PAGE_SIZE)
+
+/// The size of a cache line - the fields that are used by almost every instruction fit into the first one
+#define VIRTUAL_MACHINE_CORE_CACHE_LINE_SIZE (64u)
+
+/// The clock speed of the CHIP-8 CPU (600 Hz)
+#define CHIP8_CLOCK_SPEED                    (600u)
+
+/// The frequency of the delay and sound timer (60 Hz) - a frame is presented at the same rate
+#define CHIP8_TIMER_FREQUENCY                (60u)
+
+/// The amount of instructions that are executed per frame
+#define CHIP8_INSTRUCTIONS_PER_FRAME         (CHIP8_CLOCK_SPEED / CHIP8_TIMER_FREQUENCY)
+
+/// @brief The modes of the virtual machine
+typedef enum {
+    /// CHIP-8 and SUPER-CHIP programs - 4 KB of memory
+    VIRTUAL_MACHINE_MODE_CHIP8 = 0,
+    /// XO-CHIP programs - 64 KB of memory and F000 NNNN loads a 16-bit address into I
+    VIRTUAL_MACHINE_MODE_XO_CHIP = 1
+} virtual_machine_mode;
+
+/// @brief The timing models of the virtual machine
+typedef enum {
+    /// Every instruction takes the same time - 10 instructions are executed per frame (600 Hz)
+    VIRTUAL_MACHINE_TIMING_FIXED = 0,
+    /// Every instruction takes as many machine cycles as on the COSMAC VIP and DXYN waits for the vertical blank
+    VIRTUAL_MACHINE_TIMING_COSMAC_VIP = 1
+} virtual_machine_timing;
+
+/// @brief The quirk profiles - behaviors that differ between the interpreters programs were written for
+typedef enum {
+    /// COSMAC VIP - shifts use VY, FX55/FX65 increment I, logic operations reset VF and sprites are clipped
+    VIRTUAL_MACHINE_QUIRKS_VIP = 0,
+    /// SUPER-CHIP - shifts use VX, FX55/FX65 leave I unmodified, BXNN jumps to XNN plus VX and sprites are clipped
+    VIRTUAL_MACHINE_QUIRKS_SCHIP = 1,
+    /// XO-CHIP - shifts use VY, FX55/FX65 increment I and sprites wrap around the edges of the screen
+    VIRTUAL_MACHINE_QUIRKS_XO_CHIP = 2
+} virtual_machine_quirks;
+
+/// The amount of quirk profiles
+#define VIRTUAL_MACHINE_QUIRKS_COUNT (3)
+
+/// @brief The reasons virtual_machine_core_run returns
+typedef enum {
+    /// The amount of executed instructions reached the cycle the execution had to stop at
+    VIRTUAL_MACHINE_CORE_STOPPED = 0,
+    /// The instructions of the frame were executed and the timers ticked
+    VIRTUAL_MACHINE_CORE_FRAME_COMPLETE = 1,
+    /// FX0A waits for a key press - the instruction is executed again until a key is pressed
+    VIRTUAL_MACHINE_CORE_WAITING_FOR_KEY = 2,
+    /// The program has ended - it exited or reached the end of the program or the memory
+    VIRTUAL_MACHINE_CORE_EXITED = 3,
+    /// The program executed an unknown opcode
+    VIRTUAL_MACHINE_CORE_ERROR = 4
+} virtual_machine_core_result;
+
+/// @brief A timer of the virtual machine that counts down at 60 Hz until it reaches zero
+/// @details Only the value and the tick the timer was set at are stored. The current value is derived from the ticks
+/// that passed since (see virtual_machine_core_timer_value), so a running timer costs no work per tick
+typedef struct {
+    /// The value the timer was set to
+    uint8_t value;
+    /// The tick (emulated frame) the timer was set at
+    uint64_t tick;
+} virtual_machine_timer_t;
+
+/// @brief The results of a program that was translated ahead of time (see virtual_machine_compiled_program_t)
+typedef enum {
+    /// The execution reached the cycle it had to stop at - the program counter points at the next instruction
+    VIRTUAL_MACHINE_COMPILED_YIELDED = 0,
+    /// The next instruction was not translated and is executed by the interpreter
+    VIRTUAL_MACHINE_COMPILED_INTERPRET = 1
+} virtual_machine_compiled_result;
+
+struct virtual_machine_core_t;
+
+/// @brief A program that was translated to C ahead of time (see recompiler.h)
+/// @details Executes the instructions starting at the program counter until the amount of executed instructions
+/// reaches stopCycle or an instruction is reached that was not translated
+/// @return The reason the execution of the translated program stopped (see virtual_machine_compiled_result)
+typedef int8_t (*virtual_machine_compiled_program_t)(struct virtual_machine_core_t * vm, uint64_t stopCycle);
+
+/// @brief Notifies the embedding program that a key was read by the program (EX9E, EXA1 and FX0A)
+/// @param context The context that was registered together with the callback
+/// @param keyIndex The index of the key that was read (0 - 15, or the value of the register if it is no key)
+typedef void (*virtual_machine_key_read_t)(void * context, uint8_t keyIndex);
+
+/// @brief The state of the virtual machine that is needed to execute instructions
+/// @details The fields are ordered by how often they are used. The registers, the memory and the stack pointer that
+/// almost every instruction uses come first and fit into the first cache line, the fields that are only used by a few
+/// instructions or once per frame follow
+typedef struct virtual_machine_core_t {
+    /// Programcounter of the virtual machine
+    uint16_t programCounter;
+    /// 16-bit register used for storing an adress in memory
+    uint16_t I;
+    /// The opcode that is currently executed
+    uint16_t currentOpcode;
+    /// Mask that is applied to every address (the size of the memory minus one)
+    uint16_t memoryMask;
+    /// Registers of the virtual macine (16 8-bit registers)
+    uint8_t V[16];
+    /// Stackpointer
+    uint16_t * stackPointer;
+    /// Pages of the memory of the virtual machine (4 KB, or 64 KB in XO-CHIP mode) - shared pages are copied before
+    /// they are written, so the memory is only accessed by virtual_machine_core_read and virtual_machine_core_write
+    uint8_t ** pages;
+    /// The amount of instructions that were executed
+    uint64_t cycles;
+    /// The state of the keyboard of the virtual machine
+    keyBoardState_t keyBoardState;
+    /// The mode of the virtual machine
+    virtual_machine_mode mode;
+    /// The timing model that determines how many instructions are executed per frame
+    virtual_machine_timing timing;
+    /// The quirk profile the instructions are executed with (SUPER-CHIP in the CHIP-8 mode and XO-CHIP in the XO-CHIP
+    /// mode unless another one is selected)
+    virtual_machine_quirks quirks;
+    /// The program translated ahead of time that executes the instructions instead of the interpreter (NULL if the
+    /// program is interpreted)
+    virtual_machine_compiled_program_t compiledProgram;
+    /// Stack of the chip8 (16bit unsigned integer values)
+    uint16_t stack[16];
+    /// Delay timer of the virtual machine
+    virtual_machine_timer_t delayTimer;
+    /// Sound timer of the virtual machine
+    virtual_machine_timer_t soundTimer;
+    /// The amount of frames that were executed - the timers tick once per frame
+    uint64_t frames;
+    /// The machine cycles of the COSMAC VIP that were spent in the current frame (COSMAC VIP timing only)
+    uint32_t frameCycles;
+    /// State of the pseudo random number generator that is used by the CXNN instruction
+    uint32_t randomState;
+    /// User flags of the SUPER-CHIP that are used to store registers (8 8-bit flags)
+    uint8_t userFlags[8];
+    /// The audio pattern buffer of the XO-CHIP - played while the sound timer is active
+    uint8_t audioPattern[VIRTUAL_MACHINE_AUDIO_PATTERN_SIZE];
+    /// The pitch the audio pattern is played at (XO-CHIP)
+    uint8_t pitch;
+    /// Bitmask of the pages of the memory that were written since the last reset (see virtual_machine_core_reset)
+    uint64_t dirtyPages[VIRTUAL_MACHINE_PAGE_COUNT / 64];
+    /// Bitmask of the pages that were copied by the virtual machine - the other pages are shared and only read
+    uint64_t privatePages[VIRTUAL_MACHINE_PAGE_COUNT / 64];
+    /// The image whose pages are shared (NULL if no image was mapped)
+    struct virtual_machine_image_t const * image;
+    /// Suppresses printed characters, sounds and error messages (while frames are run ahead or if the core is embedded)
+    bool silent;
+    /// Called when the program reads a key (NULL if the embedding program is not interested)
+    virtual_machine_key_read_t keyRead;
+    /// The context that is passed to keyRead
+    void * keyReadContext;
+    /// The framebuffer of the virtual machine
+    graphics_system_t graphicsSystem;
+} virtual_machine_core_t;
+
+/// @brief The memory of a loaded program that is shared by virtual machines (see virtual_machine_core_map_image)
+/// @details A virtual machine only reads the pages of the image and copies a page before it is written, so virtual
+/// machines that execute the same program share the character sprites and the program. The image must not be changed
+/// or freed while it is mapped.
+typedef struct virtual_machine_image_t {
+    /// The memory the program is loaded into - contains the character sprites after the image was initialized
+    uint8_t * memory;
+    /// Mask that is applied to every address (the size of the memory minus one)
+    uint16_t memoryMask;
+} virtual_machine_image_t;
+
+/// @brief A snapshot of the state of a virtual machine that is written by virtual_machine_core_save_state
+/// @details Covers everything the program can observe, so a restored virtual machine continues exactly like the saved
+/// one. The key events that were not applied yet are not part of the snapshot.
+typedef struct {
+    /// The opcode that is currently executed
+    uint16_t currentOpcode;
+    /// 16-bit register used for storing an adress in memory
+    uint16_t I;
+    /// Programcounter of the virtual machine
+    uint16_t programCounter;
+    /// Delay timer of the virtual machine
+    virtual_machine_timer_t delayTimer;
+    /// Sound timer of the virtual machine
+    virtual_machine_timer_t soundTimer;
+    /// The amount of addresses on the stack
+    uint8_t stackDepth;
+    /// Stack of the chip8
+    uint16_t stack[16];
+    /// Registers of the virtual macine
+    uint8_t V[16];
+    /// User flags of the SUPER-CHIP
+    uint8_t userFlags[8];
+    /// The amount of instructions that were executed
+    uint64_t cycles;
+    /// The amount of frames that were executed
+    uint64_t frames;
+    /// The machine cycles that were spent in the current frame
+    uint32_t frameCycles;
+    /// The state of the keyboard of the virtual machine
+    keyBoardState_t keyBoardState;
+    /// State of the pseudo random number generator
+    uint32_t randomState;
+    /// The audio pattern buffer of the XO-CHIP
+    uint8_t audioPattern[VIRTUAL_MACHINE_AUDIO_PATTERN_SIZE];
+    /// The pitch the audio pattern is played at (XO-CHIP)
+    uint8_t pitch;
+    /// The framebuffer of the virtual machine
+    graphics_system_t graphicsSystem;
+    /// Memory of the virtual machine - only the size of the memory of the saved virtual machine is used
+    uint8_t memory[VIRTUAL_MACHINE_XO_CHIP_MEMORY_SIZE];
+} virtual_machine_state_t;
+
+int virtual_machine_core_init(virtual_machine_core_t * vm, virtual_machine_mode mode);
+
+void virtual_machine_core_free(virtual_machine_core_t * vm);
+
+int8_t virtual_machine_core_run(virtual_machine_core_t * vm, uint64_t stopCycle);
+
+void virtual_machine_core_seed(virtual_machine_core_t * vm, uint32_t seed);
+
+uint16_t virtual_machine_core_cycle_cost(uint16_t opcode);
+
+uint8_t virtual_machine_core_timer_value(virtual_machine_core_t const * vm, virtual_machine_timer_t const * timer);
+
+void virtual_machine_core_save_state(virtual_machine_core_t const * vm, virtual_machine_state_t * state);
+
+void virtual_machine_core_restore_state(virtual_machine_core_t * vm, virtual_machine_state_t const * state);
+
+void virtual_machine_core_capture_template(virtual_machine_core_t * vm, virtual_machine_state_t * state);
+
+void virtual_machine_core_reset(virtual_machine_core_t * vm, virtual_machine_state_t const * state);
+
+int virtual_machine_core_copy_page(virtual_machine_core_t * vm, uint16_t page);
+
+int virtual_machine_image_init(virtual_machine_image_t * image, virtual_machine_mode mode);
+
+void virtual_machine_image_free(virtual_machine_image_t * image);
+
+void virtual_machine_core_map_image(virtual_machine_core_t * vm, virtual_machine_image_t const * image);
+
+void virtual_machine_core_write_opcode_to_memory(virtual_machine_core_t * vm, uint16_t * memoryLocation,
+                                                 uint16_t opcode);
+
+void virtual_machine_core_write_byte_to_memory(virtual_machine_core_t * vm, uint16_t * memoryLocation, uint8_t byte);
+
+/// @brief Reads a byte from the memory of the virtual machine
+/// @param vm The core of the chip8 virtual machine
+/// @param address The address of the byte - wrapped around at the end of the memory
+/// @return The byte at the address
+static inline uint8_t virtual_machine_core_read(virtual_machine_core_t const * vm, uint16_t address) {
+    address &= vm->memoryMask;
+    return vm->pages[address / VIRTUAL_MACHINE_PAGE_SIZE][address % VIRTUAL_MACHINE_PAGE_SIZE];
+}
+
+/// @brief Writes a byte to the memory of the virtual machine
+/// @details A shared page is copied before the first write and the page is marked as dirty. If the copy can not be
+/// allocated the byte is not written.
+/// @param vm The core of the chip8 virtual machine
+/// @param address The address of the byte - wrapped around at the end of the memory
+/// @param value The byte that is written
+static inline void virtual_machine_core_write(virtual_machine_core_t * vm, uint16_t address, uint8_t value) {
+    address &= vm->memoryMask;
+    uint16_t const page = address / VIRTUAL_MACHINE_PAGE_SIZE;
+    uint64_t const bit = 1ull << (page & 63u);
+    if (!(vm->privatePages[page >> 6] & bit) && virtual_machine_core_copy_page(vm, page)) {
+        return;
+    }
+    vm->dirtyPages[page >> 6] |= bit;
+    vm->pages[page][address % VIRTUAL_MACHINE_PAGE_SIZE] = value;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -78,10 +78,12 @@ void addresses_table_free_entries(addresses_hash_table_t * table) {
     }
     for (size_t i = 0; i < table->allocated; i++) {
         if (!table->entries[i] || table->entries[i] == ADDRESSES_ENTRY_TOMBSTONE) {
-            break;
+            continue;
         }
         free((char *)table->entries[i]->key);
         uint16_t_dynamic_array_free(table->entries[i]->array);
+        free(table->entries[i]->array);
+        free(table->entries[i]);
     }
     free(table->entries);
     table->allocated = table->used = 0;
@@ -89,16 +91,20 @@ void addresses_table_free_entries(addresses_hash_table_t * table) {
 }
 
 int addresses_table_add(uint16_t address, char const * key, addresses_hash_table_t * table) {
+    if (!key || !table) {
+        free((char *)key);
+        return -1;
+    }
     // Lookup label
     addresses_hash_table_entry_t * entry;
     if ((entry = addresses_table_look_up_entry(key, table))) {
-        uint16_t_dynamic_array_write(entry->array, address);
-    }
-    if (!key || !table) {
-        return -1;
+        // The label is already referenced, so the key is not stored
+        free((char *)key);
+        return uint16_t_dynamic_array_write(entry->array, address) ? 0 : -1;
     }
     if (table->used >= ((double)table->allocated) * TABLE_GROWTH_TRIGGER_VALUE) {
         if (addresses_table_grow_table(table)) {
+            free((char *)key);
             return -1;
         }
     }
@@ -109,7 +115,14 @@ int addresses_table_add(uint16_t address, char const * key, addresses_hash_table
         try = (i + index) & (table->allocated - 1);
         if ((!table->entries[try] || table->entries[try] == ADDRESSES_ENTRY_TOMBSTONE)) {
             entry = new (addresses_hash_table_entry_t);
+            if (!entry) {
+                break;
+            }
             entry->array = new (uint16_t_dynamic_array_t);
+            if (!entry->array) {
+                free(entry);
+                break;
+            }
             entry->key = key;
             uint16_t_dynamic_array_init(entry->array, 1, 0);
             uint16_t_dynamic_array_write(entry->array, address);
@@ -118,6 +131,7 @@ int addresses_table_add(uint16_t address, char const * key, addresses_hash_table
             return 0;
         }
     }
+    free((char *)key);
     return -1;
 }
 
@@ -70,7 +70,7 @@ void addresses_table_free_entries(addresses_hash_table_t * table);
 
 /// @brief Adds the memory location to the table
 /// @param address The address that is added to the table
-/// @param key The label that is referenced
+/// @param key The label that is referenced - the table takes ownership of it and frees it if it is not stored
 /// @param table The table where the address is added
 /// @return 0 if the address was added, -1 if the address couldn't be added
 int addresses_table_add(uint16_t address, char const * key, addresses_hash_table_t * table);
@@ -20,7 +20,6 @@
 
 #include "assembler.h"
 #include "../../base/src/chip8.h"
-#include "../../base/src/exit_code.h"
 
 #define OPCODE_CONVERSION_ERROR_MESSAGE ("Unable to convert mnemonic at source into binary")
 
@@ -38,9 +37,9 @@ static inline bool assembler_is_hexa(char);
 static inline char assembler_peek(assembler_t);
 static char assembler_peek_ahead(assembler_t, uint8_t);
 static uint8_t assembler_read_8bit_number(assembler_t *);
-static void assembler_report_error(assembler_t *, char const *, ...);
+static uint16_t assembler_report_error(assembler_t *, char const *, ...);
 static void assembler_skip_whitespace(assembler_t *);
-static void assembler_patch_jump_instructions(assembler_t *, uint8_t *);
+static int assembler_patch_jump_instructions(assembler_t *, uint8_t *);
 static int assembler_process_section(assembler_t *, uint8_t *, uint16_t *);
 static void assembler_process_data_section(assembler_t *, uint8_t *, uint16_t *);
 static void assembler_process_text_section(assembler_t *, uint8_t *, uint16_t *);
@@ -52,6 +51,8 @@ int assembler_initialize(assembler_t * assembler, char const * source) {
     assembler->start = source;
     assembler->current = source;
     assembler->line = 1u;
+    assembler->hadError = false;
+    assembler->silent = false;
     if (uint16_t_table_init_table(&assembler->addressTable)) {
         return -1;
     }
@@ -63,17 +64,19 @@ int assembler_initialize(assembler_t * assembler, char const * source) {
 
 int assembler_process_file(assembler_t * assembler, uint8_t * memory) {
     uint16_t memoryLocation = PROGRAM_START_LOCATION;
+    int result = 0;
     assembler_skip_whitespace(assembler);
-    while (!assembler_is_at_end(*assembler)) {
-        if (assembler_process_section(assembler, memory, &memoryLocation)) {
-            return -1;
-        }
+    while (!assembler_is_at_end(*assembler) && !result) {
+        result = assembler_process_section(assembler, memory, &memoryLocation);
     }
-    assembler_patch_jump_instructions(assembler, memory);
+    if (!result) {
+        result = assembler_patch_jump_instructions(assembler, memory);
+    }
+    // The assembler never terminates the process, so it can be used by programs that embed the virtual machine
     free(assembler->source);
     uint16_t_table_free_entries(&assembler->addressTable);
     addresses_table_free_entries(&assembler->addressesTable);
-    return 0;
+    return result;
 }
 
 /// @brief Processes a section in a chip8 assembly file
@@ -90,6 +93,7 @@ static int assembler_process_section(assembler_t * assembler, uint8_t * memory,
         assembler->current += 7;
     } else {
         assembler_report_error(assembler, "No section in source file");
+        return -1;
     }
     assembler_skip_whitespace(assembler);
     if (!strncmp(assembler->current, ".text:", 6)) {
@@ -99,7 +103,7 @@ static int assembler_process_section(assembler_t * assembler, uint8_t * memory,
     } else {
         return -1;
     }
-    return 0;
+    return assembler->hadError ? -1 : 0;
 }
 
 /// @brief Processes the data section of a chip8 program
@@ -114,15 +118,16 @@ static void assembler_process_data_section(assembler_t * assembler, uint8_t * me
         assembler_skip_whitespace(assembler);
         uint16_t specifiedMemoryLocation = assembler_convert_address_to_binary(assembler);
         if (specifiedMemoryLocation < *memoryLocation) {
-            fprintf(stderr, "Address specified in org collided with text segment");
-            exit(EXIT_CODE_ASSEMBLER_ERROR);
+            assembler_report_error(assembler, "Address specified in org collided with text segment");
+            return;
         }
         *memoryLocation = specifiedMemoryLocation;
         assembler_skip_whitespace(assembler);
     } else {
         *memoryLocation += 2;
     }
-    for (; (!strncmp(assembler->current, "0x", 2) || !strncmp(assembler->current, "0X", 2)) && *memoryLocation < 0xFFF;
+    for (; (!strncmp(assembler->current, "0x", 2) || !strncmp(assembler->current, "0X", 2)) &&
+           *memoryLocation < 0xFFF && !assembler->hadError;
          assembler_skip_whitespace(assembler)) {
         if (*memoryLocation > 0x1000u || *memoryLocation < PROGRAM_START_LOCATION) {
             break;
@@ -130,8 +135,7 @@ static void assembler_process_data_section(assembler_t * assembler, uint8_t * me
         memory[(*memoryLocation)++] = assembler_read_8bit_number(assembler);
     }
     if (*memoryLocation > 0xFFF) {
-        fprintf(stderr, "Data section is too big too be stored in memory");
-        exit(EXIT_CODE_ASSEMBLER_ERROR);
+        assembler_report_error(assembler, "Data section is too big too be stored in memory");
     }
 }
 
@@ -141,21 +145,22 @@ static void assembler_process_data_section(assembler_t * assembler, uint8_t * me
 /// @param memoryLocation The memory-location where the code is stored
 static void assembler_process_text_section(assembler_t * assembler, uint8_t * memory, uint16_t * memoryLocation) {
     if (*memoryLocation != PROGRAM_START_LOCATION) {
-        fprintf(stderr, "Text section must be declared before data section");
-        exit(EXIT_CODE_ASSEMBLER_ERROR);
+        assembler_report_error(assembler, "Text section must be declared before data section");
+        return;
     }
     assembler->current += 6;
     int32_t opcode;
 #ifdef PRINT_BYTE_CODE
     printf("=== Code ===\n");
 #endif
-    for (assembler_skip_whitespace(assembler); *memoryLocation <= 0xFFF && strncmp(assembler->current, "section", 7);
+    for (assembler_skip_whitespace(assembler);
+         *memoryLocation <= 0xFFF && strncmp(assembler->current, "section", 7) && !assembler->hadError;
          assembler_skip_whitespace(assembler)) {
         if (assembler_peek(*assembler) == '_') {
             assembler_scan_label(assembler, *memoryLocation);
         } else {
             opcode = assembler_scan_opcode(assembler, *memoryLocation);
-            if (opcode <= 0) {
+            if (opcode <= 0 || assembler->hadError) {
                 break;
             }
             if (*memoryLocation > 0x1000u || *memoryLocation < PROGRAM_START_LOCATION) {
@@ -169,8 +174,7 @@ static void assembler_process_text_section(assembler_t * assembler, uint8_t * me
         }
     }
     if (*memoryLocation > 0xFFF) {
-        fprintf(stderr, "Text section is too big too be stored in memory");
-        exit(EXIT_CODE_ASSEMBLER_ERROR);
+        assembler_report_error(assembler, "Text section is too big too be stored in memory");
     }
 }
 
@@ -188,6 +192,7 @@ static void assembler_scan_label(assembler_t * assembler, uint16_t memoryLocatio
         }
         if (!assembler_is_alpha(assembler_peek(*assembler))) {
             assembler_report_error(assembler, "A label can only consist of alphanumeric characters");
+            return;
         }
         labelEnd = assembler->current;
         assembler_advance(assembler);
@@ -195,7 +200,7 @@ static void assembler_scan_label(assembler_t * assembler, uint16_t memoryLocatio
     if (!labelEnd) {
         return;
     }
-    char * label = malloc(labelEnd - labelStart);
+    char * label = malloc(labelEnd - labelStart + 2);
     if (!label) {
         return;
     }
@@ -203,9 +208,14 @@ static void assembler_scan_label(assembler_t * assembler, uint16_t memoryLocatio
     label[labelEnd - labelStart + 1] = '\0';
     uint16_t_table_entry_t * entry = uint16_t_table_entry_new(memoryLocation, label);
     if (!entry) {
+        free(label);
+        return;
+    }
+    if (uint16_t_table_insert_entry(entry, &assembler->addressTable)) {
+        free(label);
+        free(entry);
         return;
     }
-    uint16_t_table_insert_entry(entry, &assembler->addressTable);
     assembler_advance(assembler);
 }
 
@@ -231,7 +241,8 @@ static int32_t assembler_scan_opcode(assembler_t * assembler, uint16_t memoryLoc
 /// @param assembler Advances a position further in the sourcecode
 /// @return The current character
 static inline char assembler_advance(assembler_t * assembler) {
-    return *assembler->current++;
+    // The end of the source is never passed, even if an instruction is converted after an error
+    return *assembler->current ? *assembler->current++ : '\0';
 }
 
 /// @brief Converts the mnemonic representation of a number in the hexadecimal formtat from the the sourcefile to
@@ -245,7 +256,7 @@ static uint16_t assembler_hexa(assembler_t * assembler, size_t digitCount) {
     for (size_t i = 0; i < digitCount; i++) {
         number *= 16;
         if (!assembler_is_hexa(assembler_peek(*assembler))) {
-            assembler_report_error(assembler, "Invalid character in hexadecimal sequence\n");
+            return assembler_report_error(assembler, "Invalid character in hexadecimal sequence");
         }
         if (assembler_is_decimal(assembler_peek(*assembler))) {
             number += *assembler->current++ - '0';
@@ -330,15 +341,7 @@ static uint8_t assembler_read_8bit_number(assembler_t * assembler) {
     if (c == '0' && (assembler_peek(*assembler) == 'x' || assembler_peek(*assembler) == 'X')) {
         return assembler_hexa(assembler, 2);
     }
-    assembler_report_error(assembler, "Could not parse 8 bit number");
-// Unreachable
-#if defined(COMPILER_MSVC)
-    __assume(0);
-#elif defined(COMPILER_GCC) || defined(COMPILER_CLANG)
-    __builtin_unreachable();
-#else // Compiler is Intel or unknown
-    return 0;
-#endif
+    return (uint8_t)assembler_report_error(assembler, "Could not parse 8 bit number");
 }
 
 /// @brief Converts the mnemnic representation of a address to binary
@@ -350,15 +353,7 @@ static uint16_t assembler_convert_address_to_binary(assembler_t * assembler) {
     if (c == '0' && (assembler_peek(*assembler) == 'x' || assembler_peek(*assembler) == 'X')) {
         return assembler_hexa(assembler, 3);
     }
-    assembler_report_error(assembler, "Unable to convert address");
-// Unreachable
-#if defined(COMPILER_MSVC)
-    __assume(0);
-#elif defined(COMPILER_GCC) || defined(COMPILER_CLANG)
-    __builtin_unreachable();
-#else // Compiler is Intel or unknown
-    return 0;
-#endif
+    return assembler_report_error(assembler, "Unable to convert address");
 }
 
 /// @brief Converts a label to it's corresponding address in memory
@@ -370,9 +365,9 @@ static uint16_t assembler_convert_label_to_address(assembler_t * assembler, uint
     for (; !assembler_is_at_end(*assembler) && assembler_is_alpha(assembler_peek(*assembler));
          labelEnd = assembler->current, assembler_advance(assembler)) {
     }
-    char * label = malloc(labelEnd - labelStart - 2);
+    char * label = malloc(labelEnd - labelStart + 2);
     if (!label) {
-        assembler_report_error(assembler, "Unable to allocate memory for label");
+        return assembler_report_error(assembler, "Unable to allocate memory for label");
     }
     memcpy(label, labelStart, labelEnd - labelStart + 1);
     label[labelEnd - labelStart + 1] = '\0';
@@ -381,6 +376,7 @@ static uint16_t assembler_convert_label_to_address(assembler_t * assembler, uint
     if (entry) {
         // The label is defined
         address = entry->data;
+        free(label);
     } else {
         // The label is not defined
         addresses_table_add(memoryLocation, label, &assembler->addressesTable);
@@ -396,22 +392,14 @@ static uint8_t assembler_convert_register_to_binary(assembler_t * assembler) {
     switch (toupper(assembler_advance(assembler))) {
     case 'V':
         if (!assembler_is_hexa(assembler_peek(*assembler))) {
-            assembler_report_error(assembler, "Unable to read register\n");
+            break;
         }
         assembler->current--;
-        return assembler_hexa(assembler, 1);
+        return (uint8_t)assembler_hexa(assembler, 1);
     default:
-        assembler_report_error(assembler, "Unable to read register\n");
         break;
     }
-// Unreachable
-#if defined(COMPILER_MSVC)
-    __assume(0);
-#elif defined(COMPILER_GCC) || defined(COMPILER_CLANG)
-    __builtin_unreachable();
-#else // Compiler is Intel or unknown
-    return 0;
-#endif
+    return (uint8_t)assembler_report_error(assembler, "Unable to read register");
 }
 
 /// @brief Converts the mnemnic representation of a registers to binary
@@ -423,36 +411,48 @@ static uint8_t assembler_convert_registers_to_binary(assembler_t * assembler) {
 }
 
 /// @brief Reports an error when the assembly waas processed
+/// @details Only the first error is reported - the processing stops once the current instruction is converted
 /// @param assembler The assembler where the error occured
-static inline void assembler_report_error(assembler_t * assembler, char const * format, ...) {
+/// @return Always 0, so a conversion that failed can return the result of the report
+static inline uint16_t assembler_report_error(assembler_t * assembler, char const * format, ...) {
+    if (assembler->hadError) {
+        return 0u;
+    }
+    assembler->hadError = true;
+    if (assembler->silent) {
+        return 0u;
+    }
     va_list args;
     va_start(args, format);
     vfprintf(stderr, format, args);
     fprintf(stderr, " at line %i\n", assembler->line);
     va_end(args);
-    free(assembler->source);
-    exit(EXIT_CODE_ASSEMBLER_ERROR);
+    return 0u;
 }
 
-/// @brief
-/// @param assembler
-/// @param memory
-static void assembler_patch_jump_instructions(assembler_t * assembler, uint8_t * memory) {
+/// @brief Patches the addresses of the labels into the instructions that reference them
+/// @param assembler The assembler that holds the labels and their references
+/// @param memory The memory where the program was written to
+/// @return 0 if every label was resolved, -1 if not
+static int assembler_patch_jump_instructions(assembler_t * assembler, uint8_t * memory) {
     for (size_t i = 0; i < assembler->addressesTable.allocated; i++) {
         if (assembler->addressesTable.entries[i] && assembler->addressesTable.entries[i] != ADDRESSES_ENTRY_TOMBSTONE) {
             uint16_t_table_entry_t * addressEntry = NULL;
             addressEntry =
                 uint16_t_table_look_up_entry(assembler->addressesTable.entries[i]->key, &assembler->addressTable);
             if (!addressEntry) {
+                if (assembler->silent) {
+                    return -1;
+                }
                 printf("Unable to resolve label reference %s\n", assembler->addressesTable.entries[i]->key);
-                free(assembler->source);
-                exit(EXIT_CODE_ASSEMBLER_ERROR);
+                return -1;
             }
             for (size_t j = 0; j < assembler->addressesTable.entries[i]->array->used; j++) {
                 memory[assembler->addressesTable.entries[i]->array->data[j]] |= addressEntry->data;
             }
         }
     }
+    return 0;
 }
 
 /// @brief Converts the next mnemonic representation of an opcode in the source file to it's binary representation
@@ -482,17 +482,17 @@ static uint16_t assembler_convert_mnemonic_to_binary(assembler_t * assembler, ch
                         SWITCH_CASE_RETURN('0', 0x7000 | assembler_convert_register_to_binary(assembler) << 8 |
                                                     assembler_read_8bit_number(assembler));
                     default:
-                        assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                        return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
                     }
                     break;
                 default:
-                    assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                    return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
                 }
             default:
-                assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
             }
         default:
-            assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+            return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
         }
     case 'C':
         SWITCH_ADVANCE {
@@ -500,16 +500,16 @@ static uint16_t assembler_convert_mnemonic_to_binary(assembler_t * assembler, ch
             SWITCH_ADVANCE {
                 SWITCH_CASE_RETURN('L', 0x2000 | assembler_convert_address_to_binary(assembler)); // CAL
             default:
-                assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
             }
         case 'L':
             SWITCH_ADVANCE {
                 SWITCH_CASE_RETURN('S', 0x00E0); // CLS
             default:
-                assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
             }
         default:
-            assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+            return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
         }
     case 'D':
         SWITCH_ADVANCE {
@@ -518,10 +518,10 @@ static uint16_t assembler_convert_mnemonic_to_binary(assembler_t * assembler, ch
                 SWITCH_CASE_RETURN('P', (0xD000 | assembler_convert_registers_to_binary(assembler) << 4) |
                                             (assembler_read_8bit_number(assembler) & 0xf)); // DSP
             default:
-                assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
             }
         default:
-            assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+            return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
         }
     case 'E':
         SWITCH_ADVANCE {
@@ -529,10 +529,10 @@ static uint16_t assembler_convert_mnemonic_to_binary(assembler_t * assembler, ch
             SWITCH_ADVANCE {
                 SWITCH_CASE_RETURN('T', 0X0002); // EXT
             default:
-                assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
             }
         default:
-            assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+            return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
         }
     case 'F':
         SWITCH_ADVANCE {
@@ -540,10 +540,10 @@ static uint16_t assembler_convert_mnemonic_to_binary(assembler_t * assembler, ch
             SWITCH_ADVANCE {
                 SWITCH_CASE_RETURN('R', 0xF065 | assembler_convert_register_to_binary(assembler) << 8); // FMR
             default:
-                assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
             }
         default:
-            assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+            return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
         }
         break;
     case 'J':
@@ -560,17 +560,17 @@ static uint16_t assembler_convert_mnemonic_to_binary(assembler_t * assembler, ch
                     }
                 }
             default:
-                assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
             }
             break;
         case 'R':
             SWITCH_ADVANCE {
                 SWITCH_CASE_RETURN('B', 0xB000 | assembler_convert_address_to_binary(assembler));
             default:
-                assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
             }
         default:
-            assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+            return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
         }
         break;
     case 'M':
@@ -605,7 +605,7 @@ static uint16_t assembler_convert_mnemonic_to_binary(assembler_t * assembler, ch
                             SWITCH_CASE_RETURN('T', 0xF015 | assembler_convert_register_to_binary(assembler)
                                                                  << 8); // DT VX
                         default:
-                            assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                            return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
                         }
                         break;
                     case 'I': // I 0xNNNN
@@ -616,7 +616,7 @@ static uint16_t assembler_convert_mnemonic_to_binary(assembler_t * assembler, ch
                             SWITCH_CASE_RETURN('T', 0xF018 | assembler_convert_register_to_binary(assembler)
                                                                  << 8); // ST VX
                         default:
-                            assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                            return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
                         }
                         break;
                     case 'V':
@@ -628,7 +628,7 @@ static uint16_t assembler_convert_mnemonic_to_binary(assembler_t * assembler, ch
                                 SWITCH_ADVANCE {
                                     SWITCH_CASE_RETURN('T', 0xf007 | registernumber << 8); // VX DT
                                 default:
-                                    assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                                    return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
                                 }
                                 SWITCH_CASE_RETURN('V', 0x8000 | registernumber << 8 ||
                                                             assembler_convert_register_to_binary(assembler)
@@ -639,21 +639,21 @@ static uint16_t assembler_convert_mnemonic_to_binary(assembler_t * assembler, ch
                                 case 'X': // VX 0xNN
                                     return 0x6000 | registernumber << 8 | assembler_hexa(assembler, 2);
                                 default:
-                                    assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                                    return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
                                 }
                             default:
-                                assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                                return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
                             }
                         }
                     default:
-                        assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                        return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
                     }
                 }
             default:
-                assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
             }
         default:
-            assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+            return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
         }
         break;
     case 'N':
@@ -662,11 +662,11 @@ static uint16_t assembler_convert_mnemonic_to_binary(assembler_t * assembler, ch
             SWITCH_ADVANCE {
                 SWITCH_CASE_RETURN('P', 0x0001); // NOP
             default:
-                assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
             }
             break;
         default:
-            assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+            return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
         }
     case 'R':
         SWITCH_ADVANCE {
@@ -675,17 +675,17 @@ static uint16_t assembler_convert_mnemonic_to_binary(assembler_t * assembler, ch
             case 'T': // RET
                 return 0x00EE;
             default:
-                assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
             }
         case 'N':
             SWITCH_ADVANCE {
                 SWITCH_CASE_RETURN('D', 0xC000 | assembler_convert_register_to_binary(assembler) << 8 |
                                             assembler_read_8bit_number(assembler)); // RND
             default:
-                assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
             }
         default:
-            assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+            return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
         }
     case 'P':
         SWITCH_ADVANCE {
@@ -693,11 +693,11 @@ static uint16_t assembler_convert_mnemonic_to_binary(assembler_t * assembler, ch
             SWITCH_ADVANCE {
                 SWITCH_CASE_RETURN('T', 0xF000 | assembler_convert_register_to_binary(assembler) << 8); // PRT
             default:
-                assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
             }
             break;
         default:
-            assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+            return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
         }
     case 'S':
         SWITCH_ADVANCE {
@@ -730,11 +730,11 @@ static uint16_t assembler_convert_mnemonic_to_binary(assembler_t * assembler, ch
                     SWITCH_CASE_RETURN('P', 0xE0A1 | assembler_convert_register_to_binary(assembler)
                                                          << 8); // SKNP - skip not pressed
                 default:
-                    assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                    return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
                 }
                 SWITCH_CASE_RETURN('P', 0xE09E | assembler_convert_register_to_binary(assembler) << 8);
             default:
-                assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
             }
             break;
         case 'T':
@@ -743,33 +743,33 @@ static uint16_t assembler_convert_mnemonic_to_binary(assembler_t * assembler, ch
                 SWITCH_ADVANCE {
                     SWITCH_CASE_RETURN('C', 0xF033 | assembler_convert_register_to_binary(assembler) << 8); // STBC
                 default:
-                    assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                    return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
                 }
                 SWITCH_CASE_RETURN('K', 0xF00A | assembler_convert_register_to_binary(assembler) << 8); // STK
             case 'L':
                 SWITCH_ADVANCE {
                     SWITCH_CASE_RETURN('S', 0x8006 | assembler_convert_registers_to_binary(assembler) << 4); // STLS
                 default:
-                    assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                    return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
                 }
             case 'M':
                 SWITCH_ADVANCE {
                     SWITCH_CASE_RETURN('R', 0xF055 | assembler_convert_registers_to_binary(assembler) << 4); // STMR
                     SWITCH_CASE_RETURN('S', 0x800E | assembler_convert_registers_to_binary(assembler) << 4); // STMS
                 default:
-                    assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                    return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
                 }
             default:
-                assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
             }
         case 'U':
             SWITCH_ADVANCE {
                 SWITCH_CASE_RETURN('B', 0x8005 | assembler_convert_registers_to_binary(assembler) << 4); // SUB
             default:
-                assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
             }
         default:
-            assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+            return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
         }
     case 'T':
         SWITCH_ADVANCE {
@@ -777,22 +777,15 @@ static uint16_t assembler_convert_mnemonic_to_binary(assembler_t * assembler, ch
             SWITCH_ADVANCE {
                 SWITCH_CASE_RETURN('S', 0x00E1); // TGS
             default:
-                assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+                return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
             }
         default:
-            assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+            return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
         }
     default:
-        assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
-    }
-// Unreachable
-#if defined(COMPILER_MSVC)
-    __assume(0);
-#elif defined(COMPILER_GCC) || defined(COMPILER_CLANG)
-    __builtin_unreachable();
-#else
-    return 0;
-#endif
+        return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
+    }
+    return assembler_report_error(assembler, OPCODE_CONVERSION_ERROR_MESSAGE);
 #undef SWITCH_ADVANCE
 #undef SWITCH_PEEK
 #undef SWITCH_CASE_RETURN
@@ -21,6 +21,11 @@
 #ifndef CHIP8_ASSEMLER_H_
 #define CHIP8_ASSEMLER_H_
 
+// This file is included in the test-suite that is written in c++ using the google-test framework
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #include "address_hash_table.h"
 #include "addresses_hash_table.h"
 #include "frontend_pre_compiled_header.h"
@@ -35,6 +40,10 @@ typedef struct {
     char const * current;
     /// Line counter - used for error reporting
     uint32_t line;
+    /// Flag that indicates whether an error occured - the processing stops at the first error
+    bool hadError;
+    /// Suppresses the error messages (if the assembler is embedded)
+    bool silent;
     /// Address table - used to store the adress of a label definition
     uint16_t_table_t addressTable;
     /// Address table - used to store unresolved label references
@@ -52,4 +61,8 @@ int assembler_initialize(assembler_t * assembler, char const * source);
 /// @return 0 if everything went well, -1 if an error occured
 int assembler_process_file(assembler_t * assembler, uint8_t * memory);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
@@ -48,7 +48,7 @@ char * file_utils_read_file(char const * path) {
     return buffer;
 }
 
-void file_utils_read_file_to_memory(char const * path, uint8_t * memory) {
+void file_utils_read_file_to_memory(char const * path, uint8_t * memory, size_t memorySize) {
     // Opens a file of a nonspecified format (b) in read mode (r)
     FILE * file = fopen(path, "rb");
     if (!file) {
@@ -57,13 +57,14 @@ void file_utils_read_file_to_memory(char const * path, uint8_t * memory) {
     fseek(file, 0L, SEEK_END);
     size_t fileSize = ftell(file);
     rewind(file);
-    if (fileSize > (4096 - PROGRAM_START_LOCATION)) {
+    if (fileSize > (memorySize - PROGRAM_START_LOCATION)) {
         io_error("Content is to big to store it in memory \"%s\".\n", path);
     }
     size_t bytesRead = fread(memory + PROGRAM_START_LOCATION, sizeof(char), fileSize, file);
     if (bytesRead < fileSize) {
         io_error("Could not fully read file \"%s\".\n", path);
     }
+    fclose(file);
 }
 
 /// @brief Reports an error that has occured during a IO operation
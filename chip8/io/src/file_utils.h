@@ -21,6 +21,11 @@
 #ifndef CHIP8_FILE_UTILS_H_
 #define CHIP8_FILE_UTILS_H_
 
+// This file is included in the test-suite that is written in c++ using the google-test framework
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #include "io_pre_compiled_header.h"
 
 /// @brief Reads a file from a specified location and returns the content of the file as a character pointer
@@ -28,6 +33,14 @@
 /// @return The content of the file as a character pointer
 char * file_utils_read_file(char const *);
 
-void file_utils_read_file_to_memory(char const * path, uint8_t * memory);
+/// @brief Reads a binary program into memory, starting at the location where programs are stored
+/// @param path The path of the file that is read
+/// @param memory The memory where the program is stored
+/// @param memorySize The size of the memory
+void file_utils_read_file_to_memory(char const * path, uint8_t * memory, size_t memorySize);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif
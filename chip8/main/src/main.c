@@ -23,12 +23,14 @@
 #include "../../../build/chip8/main/src/chip8_config.h"
 
 #include "../../backend/src/display.h"
+#include "../../backend/src/recompiler.h"
 #include "../../backend/src/virtual_machine.h"
 #include "../../base/src/exit_code.h"
+#include "../../base/src/memory.h"
 #include "../../frontend/src/assembler.h"
 #include "../../io/src/file_utils.h"
 /// Short message that explains the usage of the CHIP-8 emulator
-#define CHIP8_USAGE_MESSAGE "Usage: Chip8 [path]\n"
+#define CHIP8_USAGE_MESSAGE "Usage: Chip8 [options] [path]\n"
 #define PROJECT_INIT_LETTERING \
     ("   _____ _    _ _____ _____        ___  \n\
   / ____| |  | |_   _|  __ \\      / _ \\ \n\
@@ -38,8 +40,50 @@
   \\_____|_|  |_|_____|_|          \\___/ \n\
 ")
 
-static void run_from_file(char const *);
+/// @brief Options that were specified when the emulator was started
+typedef struct {
+    /// Path of the program that is executed
+    char const * filePath;
+    /// Flags that configure the display
+    uint32_t displayFlags;
+    /// The mode of the virtual machine
+    virtual_machine_mode mode;
+    /// The timing model of the virtual machine
+    virtual_machine_timing timing;
+    /// The quirk profile of the virtual machine (VIRTUAL_MACHINE_QUIRKS_COUNT if the profile of the mode is used)
+    virtual_machine_quirks quirks;
+    /// Flag that indicates whether the quirk profile is suggested by the analysis of the program
+    bool suggestQuirks;
+    /// Flag that indicates whether the analysis of the program is reported instead of executing it
+    bool analyze;
+    /// The seed of the random number generator (0 if the default seed is used)
+    uint32_t seed;
+    /// Path of the input log the keyboard input is recorded to (NULL if the input is not recorded)
+    char const * recordPath;
+    /// Path of the input log the keyboard input is replayed from (NULL if the input is not replayed)
+    char const * replayPath;
+    /// Path of the C translation unit the program is translated to ahead of time (NULL if the program is executed)
+    char const * translationPath;
+    /// Path of the socket the frames are streamed to (NULL if the frames are not streamed)
+    char const * servePath;
+    /// Name of the shared memory segment the frames are exported to (NULL if the frames are not exported)
+    char const * exportName;
+    /// Path of the video the frames are recorded to (NULL if no video is recorded)
+    char const * videoPath;
+    /// Options that configure the execution of the program
+    virtual_machine_execution_options_t executionOptions;
+} command_line_options_t;
+
+static uint64_t parse_cycle_count(char const *);
+static uint32_t parse_limit(char const *);
+static void parse_command_line(int, char **, command_line_options_t *);
+static virtual_machine_quirks parse_quirks(char const *);
+static uint8_t parse_run_ahead_frames(char const *);
+static uint32_t parse_seed(char const *);
+static void run_from_file(command_line_options_t const *);
 static void show_help();
+static void show_usage_error();
+static void translate_program(virtual_machine_t const *, program_analysis_t const *, char const *);
 
 /// @brief Main entry point of the CHIP-8 program
 /// @param argc The amount of arguments that were used when the program was started
@@ -47,51 +91,312 @@ static void show_help();
 /// program was started
 /// @return 0 if everything went well
 int main(int argc, char ** args) {
-    if (argc == 2) {
-        if (!strcmp(args[1], "--version") || !strcmp(args[1], "-v")) {
+    command_line_options_t options;
+    parse_command_line(argc, args, &options);
+    run_from_file(&options);
+    return EXIT_CODE_OK;
+}
+
+/// @brief Parses the arguments the emulator was started with
+/// @details Exits the emulator if the version or the help is shown or the arguments are invalid
+/// @param argc The amount of arguments
+/// @param args The arguments
+/// @param options The options that are set based on the arguments
+static void parse_command_line(int argc, char ** args, command_line_options_t * options) {
+    options->filePath = NULL;
+    options->displayFlags = 0u;
+    options->mode = VIRTUAL_MACHINE_MODE_CHIP8;
+    options->timing = VIRTUAL_MACHINE_TIMING_FIXED;
+    options->quirks = VIRTUAL_MACHINE_QUIRKS_COUNT;
+    options->suggestQuirks = false;
+    options->analyze = false;
+    options->seed = 0u;
+    options->recordPath = NULL;
+    options->replayPath = NULL;
+    options->translationPath = NULL;
+    options->servePath = NULL;
+    options->exportName = NULL;
+    options->videoPath = NULL;
+    bool translate = false;
+    options->executionOptions.maximumCycles = 0u;
+    options->executionOptions.screenshotCycle = 0u;
+    options->executionOptions.screenshotPath = NULL;
+    options->executionOptions.inputLog = NULL;
+    options->executionOptions.runAheadFrames = 0u;
+    options->executionOptions.idleFrames = 0u;
+    options->executionOptions.timeLimit = 0u;
+    options->executionOptions.frameServer = NULL;
+    options->executionOptions.frameExport = NULL;
+    options->executionOptions.videoRecorder = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(args[i], "--version") || !strcmp(args[i], "-v")) {
             printf("%s Version %i.%i.%i\n", PROJECT_NAME, PROJECT_VERSION_MAJOR, PROJECT_VERSION_MINOR,
                    PROJECT_VERSION_PATCH);
-        } else if (!strcmp(args[1], "--help") || !strcmp(args[1], "-h")) {
+            exit(EXIT_CODE_OK);
+        } else if (!strcmp(args[i], "--help") || !strcmp(args[i], "-h")) {
             show_help();
+            exit(EXIT_CODE_OK);
+        } else if (!strcmp(args[i], "--vsync")) {
+            options->displayFlags |= DISPLAY_FLAG_VSYNC;
+        } else if (!strcmp(args[i], "--stats")) {
+            options->displayFlags |= DISPLAY_FLAG_STATISTICS;
+        } else if (!strcmp(args[i], "--latency")) {
+            options->displayFlags |= DISPLAY_FLAG_LATENCY;
+        } else if (!strcmp(args[i], "--headless")) {
+            options->displayFlags |= DISPLAY_FLAG_OFFSCREEN;
+        } else if (!strcmp(args[i], "--xo-chip")) {
+            options->mode = VIRTUAL_MACHINE_MODE_XO_CHIP;
+        } else if (!strcmp(args[i], "--quirks") && i + 1 < argc && !strcmp(args[i + 1], "auto")) {
+            options->suggestQuirks = true;
+            i++;
+        } else if (!strcmp(args[i], "--quirks") && i + 1 < argc) {
+            options->quirks = parse_quirks(args[++i]);
+        } else if (!strcmp(args[i], "--analyze")) {
+            options->analyze = true;
+        } else if (!strcmp(args[i], "--cosmac-vip")) {
+            options->timing = VIRTUAL_MACHINE_TIMING_COSMAC_VIP;
+        } else if (!strcmp(args[i], "--cycles") && i + 1 < argc) {
+            options->executionOptions.maximumCycles = parse_cycle_count(args[++i]);
+        } else if (!strcmp(args[i], "--time-limit") && i + 1 < argc) {
+            options->executionOptions.timeLimit = parse_limit(args[++i]);
+        } else if (!strcmp(args[i], "--stop-when-idle") && i + 1 < argc) {
+            options->executionOptions.idleFrames = parse_limit(args[++i]);
+        } else if (!strcmp(args[i], "--screenshot-at") && i + 2 < argc) {
+            options->executionOptions.screenshotCycle = parse_cycle_count(args[++i]);
+            options->executionOptions.screenshotPath = args[++i];
+        } else if (!strcmp(args[i], "--run-ahead") && i + 1 < argc) {
+            options->executionOptions.runAheadFrames = parse_run_ahead_frames(args[++i]);
+        } else if (!strcmp(args[i], "--seed") && i + 1 < argc) {
+            options->seed = parse_seed(args[++i]);
+        } else if (!strcmp(args[i], "--record") && i + 1 < argc) {
+            options->recordPath = args[++i];
+        } else if (!strcmp(args[i], "--replay") && i + 1 < argc) {
+            options->replayPath = args[++i];
+        } else if (!strcmp(args[i], "--serve") && i + 1 < argc) {
+            options->servePath = args[++i];
+        } else if (!strcmp(args[i], "--export-frames") && i + 1 < argc) {
+            options->exportName = args[++i];
+        } else if (!strcmp(args[i], "--record-video") && i + 1 < argc) {
+            options->videoPath = args[++i];
+        } else if (!strcmp(args[i], "--aot")) {
+            translate = true;
+        } else if (!strcmp(args[i], "-o") && i + 1 < argc) {
+            options->translationPath = args[++i];
+        } else if (args[i][0] != '-' && !options->filePath) {
+            options->filePath = args[i];
         } else {
-            run_from_file(args[1]);
+            show_usage_error();
         }
-    } else {
-        fprintf(stderr, CHIP8_USAGE_MESSAGE);
-        exit(EXIT_CODE_COMMAND_LINE_USAGE_ERROR);
     }
-    return EXIT_CODE_OK;
+    // A translation needs the path of the translation unit, only programs without a window are stopped when they are
+    // idle
+    if (!options->filePath || (options->recordPath && options->replayPath) ||
+        translate != (options->translationPath != NULL) ||
+        (options->executionOptions.idleFrames && !(options->displayFlags & DISPLAY_FLAG_OFFSCREEN))) {
+        show_usage_error();
+    }
 }
 
 /// @brief Executes a chip8 program stored in a file
-/// @param filePath The path of the program
-static void run_from_file(char const * filePath) {
+/// @param options The options that were specified when the emulator was started
+static void run_from_file(command_line_options_t const * options) {
     printf("%s\t\t\t\t Version %i.%i.%i\n", PROJECT_INIT_LETTERING, PROJECT_VERSION_MAJOR, PROJECT_VERSION_MINOR,
            PROJECT_VERSION_PATCH);
+    char const * filePath = options->filePath;
     char * source;
     virtual_machine_t vm;
+    // The program is loaded into an image whose pages are mapped into the memory of the virtual machine
+    virtual_machine_image_t image;
     size_t pathLength = strlen(filePath);
-    virtual_machine_init(&vm);
+    virtual_machine_mode mode = options->mode;
+    if (pathLength > 4 && !strcmp(filePath + pathLength - 4, ".xo8")) {
+        // XO-CHIP programs are stored in binary as well, but need the larger memory
+        mode = VIRTUAL_MACHINE_MODE_XO_CHIP;
+    }
+    if (virtual_machine_init(&vm, mode)) {
+        exit(EXIT_CODE_SYSTEM_ERROR);
+    }
+    if (virtual_machine_image_init(&image, mode)) {
+        printf("Could not allocate memory for the image\n");
+        exit(EXIT_CODE_SYSTEM_ERROR);
+    }
     if (pathLength > 4 && !strcmp(filePath + pathLength - 4, ".cp8")) {
         // The source is provided in assembly language
         assembler_t assembler;
         source = file_utils_read_file(filePath);
-        if (assembler_initialize(&assembler, source) || assembler_process_file(&assembler, vm.memory)) {
+        if (assembler_initialize(&assembler, source) || assembler_process_file(&assembler, image.memory)) {
             exit(EXIT_CODE_ASSEMBLER_ERROR);
         }
-    } else if (pathLength > 4 && !strcmp(filePath + pathLength - 4, ".ch8")) {
+    } else if (pathLength > 4 &&
+               (!strcmp(filePath + pathLength - 4, ".ch8") || !strcmp(filePath + pathLength - 4, ".xo8"))) {
         // The source is provided in binary -> just store it in memory
-        file_utils_read_file_to_memory(filePath, vm.memory);
+        file_utils_read_file_to_memory(filePath, image.memory, image.memoryMask + 1u);
     } else {
         fprintf(stderr, "File type not supported");
         exit(EXIT_CODE_COMMAND_LINE_USAGE_ERROR);
     }
+    virtual_machine_core_map_image(&vm.core, &image);
+    // A replay uses the seed of the recorded session
+    virtual_machine_execution_options_t executionOptions = options->executionOptions;
+    input_log_t inputLog;
+    uint32_t seed = options->seed;
+    if (options->recordPath) {
+        if (input_log_open_recording(&inputLog, options->recordPath, seed)) {
+            exit(EXIT_CODE_INPUT_OUTPUT_ERROR);
+        }
+        executionOptions.inputLog = &inputLog;
+    } else if (options->replayPath) {
+        if (input_log_open_replay(&inputLog, options->replayPath, &seed)) {
+            exit(EXIT_CODE_INPUT_OUTPUT_ERROR);
+        }
+        executionOptions.inputLog = &inputLog;
+    }
+    virtual_machine_core_seed(&vm.core, seed);
+    vm.core.timing = options->timing;
+    if (options->quirks != VIRTUAL_MACHINE_QUIRKS_COUNT) {
+        vm.core.quirks = options->quirks;
+    }
+    if (options->suggestQuirks || options->analyze || options->translationPath) {
+        // The memory behind the program is zero, so trailing zeros are left out
+        uint16_t programSize = image.memoryMask + 1u - PROGRAM_START_LOCATION;
+        while (programSize && !image.memory[PROGRAM_START_LOCATION + programSize - 1u]) {
+            programSize--;
+        }
+        program_analysis_t analysis;
+        program_analysis_analyze(&analysis, image.memory + PROGRAM_START_LOCATION, programSize);
+        if (options->suggestQuirks) {
+            vm.core.quirks = program_analysis_suggest_quirks(&analysis);
+        }
+        if (options->analyze || options->translationPath) {
+            if (options->analyze) {
+                program_analysis_report(&analysis, stdout);
+            }
+            if (options->translationPath) {
+                translate_program(&vm, &analysis, options->translationPath);
+            }
+            virtual_machine_free(&vm);
+            virtual_machine_image_free(&image);
+            return;
+        }
+    }
+    if (options->servePath) {
+        executionOptions.frameServer = new (frame_server_t);
+        if (!executionOptions.frameServer || frame_server_init(executionOptions.frameServer, options->servePath)) {
+            exit(EXIT_CODE_SYSTEM_ERROR);
+        }
+    }
+    if (options->exportName) {
+        executionOptions.frameExport = new (frame_export_t);
+        if (!executionOptions.frameExport || frame_export_init(executionOptions.frameExport, options->exportName)) {
+            exit(EXIT_CODE_SYSTEM_ERROR);
+        }
+    }
+    if (options->videoPath) {
+        executionOptions.videoRecorder = new (video_recorder_t);
+        if (!executionOptions.videoRecorder || video_recorder_init(executionOptions.videoRecorder, options->videoPath)) {
+            exit(EXIT_CODE_SYSTEM_ERROR);
+        }
+    }
     // Initialzes the SDL subsystem
-    if (display_init(&vm.display)) {
+    if (display_init(&vm.display, options->displayFlags)) {
         exit(EXIT_CODE_SYSTEM_ERROR);
     }
-    virtual_machine_execute(&vm);
+    virtual_machine_execute(&vm, &executionOptions);
+    if (executionOptions.inputLog) {
+        input_log_close(executionOptions.inputLog, vm.core.cycles);
+    }
+    if (executionOptions.frameServer) {
+        frame_server_free(executionOptions.frameServer);
+        free(executionOptions.frameServer);
+    }
+    if (executionOptions.frameExport) {
+        frame_export_free(executionOptions.frameExport);
+        free(executionOptions.frameExport);
+    }
+    int videoResult = 0;
+    if (executionOptions.videoRecorder) {
+        videoResult = video_recorder_free(executionOptions.videoRecorder);
+        free(executionOptions.videoRecorder);
+    }
+    if (options->displayFlags & DISPLAY_FLAG_OFFSCREEN) {
+        printf("Executed %llu instructions, framebuffer hash 0x%016llX\n", (unsigned long long)vm.core.cycles,
+               (unsigned long long)display_hash(&vm.display));
+        printf("Execution ended: %s\n", virtual_machine_stop_reason_name(vm.stopReason));
+    }
     display_quit(&vm.display);
+    virtual_machine_free(&vm);
+    virtual_machine_image_free(&image);
+    if (videoResult) {
+        exit(EXIT_CODE_INPUT_OUTPUT_ERROR);
+    }
+}
+
+/// @brief Parses a positive amount of instructions
+/// @details Exits the emulator if the amount is invalid
+/// @param argument The argument that is parsed
+/// @return The amount of instructions
+static uint64_t parse_cycle_count(char const * argument) {
+    char * end;
+    unsigned long long cycles = strtoull(argument, &end, 10);
+    if (*end || !cycles || argument[0] == '-') {
+        show_usage_error();
+    }
+    return (uint64_t)cycles;
+}
+
+/// @brief Parses a positive limit of the execution (an amount of frames or milliseconds)
+/// @details Exits the emulator if the limit is invalid
+/// @param argument The argument that is parsed
+/// @return The limit
+static uint32_t parse_limit(char const * argument) {
+    char * end;
+    unsigned long long limit = strtoull(argument, &end, 10);
+    if (*end || !limit || limit > UINT32_MAX || argument[0] == '-') {
+        show_usage_error();
+    }
+    return (uint32_t)limit;
+}
+
+/// @brief Parses the name of a quirk profile (vip, schip or xochip)
+/// @details Exits the emulator if the name is unknown
+/// @param argument The argument that is parsed
+/// @return The quirk profile
+static virtual_machine_quirks parse_quirks(char const * argument) {
+    if (!strcmp(argument, "vip")) {
+        return VIRTUAL_MACHINE_QUIRKS_VIP;
+    } else if (!strcmp(argument, "schip")) {
+        return VIRTUAL_MACHINE_QUIRKS_SCHIP;
+    } else if (!strcmp(argument, "xochip")) {
+        return VIRTUAL_MACHINE_QUIRKS_XO_CHIP;
+    }
+    show_usage_error();
+    return VIRTUAL_MACHINE_QUIRKS_COUNT;
+}
+
+/// @brief Parses the amount of frames that are run ahead of every presented frame
+/// @details Exits the emulator if the amount is invalid
+/// @param argument The argument that is parsed
+/// @return The amount of frames (1 up to VIRTUAL_MACHINE_MAX_RUN_AHEAD_FRAMES)
+static uint8_t parse_run_ahead_frames(char const * argument) {
+    char * end;
+    unsigned long frames = strtoul(argument, &end, 10);
+    if (*end || !frames || frames > VIRTUAL_MACHINE_MAX_RUN_AHEAD_FRAMES || argument[0] == '-') {
+        show_usage_error();
+    }
+    return (uint8_t)frames;
+}
+
+/// @brief Parses the seed of the random number generator (decimal or hexadecimal with the prefix 0x)
+/// @details Exits the emulator if the seed is invalid
+/// @param argument The argument that is parsed
+/// @return The seed
+static uint32_t parse_seed(char const * argument) {
+    char * end;
+    unsigned long long seed = strtoull(argument, &end, 0);
+    if (*end || !*argument || seed > UINT32_MAX || argument[0] == '-') {
+        show_usage_error();
+    }
+    return (uint32_t)seed;
 }
 
 /// @brief Displays the help of the emulator
@@ -99,5 +404,61 @@ static void show_help() {
     printf("%s Help\n%s\n\n", PROJECT_NAME, CHIP8_USAGE_MESSAGE);
     printf("Options\n");
     printf("  -h, --help\t\tDisplay this help and exit\n");
-    printf("  -v, --version\t\tShows the version of the installed emulator and exit\n\n");
+    printf("  -v, --version\t\tShows the version of the installed emulator and exit\n");
+    printf("  --vsync\t\tPresents the frames synchronized with the refresh rate of the display\n");
+    printf("  --stats\t\tReports frame time percentiles and missed vsyncs when the emulator is closed\n");
+    printf("  --latency\t\tReports a histogram of the latency from key events to key reads, changed frames and\n"
+           "\t\t\tpresented frames when the emulator is closed\n");
+    printf("  --xo-chip\t\tExecutes the program with the 64 KB memory of the XO-CHIP (implied by .xo8 files)\n");
+    printf("  --quirks <profile>\tExecutes the program with the quirks of vip, schip or xochip (default: schip, or\n"
+           "\t\t\txochip for XO-CHIP programs), or auto to use the profile the analysis of the program suggests\n");
+    printf("  --cosmac-vip\t\tExecutes the instructions at the speed of the COSMAC VIP instead of 600 per second\n");
+    printf("  --headless\t\tExecutes the program as fast as possible without opening a window\n");
+    printf("  --cycles <n>\t\tStops the execution after n instructions\n");
+    printf("  --time-limit <ms>\tStops the execution after ms milliseconds\n");
+    printf("  --stop-when-idle <n>\tStops a headless execution once the program jumps to itself, waits for a key that\n"
+           "\t\t\tis never pressed or shows the same frame for n frames\n");
+    printf("  --screenshot-at <n> <path>\n\t\t\tStores the frame after n instructions as a portable bitmap (.pbm)\n");
+    printf("  --run-ahead <n>\tPresents the frame n frames ahead of the emulation to hide the input lag of a program\n"
+           "\t\t\t(1 - %u)\n", VIRTUAL_MACHINE_MAX_RUN_AHEAD_FRAMES);
+    printf("  --seed <n>\t\tSeeds the random number generator with n\n");
+    printf("  --serve <path>\t\tStreams the frames to local viewers over a unix domain socket and applies their key\n"
+           "\t\t\tevents (Linux only, frames of a headless execution are streamed as fast as they are emulated)\n");
+    printf("  --export-frames <name>\n\t\t\tPublishes every frame into the POSIX shared memory segment name, which\n"
+           "\t\t\tstarts with a slash (unix-like systems only, see frame_export.h for the layout)\n");
+    printf("  --record-video <path>\tRecords the frames to a YUV4MPEG2 video (.y4m) or a sequence of portable bitmaps\n"
+           "\t\t\t(.pbm) that are named after the numbers of the frames\n");
+    printf("  --record <path>\tRecords the keyboard input and the seed to an input log (.c8i)\n");
+    printf("  --replay <path>\tReplays the keyboard input and the seed of an input log (.c8i)\n");
+    printf("  --analyze\t\tReports the control flow, the data regions, the writes into the code and the quirk\n"
+           "\t\t\tdependencies of the program instead of executing it\n");
+    printf("  --aot -o <path>\tTranslates the program ahead of time to a C translation unit instead of executing it\n"
+           "\t\t\t(CHIP-8 programs only)\n\n");
+}
+
+/// @brief Reports that the emulator was used in a wrong way and exits
+static void show_usage_error() {
+    fprintf(stderr, CHIP8_USAGE_MESSAGE);
+    exit(EXIT_CODE_COMMAND_LINE_USAGE_ERROR);
+}
+
+/// @brief Translates the program in memory ahead of time to a C translation unit
+/// @details Exits the emulator if the program can not be translated
+/// @param vm The chip8 virtual machine the program is loaded into
+/// @param analysis The analysis of the program
+/// @param path The path of the translation unit
+static void translate_program(virtual_machine_t const * vm, program_analysis_t const * analysis, char const * path) {
+    if (vm->core.mode != VIRTUAL_MACHINE_MODE_CHIP8) {
+        fprintf(stderr, "Only CHIP-8 programs can be translated ahead of time\n");
+        exit(EXIT_CODE_COMMAND_LINE_USAGE_ERROR);
+    }
+    FILE * output = fopen(path, "w");
+    if (!output) {
+        fprintf(stderr, "Could not open file \"%s\"\n", path);
+        exit(EXIT_CODE_INPUT_OUTPUT_ERROR);
+    }
+    int result = recompiler_translate(analysis, vm->core.quirks, output);
+    if (fclose(output) || result) {
+        exit(EXIT_CODE_INPUT_OUTPUT_ERROR);
+    }
 }